@@ -0,0 +1,158 @@
+#include "apic.h"
+#include "lapic.h"
+#include "ioapic.h"
+#include "config.h"
+#include "io/io.h"
+#include "smp/madt.h"
+#include "memory/paging/paging.h"
+#include "cpu/cpu.h"
+
+static bool apic_is_enabled = false;
+
+// Local APIC timer counts per millisecond, the same for every cpu since they share the bus clock
+static uint32_t apic_timer_ticks_per_ms = 0;
+
+// Time stamp counter cycles per local APIC timer count, 24.8 fixed point
+static uint32_t apic_timer_cycles_per_tick = 0;
+static uint32_t apic_tsc_cycles_per_ms = 0;
+
+// Interrupt routing of the machine, kept for IRQs drivers enable later
+static struct MadtInfo *apic_madt = 0;
+
+/**
+ * @brief Remap both 8259 PICs away from the exception vectors and mask every line. Once the
+ *        IO APIC takes over, the only thing they could still deliver are spurious IRQs.
+ * 
+ */
+static void apic_disable_pic()
+{
+    outb(PIC1_COMMAND_PORT, 0x11);                          // Initialization, ICW4 follows
+    outb(PIC2_COMMAND_PORT, 0x11);
+    outb(PIC1_DATA_PORT, BIMBLEOS_IRQ_BASE_INTERRUPT);      // Master vectors 0x20 - 0x27
+    outb(PIC2_DATA_PORT, BIMBLEOS_IRQ_BASE_INTERRUPT + 8);  // Slave vectors 0x28 - 0x2F
+    outb(PIC1_DATA_PORT, 0x04);                             // Slave on IRQ2
+    outb(PIC2_DATA_PORT, 0x02);
+    outb(PIC1_DATA_PORT, 0x01);                             // x86 mode
+    outb(PIC2_DATA_PORT, 0x01);
+
+    outb(PIC1_DATA_PORT, 0xFF);
+    outb(PIC2_DATA_PORT, 0xFF);
+}
+
+static void apic_route_isa_irq(struct MadtInfo *madt, int irq, uint8_t apic_id)
+{
+    ioapic_route(madt->isa_irq_gsi[irq], BIMBLEOS_IRQ_BASE_INTERRUPT + irq, apic_id);
+}
+
+/**
+ * @brief Switch interrupt delivery of the boot cpu from the 8259 PIC to the APICs: map the
+ *        registers uncached, route the keyboard and ATA IRQs through the IO APIC to the
+ *        boot cpu, calibrate the local APIC timer and the time stamp counter against the PIT
+ *        and start the timer.
+ *        The MADT must describe an IO APIC.
+ * 
+ * @param kernel_directory 
+ * @param madt 
+ */
+void apic_init(struct PageDirectory_4GB *kernel_directory, struct MadtInfo *madt)
+{
+    // APIC registers must not be cached
+    lapic_set_base(madt->lapic_address);
+    paging_map(kernel_directory, (void *)madt->lapic_address, (void *)madt->lapic_address, PAGING_IS_PRESENT | PAGING_IS_WRITEABLE | PAGING_CACHE_DISABLED);
+    paging_map(kernel_directory, (void *)madt->ioapic_address, (void *)madt->ioapic_address, PAGING_IS_PRESENT | PAGING_IS_WRITEABLE | PAGING_CACHE_DISABLED);
+    paging_switch(kernel_directory);
+
+    lapic_init();
+    apic_disable_pic();
+
+    uint8_t bsp_apic_id = lapic_id();
+    apic_madt = madt;
+    ioapic_init(madt->ioapic_address, madt->ioapic_gsi_base);
+    apic_route_isa_irq(madt, APIC_IRQ_KEYBOARD, bsp_apic_id);
+    apic_route_isa_irq(madt, APIC_IRQ_PRIMARY_ATA, bsp_apic_id);
+    apic_route_isa_irq(madt, APIC_IRQ_SECONDARY_ATA, bsp_apic_id);
+
+    uint64_t tsc_start = cpu_rdtsc();
+    apic_timer_ticks_per_ms = lapic_timer_calibrate(10);
+    apic_tsc_cycles_per_ms = (uint32_t)(cpu_rdtsc() - tsc_start) / 10;
+    apic_timer_cycles_per_tick = (apic_tsc_cycles_per_ms << 8) / apic_timer_ticks_per_ms;
+    apic_is_enabled = true;
+
+    apic_timer_start();
+}
+
+/**
+ * @brief Start the scheduling tick of the calling cpu
+ * 
+ */
+void apic_timer_start()
+{
+    lapic_timer_start(BIMBLEOS_TIMER_INTERRUPT, (apic_timer_ticks_per_ms * 1000) / BIMBLEOS_TIMER_HZ);
+}
+
+/**
+ * @brief Acknowledge the interrupt being serviced on the calling cpu
+ * 
+ */
+void apic_eoi()
+{
+    if (!apic_is_enabled)
+    {
+        // No APIC on this machine, the legacy PIC still delivers everything
+        outb(PIC1_COMMAND_PORT, PIC_EOI);
+        return;
+    }
+
+    lapic_eoi();
+}
+
+bool apic_enabled()
+{
+    return apic_is_enabled;
+}
+
+/**
+ * @brief Cycles between the expiry of the calling cpu's timer and now. Called on entry of the
+ *        timer interrupt this is how long the interrupt waited to be serviced.
+ * 
+ * @return uint32_t 0 without an APIC
+ */
+uint32_t apic_timer_latency()
+{
+    if (!apic_is_enabled)
+    {
+        return 0;
+    }
+
+    return (uint32_t)(((uint64_t)lapic_timer_elapsed() * apic_timer_cycles_per_tick) >> 8);
+}
+
+/**
+ * @brief Time stamp counter rate measured next to the timer
+ * 
+ * @return uint32_t Cycles per millisecond, 0 without an APIC
+ */
+uint32_t apic_tsc_per_ms()
+{
+    return apic_tsc_cycles_per_ms;
+}
+
+/**
+ * @brief Deliver ISA IRQ 'irq' to the boot cpu, through the IO APIC or else by unmasking it
+ *        in the legacy PIC
+ * 
+ * @param irq 
+ */
+void apic_enable_irq(int irq)
+{
+    if (apic_is_enabled)
+    {
+        apic_route_isa_irq(apic_madt, irq, lapic_id());
+        return;
+    }
+
+    if (irq < 8)
+    {
+        outb(PIC1_DATA_PORT, insb(PIC1_DATA_PORT) & ~(1 << irq));
+    }
+}
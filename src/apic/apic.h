@@ -0,0 +1,28 @@
+#ifndef APIC_H
+#define APIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PIC1_COMMAND_PORT 0x20
+#define PIC1_DATA_PORT 0x21
+#define PIC2_COMMAND_PORT 0xA0
+#define PIC2_DATA_PORT 0xA1
+#define PIC_EOI 0x20
+
+#define APIC_IRQ_KEYBOARD 1
+#define APIC_IRQ_PRIMARY_ATA 14
+#define APIC_IRQ_SECONDARY_ATA 15
+
+struct PageDirectory_4GB;
+struct MadtInfo;
+
+void apic_init(struct PageDirectory_4GB *kernel_directory, struct MadtInfo *madt);
+void apic_timer_start();
+void apic_eoi();
+bool apic_enabled();
+uint32_t apic_timer_latency();
+uint32_t apic_tsc_per_ms();
+void apic_enable_irq(int irq);
+
+#endif
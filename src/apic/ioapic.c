@@ -0,0 +1,71 @@
+#include "ioapic.h"
+
+static volatile uint32_t *ioapic_base = 0;
+static uint32_t ioapic_gsi_base = 0;
+static int ioapic_total_entries = 0;
+
+static uint32_t ioapic_read(uint8_t reg)
+{
+    ioapic_base[IOAPIC_REGISTER_SELECT / sizeof(uint32_t)] = reg;
+    return ioapic_base[IOAPIC_REGISTER_WINDOW / sizeof(uint32_t)];
+}
+
+static void ioapic_write(uint8_t reg, uint32_t value)
+{
+    ioapic_base[IOAPIC_REGISTER_SELECT / sizeof(uint32_t)] = reg;
+    ioapic_base[IOAPIC_REGISTER_WINDOW / sizeof(uint32_t)] = value;
+}
+
+/**
+ * @brief Remember where the IO APIC lives and mask all of its inputs
+ * 
+ * @param address Physical (identity mapped) base of the IO APIC registers
+ * @param gsi_base First global system interrupt handled by this IO APIC
+ */
+void ioapic_init(uint32_t address, uint32_t gsi_base)
+{
+    ioapic_base = (volatile uint32_t *)address;
+    ioapic_gsi_base = gsi_base;
+    ioapic_total_entries = ((ioapic_read(IOAPIC_VERSION) >> 16) & 0xFF) + 1;
+
+    for (int i = 0; i < ioapic_total_entries; i++)
+    {
+        ioapic_mask(gsi_base + i);
+    }
+}
+
+uint32_t ioapic_get_base()
+{
+    return (uint32_t)ioapic_base;
+}
+
+/**
+ * @brief Deliver a global system interrupt to one cpu. Fixed delivery, physical destination,
+ *        edge triggered, active high which is what ISA devices use.
+ * 
+ * @param gsi 
+ * @param interrupt Vector raised on the target cpu
+ * @param apic_id Local APIC id of the target cpu
+ */
+void ioapic_route(uint32_t gsi, uint8_t interrupt, uint8_t apic_id)
+{
+    int entry = gsi - ioapic_gsi_base;
+    if (!ioapic_base || entry < 0 || entry >= ioapic_total_entries)
+    {
+        return;
+    }
+
+    ioapic_write(IOAPIC_REDIRECTION_TABLE + entry * 2 + 1, (uint32_t)apic_id << 24);
+    ioapic_write(IOAPIC_REDIRECTION_TABLE + entry * 2, interrupt);
+}
+
+void ioapic_mask(uint32_t gsi)
+{
+    int entry = gsi - ioapic_gsi_base;
+    if (!ioapic_base || entry < 0 || entry >= ioapic_total_entries)
+    {
+        return;
+    }
+
+    ioapic_write(IOAPIC_REDIRECTION_TABLE + entry * 2, IOAPIC_REDIRECTION_MASKED);
+}
@@ -0,0 +1,19 @@
+#ifndef IOAPIC_H
+#define IOAPIC_H
+
+#include <stdint.h>
+
+#define IOAPIC_REGISTER_SELECT 0x00
+#define IOAPIC_REGISTER_WINDOW 0x10
+
+#define IOAPIC_VERSION 0x01
+#define IOAPIC_REDIRECTION_TABLE 0x10      // Two 32 bit registers per entry
+
+#define IOAPIC_REDIRECTION_MASKED 0x10000
+
+void ioapic_init(uint32_t address, uint32_t gsi_base);
+uint32_t ioapic_get_base();
+void ioapic_route(uint32_t gsi, uint8_t interrupt, uint8_t apic_id);
+void ioapic_mask(uint32_t gsi);
+
+#endif
@@ -0,0 +1,119 @@
+#include "lapic.h"
+#include "config.h"
+#include "timer/pit.h"
+
+static volatile uint32_t *lapic_base = (volatile uint32_t *)LAPIC_DEFAULT_ADDRESS;
+
+void lapic_set_base(uint32_t address)
+{
+    lapic_base = (volatile uint32_t *)address;
+}
+
+uint32_t lapic_get_base()
+{
+    return (uint32_t)lapic_base;
+}
+
+uint32_t lapic_read(uint32_t reg)
+{
+    return lapic_base[reg / sizeof(uint32_t)];
+}
+
+void lapic_write(uint32_t reg, uint32_t value)
+{
+    lapic_base[reg / sizeof(uint32_t)] = value;
+
+    // Read back the ID register so the write has been posted before we continue
+    (void)lapic_base[LAPIC_REGISTER_ID / sizeof(uint32_t)];
+}
+
+uint8_t lapic_id()
+{
+    return lapic_read(LAPIC_REGISTER_ID) >> 24;
+}
+
+/**
+ * @brief Software enable the local APIC of the calling cpu and accept all interrupt priorities
+ * 
+ */
+void lapic_init()
+{
+    lapic_write(LAPIC_REGISTER_SPURIOUS, LAPIC_SPURIOUS_ENABLE | BIMBLEOS_SPURIOUS_INTERRUPT);
+    lapic_write(LAPIC_REGISTER_TPR, 0x00);
+}
+
+void lapic_eoi()
+{
+    lapic_write(LAPIC_REGISTER_EOI, 0x00);
+}
+
+static void lapic_wait_for_delivery()
+{
+    while (lapic_read(LAPIC_REGISTER_ICR_LOW) & LAPIC_ICR_DELIVERY_PENDING)
+    {
+    }
+}
+
+void lapic_send_init(uint8_t apic_id)
+{
+    lapic_write(LAPIC_REGISTER_ESR, 0x00);
+    lapic_write(LAPIC_REGISTER_ICR_HIGH, (uint32_t)apic_id << 24);
+    lapic_write(LAPIC_REGISTER_ICR_LOW, LAPIC_ICR_INIT | LAPIC_ICR_LEVEL_ASSERT);
+    lapic_wait_for_delivery();
+}
+
+/**
+ * @brief Send a startup IPI, the target cpu starts executing in real mode at vector * 0x1000
+ * 
+ * @param apic_id 
+ * @param vector 
+ */
+void lapic_send_startup(uint8_t apic_id, uint8_t vector)
+{
+    lapic_write(LAPIC_REGISTER_ICR_HIGH, (uint32_t)apic_id << 24);
+    lapic_write(LAPIC_REGISTER_ICR_LOW, LAPIC_ICR_STARTUP | LAPIC_ICR_LEVEL_ASSERT | vector);
+    lapic_wait_for_delivery();
+}
+
+/**
+ * @brief Start the local APIC timer of the calling cpu in periodic mode
+ * 
+ * @param interrupt Vector raised on every expiry
+ * @param initial_count Bus clocks / 16 between two interrupts
+ */
+void lapic_timer_start(uint8_t interrupt, uint32_t initial_count)
+{
+    lapic_write(LAPIC_REGISTER_TIMER_DIVIDE, LAPIC_TIMER_DIVIDE_BY_16);
+    lapic_write(LAPIC_REGISTER_LVT_TIMER, LAPIC_TIMER_PERIODIC | interrupt);
+    lapic_write(LAPIC_REGISTER_TIMER_INITIAL, initial_count);
+}
+
+/**
+ * @brief Measure how many timer counts (bus clock / 16) elapse per millisecond, using the PIT
+ *        as reference. Must run with interrupts disabled.
+ * 
+ * @param milliseconds Length of the measurement window
+ * @return uint32_t Timer counts per millisecond
+ */
+uint32_t lapic_timer_calibrate(uint32_t milliseconds)
+{
+    lapic_write(LAPIC_REGISTER_TIMER_DIVIDE, LAPIC_TIMER_DIVIDE_BY_16);
+    lapic_write(LAPIC_REGISTER_LVT_TIMER, LAPIC_TIMER_MASKED);
+    lapic_write(LAPIC_REGISTER_TIMER_INITIAL, 0xFFFFFFFF);
+
+    pit_delay_ms(milliseconds);
+
+    uint32_t elapsed = 0xFFFFFFFF - lapic_read(LAPIC_REGISTER_TIMER_CURRENT);
+    lapic_write(LAPIC_REGISTER_TIMER_INITIAL, 0x00);
+    return elapsed / milliseconds;
+}
+
+/**
+ * @brief Timer counts since the periodic timer of the calling cpu last expired
+ * 
+ * @return uint32_t 
+ */
+uint32_t lapic_timer_elapsed()
+{
+    return lapic_read(LAPIC_REGISTER_TIMER_INITIAL) - lapic_read(LAPIC_REGISTER_TIMER_CURRENT);
+}
@@ -0,0 +1,44 @@
+#ifndef LAPIC_H
+#define LAPIC_H
+
+#include <stdint.h>
+
+#define LAPIC_DEFAULT_ADDRESS 0xFEE00000
+
+// Register offsets from the local APIC base
+#define LAPIC_REGISTER_ID 0x20
+#define LAPIC_REGISTER_TPR 0x80
+#define LAPIC_REGISTER_EOI 0xB0
+#define LAPIC_REGISTER_SPURIOUS 0xF0
+#define LAPIC_REGISTER_ESR 0x280
+#define LAPIC_REGISTER_ICR_LOW 0x300
+#define LAPIC_REGISTER_ICR_HIGH 0x310
+#define LAPIC_REGISTER_LVT_TIMER 0x320
+#define LAPIC_REGISTER_TIMER_INITIAL 0x380
+#define LAPIC_REGISTER_TIMER_CURRENT 0x390
+#define LAPIC_REGISTER_TIMER_DIVIDE 0x3E0
+
+#define LAPIC_SPURIOUS_ENABLE 0x100
+#define LAPIC_TIMER_PERIODIC 0x20000
+#define LAPIC_TIMER_MASKED 0x10000
+#define LAPIC_TIMER_DIVIDE_BY_16 0x03
+
+#define LAPIC_ICR_INIT 0x00000500
+#define LAPIC_ICR_STARTUP 0x00000600
+#define LAPIC_ICR_LEVEL_ASSERT 0x00004000
+#define LAPIC_ICR_DELIVERY_PENDING 0x00001000
+
+void lapic_set_base(uint32_t address);
+uint32_t lapic_get_base();
+uint32_t lapic_read(uint32_t reg);
+void lapic_write(uint32_t reg, uint32_t value);
+uint8_t lapic_id();
+void lapic_init();
+void lapic_eoi();
+void lapic_send_init(uint8_t apic_id);
+void lapic_send_startup(uint8_t apic_id, uint8_t vector);
+void lapic_timer_start(uint8_t interrupt, uint32_t initial_count);
+uint32_t lapic_timer_calibrate(uint32_t milliseconds);
+uint32_t lapic_timer_elapsed();
+
+#endif
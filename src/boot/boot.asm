@@ -1,6 +1,8 @@
 ORG 0x7c00                         
 BITS 16                             ; Assemble the instruction in 16 bit  
 
+KERNEL_SECTORS equ 512                  ; Sectors of kernel.bin loaded after the boot sector, the Makefile checks it fits
+KERNEL_CHUNK equ 128                    ; Sectors read per ATA command, the count register holds 8 bits
 CODE_SEG equ gdt_code - gdt_start       ; Offset for code segment
 DATA_SEG equ gdt_data - gdt_start       ; Offset for data segment
 
@@ -13,7 +15,7 @@ nop
 OEMIdentifier           db 'BIMBLEOS'
 BytesPerSector          dw 0x200        ; This field is genrally ignored by kernel. Changing this doesn't change the bytes per sector in disk. You cannot chnage the way disks work
 SectorsPerCluster       db 0x80                  
-ReservedSectors         dw 200          ; Our kernel lies within this reserved space
+ReservedSectors         dw 520          ; Our kernel lies within this reserved space, see KERNEL_SECTORS
 FATCopies               db 0x02
 RootDirEntries          dw 0x40
 NumSectors              dw 0x00
@@ -95,9 +97,15 @@ gdt_descriptor:
  [BITS 32]
  load32:
     mov eax, 1
-    mov ecx, 100
+    mov esi, KERNEL_SECTORS / KERNEL_CHUNK
     mov edi, 0x00100000
+.next_chunk:
+    mov ecx, KERNEL_CHUNK
     call ata_lba_read
+    mov eax, ebx            ; ata_lba_read left the LBA in ebx
+    add eax, KERNEL_CHUNK
+    dec esi
+    jnz .next_chunk
     jmp CODE_SEG:0x00100000
 
 ata_lba_read:
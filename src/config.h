@@ -5,6 +5,7 @@
 #define KERNAL_DATA_SELECTOR                                0x10
 
 #define BIMBLEOS_TOTAL_INTERRUPTS                           256
+#define BIMBLEOS_PAGE_FAULT_INTERRUPT                       0x0E
 
 
 #define BIMBLEOS_HEAP_SIZE_BYTES                            104857600   // 100 MB
@@ -16,20 +17,59 @@
 #define BIMBLEOS_MAX_PATH                                   108
 #define BIMBLEOS_MAX_FILESYSTEMS                            12
 #define BIMBLEOS_MAX_FILE_DESCRIPTORS                       512
+#define BIMBLEOS_MAX_DISKS                                  10          // Drive numbers are the single digit of "0:/"
+#define BIMBLEOS_PROC_DISK_ID                               9           // Drive number of the procfs virtual disk
+#define BIMBLEOS_RAM_DISK_ID                                2           // Drive number of the RAM disk loaded at boot
+#define BIMBLEOS_RAM_DISK_IMAGE                             "0:/ram.img"
+#define BIMBLEOS_RAM_DISK_LOAD_CHUNK                        65536       // Bytes read from the image at a time
+#define BIMBLEOS_DISK_BENCH_MAX_SECTORS                     16384       // Largest single read of the disk benchmark, 8 MiB
+#define BIMBLEOS_BCACHE_BUFFERS                             256         // Sectors the buffer cache holds
+#define BIMBLEOS_BCACHE_BUCKETS                             64
+#define BIMBLEOS_BCACHE_FLUSH_TICKS                         (5 * BIMBLEOS_TIMER_HZ)     // Dirty buffers are written back this often
+#define BIMBLEOS_BCACHE_FLUSH_RUN                           64          // Most adjacent sectors written back with one command
+#define BIMBLEOS_DCACHE_ENTRIES                             128         // Names the directory entry cache holds
+#define BIMBLEOS_DCACHE_BUCKETS                             32
+#define BIMBLEOS_DCACHE_NAME_LENGTH                         16          // Longer names are not cached, 8.3 names fit
+#define BIMBLEOS_DCACHE_DATA_SIZE                           32          // A FAT16 directory entry
+#define BIMBLEOS_PROCFS_MAX_FILE_SIZE                       16384
 
     
-#define BIMBLEOS_TOTAL_GDT_SEGMENT                          6
+#define BIMBLEOS_MAX_CPUS                                   8
+#define BIMBLEOS_GDT_TSS_INDEX                              5           // First Task State Segment in GDT, one per cpu follows
+#define BIMBLEOS_TOTAL_GDT_SEGMENT                          (BIMBLEOS_GDT_TSS_INDEX + BIMBLEOS_MAX_CPUS)
+#define BIMBLEOS_KERNEL_STACK_SIZE                          1024 * 16   // Kernel stack of every application processor
+#define BIMBLEOS_BSP_KERNEL_STACK_ADDRESS                   0x600000    // Kernel stack of the boot processor
+#define BIMBLEOS_SMP_TRAMPOLINE_ADDRESS                     0x1000      // Real mode entry of application processors, must be page aligned and below 1MB
+#define BIMBLEOS_IRQ_BASE_INTERRUPT                         0x20        // ISA IRQ n is delivered on this vector + n
+#define BIMBLEOS_TIMER_INTERRUPT                            0x20        // Local APIC timer of every cpu, PIT IRQ 0 without an IO APIC
+#define BIMBLEOS_TIMER_HZ                                   100
+#define BIMBLEOS_SPURIOUS_INTERRUPT                         0xFF
+
 #define BIMBLEOS_PROGRAM_VIRTUAL_ADDRESS                    0x400000
 #define BIMBLEOS_USER_PROGRAM_STACK_SIZE                    1024 * 16
 #define BIMBLEOS_PROGRAM_VIRTUAL_STACK_ADDRESS_START        0x3FF000
 #define BIMBLEOS_PROGRAM_VIRTUAL_STACK_ADDRESS_END          BIMBLEOS_PROGRAM_VIRTUAL_STACK_ADDRESS_START - BIMBLEOS_USER_PROGRAM_STACK_SIZE
+#define BIMBLEOS_VDSO_DATA_VIRTUAL_ADDRESS                  0x3F9000    // Read only kernel data page of every process
+#define BIMBLEOS_VDSO_PROCESS_VIRTUAL_ADDRESS               0x3FA000    // Read only per process data page
+#define BIMBLEOS_GLOBAL_PAGES_END                           BIMBLEOS_VDSO_DATA_VIRTUAL_ADDRESS   // Pages below are kernel only and identical in every address space
 
 #define USER_CODE_SEGMENT                                   0x1B        // Offset of code segment in GDT: Includes ring level (of userland) bits too         
 #define USER_DATA_SEGMENT                                   0x23        // Offset of data segment in GDT: Includes ring level (of userland) bits too         
 
 #define BIMBLEOS_MAX_PROGRAM_ALLOCATIONS                    1024
 #define BIMBLEOS_MAX_PROCESSES                              12
+#define BIMBLEOS_MAX_COMMAND_ARGUMENTS                      32
+#define BIMBLEOS_MAX_PROCESS_FILES                          16
+#define BIMBLEOS_MAX_USER_FILE_READ                         4096        // Largest read a process can make with one system call
+#define BIMBLEOS_MAX_USER_FILE_WRITE                        4096        // Largest write a process can make with one system call
 
 #define BIMBLEOS_MAX_ISR80H_COMMANDS                         1024
+#define BIMBLEOS_MAX_TRACKED_ISR80H_COMMANDS                 32          // Commands below this get latency statistics
+#define BIMBLEOS_PROFILER_SAMPLES                            4096        // Samples kept per cpu, one per timer tick
+#define BIMBLEOS_SERIAL_TX_BUFFER_SIZE                       4096
+#define BIMBLEOS_TRACE                                       1           // Compile tracepoints in, each costs a branch while tracing is off
+#define BIMBLEOS_TRACE_ENTRIES                               8192        // Trace entries kept per cpu
+#define BIMBLEOS_KHEAP_CALLER_STATS                          1           // Account kernel heap blocks to the code that allocated them
+#define BIMBLEOS_KHEAP_MAX_CALLERS                           64          // Call sites tracked, later ones are accounted together
 #define BIMBLEOS_KEYBOARD_BUFFER_SIZE                        1024
 #endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+[BITS 32]
+
+section .asm
+
+global cpu_cpuid
+global cpu_read_cr0
+global cpu_write_cr0
+global cpu_read_cr2
+global cpu_read_cr4
+global cpu_write_cr4
+global cpu_write_msr
+global cpu_rdtsc
+
+; void cpu_cpuid(uint32_t leaf, struct CpuidRegisters* out)
+cpu_cpuid:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push edi
+
+    mov eax, [ebp+8]
+    xor ecx, ecx
+    cpuid
+
+    mov edi, [ebp+12]
+    mov [edi], eax
+    mov [edi+4], ebx
+    mov [edi+8], ecx
+    mov [edi+12], edx
+
+    pop edi
+    pop ebx
+    pop ebp
+    ret
+
+; uint32_t cpu_read_cr0()
+cpu_read_cr0:
+    mov eax, cr0
+    ret
+
+; void cpu_write_cr0(uint32_t value)
+cpu_write_cr0:
+    mov eax, [esp+4]
+    mov cr0, eax
+    ret
+
+; uint32_t cpu_read_cr2()
+cpu_read_cr2:
+    mov eax, cr2        ; Address of the last page fault
+    ret
+
+; uint32_t cpu_read_cr4()
+cpu_read_cr4:
+    mov eax, cr4
+    ret
+
+; void cpu_write_cr4(uint32_t value)
+cpu_write_cr4:
+    mov eax, [esp+4]
+    mov cr4, eax
+    ret
+
+; void cpu_write_msr(uint32_t msr, uint32_t low, uint32_t high)
+cpu_write_msr:
+    mov ecx, [esp+4]
+    mov eax, [esp+8]
+    mov edx, [esp+12]
+    wrmsr
+    ret
+
+; uint64_t cpu_rdtsc()
+cpu_rdtsc:
+    rdtsc               ; Time stamp counter in edx:eax, the 64 bit return registers
+    ret
@@ -0,0 +1,35 @@
+#include "cpu.h"
+
+/**
+ * @brief Check the feature flags reported in edx of cpuid leaf 1
+ * 
+ * @param edx_features CPUID_FEATURE_EDX_* bits that must all be present
+ * @return true 
+ * @return false 
+ */
+bool cpu_supports_features(uint32_t edx_features)
+{
+    struct CpuidRegisters registers;
+    cpu_cpuid(CPUID_LEAF_FEATURES, &registers);
+    return (registers.edx & edx_features) == edx_features;
+}
+
+bool cpu_supports_global_pages()
+{
+    return cpu_supports_features(CPUID_FEATURE_EDX_PGE);
+}
+
+/**
+ * @brief Let page table entries with the global bit survive CR3 reloads on the calling cpu.
+ *        Must run on every cpu, without support the global bit is simply ignored.
+ * 
+ */
+void cpu_enable_global_pages()
+{
+    if (!cpu_supports_global_pages())
+    {
+        return;
+    }
+
+    cpu_write_cr4(cpu_read_cr4() | CPU_CR4_PGE);
+}
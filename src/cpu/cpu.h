@@ -0,0 +1,49 @@
+#ifndef CPU_H
+#define CPU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CPUID_LEAF_FEATURES 0x01
+#define CPUID_FEATURE_EDX_SEP 0x800         // SYSENTER and SYSEXIT
+#define CPUID_FEATURE_EDX_PGE 0x2000        // Global pages
+#define CPUID_FEATURE_EDX_FXSR 0x1000000    // FXSAVE and FXRSTOR
+#define CPUID_FEATURE_EDX_SSE 0x2000000
+#define CPUID_FEATURE_ECX_PCID 0x20000      // Process context identifiers, usable in long mode only
+
+#define CPU_MSR_SYSENTER_CS 0x174
+#define CPU_MSR_SYSENTER_ESP 0x175
+#define CPU_MSR_SYSENTER_EIP 0x176
+
+#define CPU_CR0_MP 0x02                     // WAIT honours the TS flag
+#define CPU_CR0_EM 0x04                     // No FPU, every FPU instruction raises #NM
+#define CPU_CR0_TS 0x08                     // Task switched, the next FPU instruction raises #NM
+#define CPU_CR0_NE 0x20                     // Native FPU error reporting
+
+#define CPU_CR4_PGE 0x80                    // Global page enable
+#define CPU_CR4_OSFXSR 0x200                // FXSAVE, FXRSTOR and SSE instructions enabled
+#define CPU_CR4_OSXMMEXCPT 0x400            // Unmasked SSE exceptions raise #XM
+
+// Registers returned by the cpuid instruction
+struct CpuidRegisters
+{
+    uint32_t eax;
+    uint32_t ebx;
+    uint32_t ecx;
+    uint32_t edx;
+};
+
+void cpu_cpuid(uint32_t leaf, struct CpuidRegisters *out);
+uint32_t cpu_read_cr0();
+void cpu_write_cr0(uint32_t value);
+uint32_t cpu_read_cr2();
+uint32_t cpu_read_cr4();
+void cpu_write_cr4(uint32_t value);
+void cpu_write_msr(uint32_t msr, uint32_t low, uint32_t high);
+uint64_t cpu_rdtsc();
+
+bool cpu_supports_features(uint32_t edx_features);
+bool cpu_supports_global_pages();
+void cpu_enable_global_pages();
+
+#endif
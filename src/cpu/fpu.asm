@@ -0,0 +1,31 @@
+[BITS 32]
+
+section .asm
+
+global fpu_save
+global fpu_restore
+global fpu_reset
+global fpu_clear_task_switched
+
+; void fpu_save(struct FpuState* state)
+fpu_save:
+    mov eax, [esp+4]
+    fxsave [eax]
+    ret
+
+; void fpu_restore(struct FpuState* state)
+fpu_restore:
+    mov eax, [esp+4]
+    fxrstor [eax]
+    ret
+
+; void fpu_reset(uint32_t mxcsr)
+fpu_reset:
+    fninit
+    ldmxcsr [esp+4]
+    ret
+
+; void fpu_clear_task_switched()
+fpu_clear_task_switched:
+    clts
+    ret
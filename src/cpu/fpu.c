@@ -0,0 +1,111 @@
+#include "fpu.h"
+#include "cpu.h"
+#include "kernel.h"
+#include "idt/idt.h"
+#include "task/task.h"
+#include "smp/smp.h"
+
+// Set once the boot cpu found FXSAVE and SSE, the application processors are assumed to match
+static bool fpu_supported = false;
+
+static void fpu_set_task_switched()
+{
+    cpu_write_cr0(cpu_read_cr0() | CPU_CR0_TS);
+}
+
+/**
+ * @brief #NM, the running task used the FPU for the first time since it was switched in. Give it
+ *        the registers: restore its saved state, or a clean one if it never used the FPU.
+ * 
+ */
+static void fpu_handle_not_available()
+{
+    struct Task *task = task_current();
+    if (!task)
+    {
+        panic("FPU used in kernel land\n");
+    }
+
+    fpu_clear_task_switched();
+    if (task->fpu_used)
+    {
+        fpu_restore(&task->fpu_state);
+    }
+    else
+    {
+        fpu_reset(FPU_DEFAULT_MXCSR);
+        task->fpu_used = true;
+    }
+
+    cpu_current()->fpu_owner = task;
+}
+
+/**
+ * @brief Enable the FPU and SSE on the calling cpu. TS starts set, the first task touching the
+ *        FPU traps into fpu_handle_not_available. Without FXSAVE, FPU instructions fault instead.
+ * 
+ */
+void fpu_enable()
+{
+    uint32_t cr0 = cpu_read_cr0();
+    if (!fpu_supported)
+    {
+        cpu_write_cr0(cr0 | CPU_CR0_EM);
+        return;
+    }
+
+    cpu_write_cr0((cr0 & ~CPU_CR0_EM) | CPU_CR0_MP | CPU_CR0_NE | CPU_CR0_TS);
+    cpu_write_cr4(cpu_read_cr4() | CPU_CR4_OSFXSR | CPU_CR4_OSXMMEXCPT);
+}
+
+/**
+ * @brief Detect FPU support and enable it on the boot cpu, must run after idt_init
+ * 
+ */
+void fpu_init()
+{
+    fpu_supported = cpu_supports_features(CPUID_FEATURE_EDX_FXSR | CPUID_FEATURE_EDX_SSE);
+    if (fpu_supported)
+    {
+        idt_register_interrupt_callback(FPU_DEVICE_NOT_AVAILABLE_INTERRUPT, fpu_handle_not_available);
+    }
+
+    fpu_enable();
+}
+
+/**
+ * @brief 'task' stops running on this cpu. If it owns the FPU its state is saved right away,
+ *        once it is back on a run queue another cpu may pick it up. Tasks that never touched
+ *        the FPU since they were switched in cost nothing.
+ * 
+ * @param task 
+ */
+void fpu_task_switch_out(struct Task *task)
+{
+    struct Cpu *cpu = cpu_current();
+    if (!task || cpu->fpu_owner != task)
+    {
+        return;
+    }
+
+    fpu_save(&task->fpu_state);
+    cpu->fpu_owner = 0;
+    fpu_set_task_switched();
+}
+
+/**
+ * @brief Forget the FPU state of a task that is being freed
+ * 
+ * @param task 
+ */
+void fpu_task_free(struct Task *task)
+{
+    struct Cpu *cpu = cpu_current();
+    if (cpu->fpu_owner != task)
+    {
+        return;
+    }
+
+    cpu->fpu_owner = 0;
+    fpu_set_task_switched();
+}
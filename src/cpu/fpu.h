@@ -0,0 +1,28 @@
+#ifndef FPU_H
+#define FPU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FPU_DEVICE_NOT_AVAILABLE_INTERRUPT 0x07
+#define FPU_DEFAULT_MXCSR 0x1F80            // All SSE exceptions masked, round to nearest
+
+// FXSAVE image of the x87, MMX and SSE registers
+struct FpuState
+{
+    uint8_t data[512];
+} __attribute__((aligned(16)));
+
+struct Task;
+
+void fpu_init();
+void fpu_enable();
+void fpu_task_switch_out(struct Task *task);
+void fpu_task_free(struct Task *task);
+
+void fpu_save(struct FpuState *state);
+void fpu_restore(struct FpuState *state);
+void fpu_reset(uint32_t mxcsr);
+void fpu_clear_task_switched();
+
+#endif
@@ -0,0 +1,365 @@
+#include "ata.h"
+#include "io/io.h"
+#include "idt/idt.h"
+#include "apic/apic.h"
+#include "config.h"
+#include "status.h"
+
+#define ATA_TIMEOUT 1000000         // Status polls before a drive is given up on
+
+static struct AtaChannel ata_channels[] =
+{
+    {.io_base = ATA_PRIMARY_IO, .control_base = ATA_PRIMARY_CONTROL, .selected = -1, .lock = SPINLOCK_INIT},
+    {.io_base = ATA_SECONDARY_IO, .control_base = ATA_SECONDARY_CONTROL, .selected = -1, .lock = SPINLOCK_INIT},
+};
+
+// Primary master, primary slave, secondary master, secondary slave
+static struct AtaDrive ata_drives[ATA_TOTAL_DRIVES] =
+{
+    {.channel = &ata_channels[0], .slave = 0},
+    {.channel = &ata_channels[0], .slave = 1},
+    {.channel = &ata_channels[1], .slave = 0},
+    {.channel = &ata_channels[1], .slave = 1},
+};
+
+/**
+ * @brief The drives raise their IRQ once per transferred sector. Reading the status register
+ *        acknowledges it, completion itself is polled.
+ *
+ */
+static void ata_primary_interrupt()
+{
+    insb(ATA_PRIMARY_IO + ATA_REG_STATUS);
+}
+
+static void ata_secondary_interrupt()
+{
+    insb(ATA_SECONDARY_IO + ATA_REG_STATUS);
+}
+
+/**
+ * @brief Point the channel registers at 'drive'. A drive needs 400ns to answer after being
+ *        selected, which the four status reads of the alternate status register give it
+ *
+ * @param drive
+ * @param head Top LBA bits for 28 bit commands
+ */
+static void ata_select(struct AtaDrive *drive, uint8_t head)
+{
+    struct AtaChannel *channel = drive->channel;
+    int value = 0xE0 | (drive->slave << 4) | (head & 0x0F);
+    outb(channel->io_base + ATA_REG_DRIVE, value);
+    if (channel->selected < 0 || (channel->selected & 0x10) != (value & 0x10))
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            insb(channel->control_base);
+        }
+    }
+    channel->selected = value;
+}
+
+/**
+ * @brief Wait until the drive is no longer busy and has data or an error
+ *
+ * @param channel
+ * @return int
+ */
+static int ata_wait_data(struct AtaChannel *channel)
+{
+    for (int i = 0; i < ATA_TIMEOUT; i++)
+    {
+        uint8_t status = insb(channel->io_base + ATA_REG_STATUS);
+        if (status & ATA_STATUS_BSY)
+        {
+            continue;
+        }
+
+        if (status & ATA_STATUS_ERR)
+        {
+            return -EIO;
+        }
+
+        if (status & ATA_STATUS_DRQ)
+        {
+            return 0;
+        }
+    }
+
+    return -EIO;
+}
+
+/**
+ * @brief Ask the drive who it is. Absent drives, ATAPI drives (CD-ROMs) and drives that fail
+ *        the command are left not present
+ *
+ * @param drive
+ * @return int
+ */
+static int ata_identify(struct AtaDrive *drive)
+{
+    struct AtaChannel *channel = drive->channel;
+    uint16_t identity[256];
+
+    // Nothing drives a floating bus
+    if (insb(channel->io_base + ATA_REG_STATUS) == 0xFF)
+    {
+        return -EIO;
+    }
+
+    ata_select(drive, 0);
+    outb(channel->io_base + ATA_REG_SECTOR_COUNT, 0);
+    outb(channel->io_base + ATA_REG_LBA_LOW, 0);
+    outb(channel->io_base + ATA_REG_LBA_MID, 0);
+    outb(channel->io_base + ATA_REG_LBA_HIGH, 0);
+    outb(channel->io_base + ATA_REG_COMMAND, ATA_COMMAND_IDENTIFY);
+    if (insb(channel->io_base + ATA_REG_STATUS) == 0)
+    {
+        return -EIO;
+    }
+
+    int res = ata_wait_data(channel);
+    // ATAPI and SATA drives abort the command and leave their signature in the LBA registers
+    if (insb(channel->io_base + ATA_REG_LBA_MID) || insb(channel->io_base + ATA_REG_LBA_HIGH))
+    {
+        return -EIO;
+    }
+
+    if (res < 0)
+    {
+        return res;
+    }
+
+    for (int i = 0; i < 256; i++)
+    {
+        identity[i] = insw(channel->io_base + ATA_REG_DATA);
+    }
+
+    drive->lba48 = identity[83] & (1 << 10);
+    drive->total_sectors = identity[60] | ((uint32_t)identity[61] << 16);
+    if (drive->lba48)
+    {
+        // Sectors beyond 32 bits are not addressable by the rest of the kernel
+        bool huge = identity[102] || identity[103];
+        drive->total_sectors = huge ? 0xFFFFFFFF : identity[100] | ((uint32_t)identity[101] << 16);
+    }
+
+    // Two characters per word, the first in the high byte
+    for (int i = 0; i < ATA_MODEL_LENGTH / 2; i++)
+    {
+        drive->model[i * 2] = identity[27 + i] >> 8;
+        drive->model[i * 2 + 1] = identity[27 + i] & 0xFF;
+    }
+    int length = ATA_MODEL_LENGTH;
+    while (length > 0 && drive->model[length - 1] == ' ')
+    {
+        length--;
+    }
+    drive->model[length] = 0;
+
+    drive->present = true;
+    return 0;
+}
+
+/**
+ * @brief Probe the master and slave of both channels
+ *
+ */
+void ata_init()
+{
+    idt_register_interrupt_callback(BIMBLEOS_IRQ_BASE_INTERRUPT + APIC_IRQ_PRIMARY_ATA, ata_primary_interrupt);
+    idt_register_interrupt_callback(BIMBLEOS_IRQ_BASE_INTERRUPT + APIC_IRQ_SECONDARY_ATA, ata_secondary_interrupt);
+
+    for (int i = 0; i < ATA_TOTAL_DRIVES; i++)
+    {
+        ata_identify(&ata_drives[i]);
+    }
+}
+
+struct AtaDrive *ata_get(int index)
+{
+    if (index < 0 || index >= ATA_TOTAL_DRIVES)
+    {
+        return 0;
+    }
+
+    return &ata_drives[index];
+}
+
+/**
+ * @brief Program the task file of the selected drive for a command on 'count' sectors.
+ *        48 bit commands take the high bytes first, through the same registers
+ *
+ * @param drive
+ * @param lba
+ * @param count ATA_LBA28_MAX_SECTORS or ATA_LBA48_MAX_SECTORS are written as 0
+ * @param lba48
+ */
+static void ata_set_address(struct AtaDrive *drive, uint32_t lba, uint32_t count, bool lba48)
+{
+    uint16_t io_base = drive->channel->io_base;
+    if (lba48)
+    {
+        ata_select(drive, 0);
+        outb(io_base + ATA_REG_SECTOR_COUNT, (unsigned char)(count >> 8));
+        outb(io_base + ATA_REG_LBA_LOW, (unsigned char)(lba >> 24));
+        outb(io_base + ATA_REG_LBA_MID, 0);
+        outb(io_base + ATA_REG_LBA_HIGH, 0);
+    }
+    else
+    {
+        ata_select(drive, lba >> 24);
+    }
+
+    outb(io_base + ATA_REG_SECTOR_COUNT, (unsigned char)count);
+    outb(io_base + ATA_REG_LBA_LOW, (unsigned char)(lba & 0xff));
+    outb(io_base + ATA_REG_LBA_MID, (unsigned char)(lba >> 8));
+    outb(io_base + ATA_REG_LBA_HIGH, (unsigned char)(lba >> 16));
+}
+
+/**
+ * @brief Whether a transfer needs the 48 bit command. The 28 bit one takes four port writes
+ *        less, so it is kept for whatever it can address in one command
+ *
+ * @param drive
+ * @param lba
+ * @param total
+ * @return true
+ */
+static bool ata_use_lba48(struct AtaDrive *drive, uint32_t lba, uint32_t total)
+{
+    return drive->lba48 && (lba + total > ATA_LBA28_LIMIT || total > ATA_LBA28_MAX_SECTORS);
+}
+
+/**
+ * @brief Wait until the drive has finished a command without a data phase or its last sector
+ *
+ * @param channel
+ * @return int
+ */
+static int ata_wait_ready(struct AtaChannel *channel)
+{
+    for (int i = 0; i < ATA_TIMEOUT; i++)
+    {
+        uint8_t status = insb(channel->io_base + ATA_REG_STATUS);
+        if (!(status & ATA_STATUS_BSY))
+        {
+            return status & ATA_STATUS_ERR ? -EIO : 0;
+        }
+    }
+
+    return -EIO;
+}
+
+/**
+ * @brief Move 'total' sectors starting at 'lba' with PIO, in as few commands as the drive
+ *        allows: 256 sectors each with 28 bit LBA, 65536 with 48 bit LBA
+ *
+ * @param drive
+ * @param lba
+ * @param total
+ * @param buf
+ * @param write
+ * @return int
+ */
+static int ata_transfer(struct AtaDrive *drive, uint32_t lba, int total, void *buf, bool write)
+{
+    int res = 0;
+    struct AtaChannel *channel = drive->channel;
+    bool lba48 = ata_use_lba48(drive, lba, total);
+    uint32_t max = lba48 ? ATA_LBA48_MAX_SECTORS : ATA_LBA28_MAX_SECTORS;
+    if (!lba48 && lba + total > ATA_LBA28_LIMIT)
+    {
+        return -EIO;
+    }
+
+    uint8_t command = lba48 ? ATA_COMMAND_READ_SECTORS_EXT : ATA_COMMAND_READ_SECTORS;
+    if (write)
+    {
+        command = lba48 ? ATA_COMMAND_WRITE_SECTORS_EXT : ATA_COMMAND_WRITE_SECTORS;
+    }
+
+    unsigned short* ptr = (unsigned short*) buf;
+    spinlock_acquire(&channel->lock);
+    while (total > 0)
+    {
+        uint32_t count = (uint32_t)total > max ? max : (uint32_t)total;
+        ata_set_address(drive, lba, count, lba48);
+        outb(channel->io_base + ATA_REG_COMMAND, command);
+
+        for (uint32_t b = 0; b < count; b++)
+        {
+            // Wait for the buffer to be ready
+            res = ata_wait_data(channel);
+            if (res < 0)
+            {
+                goto out;
+            }
+
+            for (int i = 0; i < 256; i++)
+            {
+                if (write)
+                {
+                    outw(channel->io_base + ATA_REG_DATA, *ptr);
+                }
+                else
+                {
+                    *ptr = insw(channel->io_base + ATA_REG_DATA);
+                }
+                ptr++;
+            }
+        }
+
+        if (write)
+        {
+            // The drive is done with the data once it is no longer busy
+            res = ata_wait_ready(channel);
+            if (res < 0)
+            {
+                goto out;
+            }
+            drive->write_commands++;
+            drive->write_sectors += count;
+        }
+        else
+        {
+            drive->read_commands++;
+            drive->read_sectors += count;
+        }
+
+        lba += count;
+        total -= count;
+    }
+
+out:
+    spinlock_release(&channel->lock);
+    return res;
+}
+
+int ata_read_sectors(struct AtaDrive *drive, uint32_t lba, int total, void *buf)
+{
+    return ata_transfer(drive, lba, total, buf, false);
+}
+
+int ata_write_sectors(struct AtaDrive *drive, uint32_t lba, int total, const void *buf)
+{
+    return ata_transfer(drive, lba, total, (void *)buf, true);
+}
+
+/**
+ * @brief Have the drive write its own cache to the medium, the end of a sync
+ *
+ * @param drive
+ * @return int
+ */
+int ata_flush(struct AtaDrive *drive)
+{
+    struct AtaChannel *channel = drive->channel;
+    spinlock_acquire(&channel->lock);
+    ata_select(drive, 0);
+    outb(channel->io_base + ATA_REG_COMMAND, drive->lba48 ? ATA_COMMAND_FLUSH_CACHE_EXT : ATA_COMMAND_FLUSH_CACHE);
+    int res = ata_wait_ready(channel);
+    drive->flushes++;
+    spinlock_release(&channel->lock);
+    return res;
+}
@@ -0,0 +1,73 @@
+#ifndef ATA_H
+#define ATA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "smp/spinlock.h"
+
+#define ATA_TOTAL_DRIVES 4          // Master and slave of the primary and secondary channel
+#define ATA_MODEL_LENGTH 40
+
+#define ATA_PRIMARY_IO 0x1F0
+#define ATA_PRIMARY_CONTROL 0x3F6
+#define ATA_SECONDARY_IO 0x170
+#define ATA_SECONDARY_CONTROL 0x376
+
+// Registers relative to the io base of a channel
+#define ATA_REG_DATA 0
+#define ATA_REG_SECTOR_COUNT 2
+#define ATA_REG_LBA_LOW 3
+#define ATA_REG_LBA_MID 4
+#define ATA_REG_LBA_HIGH 5
+#define ATA_REG_DRIVE 6
+#define ATA_REG_STATUS 7
+#define ATA_REG_COMMAND 7
+
+#define ATA_STATUS_ERR 0x01
+#define ATA_STATUS_DRQ 0x08
+#define ATA_STATUS_BSY 0x80
+
+#define ATA_COMMAND_READ_SECTORS 0x20
+#define ATA_COMMAND_READ_SECTORS_EXT 0x24
+#define ATA_COMMAND_WRITE_SECTORS 0x30
+#define ATA_COMMAND_WRITE_SECTORS_EXT 0x34
+#define ATA_COMMAND_FLUSH_CACHE 0xE7
+#define ATA_COMMAND_FLUSH_CACHE_EXT 0xEA
+#define ATA_COMMAND_IDENTIFY 0xEC
+
+#define ATA_LBA28_MAX_SECTORS 256       // Sector count 0 of a 28 bit command
+#define ATA_LBA48_MAX_SECTORS 65536     // Sector count 0 of a 48 bit command
+#define ATA_LBA28_LIMIT 0x10000000      // First sector a 28 bit command cannot address
+
+// The two drives of a channel share its registers
+struct AtaChannel
+{
+    uint16_t io_base;
+    uint16_t control_base;
+    int selected;               // Drive select value last written, -1 before the first command
+    struct Spinlock lock;
+};
+
+struct AtaDrive
+{
+    struct AtaChannel *channel;
+    uint8_t slave;
+    bool present;               // Answered IDENTIFY as an ATA disk
+    bool lba48;                 // Supports the 48 bit LBA commands
+    uint32_t total_sectors;     // Capped at 2^32 sectors
+    char model[ATA_MODEL_LENGTH + 1];
+
+    uint32_t read_commands;     // Read commands issued, large reads take fewer with LBA48
+    uint32_t read_sectors;
+    uint32_t write_commands;
+    uint32_t write_sectors;
+    uint32_t flushes;
+};
+
+void ata_init();
+struct AtaDrive *ata_get(int index);
+int ata_read_sectors(struct AtaDrive *drive, uint32_t lba, int total, void *buf);
+int ata_write_sectors(struct AtaDrive *drive, uint32_t lba, int total, const void *buf);
+int ata_flush(struct AtaDrive *drive);
+
+#endif
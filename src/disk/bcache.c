@@ -0,0 +1,498 @@
+#include "bcache.h"
+#include "disk.h"
+#include "memory/memory.h"
+#include "memory/heap/kheap.h"
+#include "smp/spinlock.h"
+#include "status.h"
+
+// Write-back cache of ATA sectors between the disk streamer and the drives. Writes only dirty
+// a buffer, they reach the disk when the buffer is evicted, every BIMBLEOS_BCACHE_FLUSH_TICKS
+// or on a sync, sorted so adjacent sectors go out in one command. RAM disks are not cached.
+// Lock order: fs_lock, then bcache_lock, then the ATA channel lock
+
+// Allocated by bcache_init
+static struct BufferCacheEntry* bcache_buffers = 0;
+static int bcache_buckets[BIMBLEOS_BCACHE_BUCKETS];
+static struct BufferCacheStats bcache_stats;
+static uint32_t bcache_clock;
+static uint32_t bcache_ticks;
+static bool bcache_tick_flushing;     // bcache_tick is writing dirty buffers back
+static struct Spinlock bcache_lock = SPINLOCK_INIT;
+
+// Dirty buffers sorted by disk and sector, and the sectors of one run, while writing back
+static int bcache_order[BIMBLEOS_BCACHE_BUFFERS];
+static char* bcache_run = 0;
+
+/**
+ * @brief Allocate the buffers from the kernel heap, kheap_init must have run
+ *
+ * @return int
+ */
+int bcache_init()
+{
+    int res = 0;
+    bcache_buffers = kzalloc(sizeof(struct BufferCacheEntry) * BIMBLEOS_BCACHE_BUFFERS);
+    bcache_run = kzalloc(BIMBLEOS_BCACHE_FLUSH_RUN * BIMBLEOS_SECTOR_SIZE);
+    if (!bcache_buffers || !bcache_run)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    memset(&bcache_stats, 0, sizeof(bcache_stats));
+    for (int i = 0; i < BIMBLEOS_BCACHE_BUCKETS; i++)
+    {
+        bcache_buckets[i] = -1;
+    }
+
+out:
+    if (res < 0)
+    {
+        if (bcache_buffers)
+        {
+            kfree(bcache_buffers);
+            bcache_buffers = 0;
+        }
+        if (bcache_run)
+        {
+            kfree(bcache_run);
+            bcache_run = 0;
+        }
+    }
+    return res;
+}
+
+static int bcache_bucket(struct Disk* disk, uint32_t lba)
+{
+    return (lba ^ (disk->id * 2654435761u)) % BIMBLEOS_BCACHE_BUCKETS;
+}
+
+static struct BufferCacheEntry* bcache_lookup(struct Disk* disk, uint32_t lba)
+{
+    for (int i = bcache_buckets[bcache_bucket(disk, lba)]; i >= 0; i = bcache_buffers[i].next)
+    {
+        if (bcache_buffers[i].disk == disk && bcache_buffers[i].lba == lba)
+        {
+            return &bcache_buffers[i];
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Whether buffer 'a' goes to the disk before buffer 'b'
+ *
+ */
+static bool bcache_before(struct BufferCacheEntry* a, struct BufferCacheEntry* b)
+{
+    if (a->disk != b->disk)
+    {
+        return a->disk->id < b->disk->id;
+    }
+
+    return a->lba < b->lba;
+}
+
+/**
+ * @brief Write the dirty buffers of 'disk', or of every disk for 0, back in runs of adjacent
+ *        sectors. Buffers that fail stay dirty. Takes bcache_lock held
+ *
+ * @param disk
+ * @return int
+ */
+static int bcache_write_back(struct Disk* disk)
+{
+    int res = 0;
+    int total = 0;
+    for (int i = 0; i < BIMBLEOS_BCACHE_BUFFERS; i++)
+    {
+        struct BufferCacheEntry* entry = &bcache_buffers[i];
+        if (!entry->dirty || (disk && entry->disk != disk))
+        {
+            continue;
+        }
+
+        // Insertion sort, the cache is small
+        int j = total++;
+        while (j > 0 && bcache_before(entry, &bcache_buffers[bcache_order[j - 1]]))
+        {
+            bcache_order[j] = bcache_order[j - 1];
+            j--;
+        }
+        bcache_order[j] = i;
+    }
+
+    int start = 0;
+    while (start < total)
+    {
+        struct BufferCacheEntry* first = &bcache_buffers[bcache_order[start]];
+        int length = 1;
+        while (start + length < total && length < BIMBLEOS_BCACHE_FLUSH_RUN)
+        {
+            struct BufferCacheEntry* next = &bcache_buffers[bcache_order[start + length]];
+            if (next->disk != first->disk || next->lba != first->lba + length)
+            {
+                break;
+            }
+            length++;
+        }
+
+        for (int i = 0; i < length; i++)
+        {
+            memcpy(&bcache_run[i * BIMBLEOS_SECTOR_SIZE], bcache_buffers[bcache_order[start + i]].data, BIMBLEOS_SECTOR_SIZE);
+        }
+
+        int written = disk_write_block(first->disk, first->lba, length, bcache_run);
+        if (written < 0)
+        {
+            res = written;
+        }
+        else
+        {
+            for (int i = 0; i < length; i++)
+            {
+                bcache_buffers[bcache_order[start + i]].dirty = false;
+            }
+            bcache_stats.dirty -= length;
+            bcache_stats.write_backs += length;
+            bcache_stats.write_commands++;
+        }
+
+        start += length;
+    }
+
+    return res;
+}
+
+/**
+ * @brief The buffer holding 'lba' of 'disk', taking over the least recently used one on a
+ *        miss. Its data is read from the disk unless 'overwrite' says all of it is replaced
+ *
+ * @param disk
+ * @param lba
+ * @param overwrite
+ * @param out_entry
+ * @return int
+ */
+static int bcache_get(struct Disk* disk, uint32_t lba, bool overwrite, struct BufferCacheEntry** out_entry)
+{
+    int res = 0;
+    struct BufferCacheEntry* entry = bcache_lookup(disk, lba);
+    if (entry)
+    {
+        bcache_stats.hits++;
+        goto out;
+    }
+
+    bcache_stats.misses++;
+    int victim = 0;
+    for (int i = 0; i < BIMBLEOS_BCACHE_BUFFERS; i++)
+    {
+        if (!bcache_buffers[i].disk)
+        {
+            victim = i;
+            break;
+        }
+
+        if (bcache_buffers[i].last_used < bcache_buffers[victim].last_used)
+        {
+            victim = i;
+        }
+    }
+
+    entry = &bcache_buffers[victim];
+    if (entry->disk)
+    {
+        // Write back everything while at it, evicting one dirty buffer at a time is the slow way
+        if (entry->dirty)
+        {
+            res = bcache_write_back(0);
+            if (res < 0 && entry->dirty)
+            {
+                entry = 0;
+                goto out;
+            }
+        }
+
+        int* link = &bcache_buckets[bcache_bucket(entry->disk, entry->lba)];
+        while (*link != victim)
+        {
+            link = &bcache_buffers[*link].next;
+        }
+        *link = entry->next;
+        bcache_stats.evictions++;
+    }
+
+    entry->disk = 0;
+    if (!overwrite)
+    {
+        res = disk_read_block(disk, lba, 1, entry->data);
+        if (res < 0)
+        {
+            entry = 0;
+            goto out;
+        }
+    }
+
+    int bucket = bcache_bucket(disk, lba);
+    entry->disk = disk;
+    entry->lba = lba;
+    entry->dirty = false;
+    entry->next = bcache_buckets[bucket];
+    bcache_buckets[bucket] = victim;
+
+out:
+    if (entry)
+    {
+        entry->last_used = ++bcache_clock;
+    }
+    *out_entry = entry;
+    return entry ? 0 : res;
+}
+
+/**
+ * @brief Copy 'size' bytes at 'offset' of sector 'lba' out of the cache
+ *
+ * @param disk
+ * @param lba
+ * @param offset
+ * @param out
+ * @param size
+ * @return int
+ */
+int bcache_read(struct Disk* disk, uint32_t lba, int offset, void* out, int size)
+{
+    if (offset < 0 || size < 0 || offset + size > BIMBLEOS_SECTOR_SIZE)
+    {
+        return -EINVARG;
+    }
+
+    // RAM disks are memory already
+    if (disk->type != BIMBLEOS_DISK_TYPE_REAL)
+    {
+        char buffer[BIMBLEOS_SECTOR_SIZE];
+        int res = disk_read_block(disk, lba, 1, buffer);
+        if (res == 0)
+        {
+            memcpy(out, &buffer[offset], size);
+        }
+        return res;
+    }
+
+    struct BufferCacheEntry* entry = 0;
+    spinlock_acquire(&bcache_lock);
+    int res = bcache_get(disk, lba, false, &entry);
+    if (res == 0)
+    {
+        memcpy(out, &entry->data[offset], size);
+    }
+    spinlock_release(&bcache_lock);
+    return res;
+}
+
+/**
+ * @brief Replace 'size' bytes at 'offset' of sector 'lba'. The sector reaches the disk later,
+ *        see bcache_flush
+ *
+ * @param disk
+ * @param lba
+ * @param offset
+ * @param in
+ * @param size
+ * @return int
+ */
+int bcache_write(struct Disk* disk, uint32_t lba, int offset, const void* in, int size)
+{
+    if (offset < 0 || size < 0 || offset + size > BIMBLEOS_SECTOR_SIZE)
+    {
+        return -EINVARG;
+    }
+
+    if (disk->type != BIMBLEOS_DISK_TYPE_REAL)
+    {
+        char buffer[BIMBLEOS_SECTOR_SIZE];
+        int res = size == BIMBLEOS_SECTOR_SIZE ? 0 : disk_read_block(disk, lba, 1, buffer);
+        if (res == 0)
+        {
+            memcpy(&buffer[offset], (void*)in, size);
+            res = disk_write_block(disk, lba, 1, buffer);
+        }
+        return res;
+    }
+
+    struct BufferCacheEntry* entry = 0;
+    spinlock_acquire(&bcache_lock);
+    int res = bcache_get(disk, lba, size == BIMBLEOS_SECTOR_SIZE, &entry);
+    if (res == 0)
+    {
+        memcpy(&entry->data[offset], (void*)in, size);
+        if (!entry->dirty)
+        {
+            entry->dirty = true;
+            bcache_stats.dirty++;
+        }
+    }
+    spinlock_release(&bcache_lock);
+    return res;
+}
+
+/**
+ * @brief Write the dirty buffers of 'disk' back, of every disk for 0
+ *
+ * @param disk
+ * @return int
+ */
+int bcache_flush(struct Disk* disk)
+{
+    spinlock_acquire(&bcache_lock);
+    int res = bcache_write_back(disk);
+    spinlock_release(&bcache_lock);
+    return res;
+}
+
+/**
+ * @brief Forget every buffer of 'disk', dirty ones included, e.g. once it is unregistered
+ *
+ * @param disk
+ */
+void bcache_invalidate(struct Disk* disk)
+{
+    spinlock_acquire(&bcache_lock);
+    for (int i = 0; i < BIMBLEOS_BCACHE_BUCKETS; i++)
+    {
+        int* link = &bcache_buckets[i];
+        while (*link >= 0)
+        {
+            struct BufferCacheEntry* entry = &bcache_buffers[*link];
+            if (entry->disk != disk)
+            {
+                link = &entry->next;
+                continue;
+            }
+
+            if (entry->dirty)
+            {
+                bcache_stats.dirty--;
+            }
+            *link = entry->next;
+            memset(entry, 0, sizeof(*entry));
+        }
+    }
+    spinlock_release(&bcache_lock);
+}
+
+/**
+ * @brief Write every dirty buffer back and have the drives flush their own caches, after this
+ *        everything written so far survives a power loss
+ *
+ * @return int
+ */
+int bcache_sync()
+{
+    spinlock_acquire(&bcache_lock);
+    int res = bcache_write_back(0);
+    for (int i = 0; i < BIMBLEOS_MAX_DISKS; i++)
+    {
+        struct Disk* disk = disk_get(i);
+        if (disk)
+        {
+            int flushed = disk_flush(disk);
+            res = res < 0 ? res : flushed;
+        }
+    }
+    bcache_stats.syncs++;
+    spinlock_release(&bcache_lock);
+    return res;
+}
+
+/**
+ * @brief Write back the run of adjacent dirty sectors that starts with the lowest dirty sector,
+ *        at most BIMBLEOS_BCACHE_FLUSH_RUN of them. Takes bcache_lock held
+ *
+ * @return int
+ */
+static int bcache_write_back_run()
+{
+    struct BufferCacheEntry* first = 0;
+    for (int i = 0; i < BIMBLEOS_BCACHE_BUFFERS; i++)
+    {
+        struct BufferCacheEntry* entry = &bcache_buffers[i];
+        if (entry->dirty && (!first || bcache_before(entry, first)))
+        {
+            first = entry;
+        }
+    }
+
+    if (!first)
+    {
+        return 0;
+    }
+
+    struct BufferCacheEntry* run[BIMBLEOS_BCACHE_FLUSH_RUN];
+    int length = 0;
+    for (struct BufferCacheEntry* entry = first; entry && entry->dirty && length < BIMBLEOS_BCACHE_FLUSH_RUN;
+         entry = bcache_lookup(first->disk, first->lba + length))
+    {
+        memcpy(&bcache_run[length * BIMBLEOS_SECTOR_SIZE], entry->data, BIMBLEOS_SECTOR_SIZE);
+        run[length++] = entry;
+    }
+
+    int res = disk_write_block(first->disk, first->lba, length, bcache_run);
+    if (res < 0)
+    {
+        return res;
+    }
+
+    for (int i = 0; i < length; i++)
+    {
+        run[i]->dirty = false;
+    }
+    bcache_stats.dirty -= length;
+    bcache_stats.write_backs += length;
+    bcache_stats.write_commands++;
+    return 0;
+}
+
+/**
+ * @brief Called on every timer tick of the boot cpu. Every BIMBLEOS_BCACHE_FLUSH_TICKS starts
+ *        writing dirty buffers back, one run per tick so the interrupt stays short, until
+ *        none is left or a write fails. Skipped when another cpu is using the cache
+ *
+ */
+void bcache_tick()
+{
+    if (++bcache_ticks % BIMBLEOS_BCACHE_FLUSH_TICKS == 0)
+    {
+        bcache_tick_flushing = true;
+    }
+
+    if (!bcache_tick_flushing)
+    {
+        return;
+    }
+
+    if (!bcache_stats.dirty)
+    {
+        bcache_tick_flushing = false;
+        return;
+    }
+
+    if (!spinlock_try_acquire(&bcache_lock))
+    {
+        return;
+    }
+
+    if (bcache_write_back_run() < 0)
+    {
+        bcache_tick_flushing = false;
+    }
+    spinlock_release(&bcache_lock);
+}
+
+void bcache_get_stats(struct BufferCacheStats* stats)
+{
+    spinlock_acquire(&bcache_lock);
+    memcpy(stats, &bcache_stats, sizeof(*stats));
+    spinlock_release(&bcache_lock);
+}
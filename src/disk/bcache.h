@@ -0,0 +1,41 @@
+#ifndef BCACHE_H
+#define BCACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+struct Disk;
+
+// One cached sector
+struct BufferCacheEntry
+{
+    struct Disk* disk;          // 0 while the buffer is unused
+    uint32_t lba;
+    bool dirty;                 // Written, not yet on the disk
+    uint32_t last_used;         // LRU clock of the last access
+    int next;                   // Next buffer in the same hash bucket, -1 ends the chain
+    char data[BIMBLEOS_SECTOR_SIZE];
+};
+
+struct BufferCacheStats
+{
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t dirty;             // Buffers waiting to be written back
+    uint32_t write_backs;       // Sectors written back
+    uint32_t write_commands;    // Disk writes they took, adjacent sectors go together
+    uint32_t syncs;
+};
+
+int bcache_init();
+int bcache_read(struct Disk* disk, uint32_t lba, int offset, void* out, int size);
+int bcache_write(struct Disk* disk, uint32_t lba, int offset, const void* in, int size);
+int bcache_flush(struct Disk* disk);
+void bcache_invalidate(struct Disk* disk);
+int bcache_sync();
+void bcache_tick();
+void bcache_get_stats(struct BufferCacheStats* stats);
+
+#endif
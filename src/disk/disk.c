@@ -1,74 +1,169 @@
 #include "disk.h"
-#include "io/io.h"
+#include "ramdisk.h"
+#include "ata.h"
+#include "bcache.h"
 #include "memory/memory.h"
 #include "config.h"
 #include "status.h"
 #include "fs/file.h"
+#include "trace/trace.h"
 
 
 
-struct Disk disk ;
+// Drive numbers of the primary master, primary slave, secondary master and secondary slave,
+// 2 is the RAM disk
+static const int ata_disk_ids[ATA_TOTAL_DRIVES] = {0, 1, 3, 4};
+static struct Disk ata_disks[ATA_TOTAL_DRIVES];
 
-int disk_read_sector(int lba, int total, void* buf)
+// Kernel statistics as text files, e.g. 9:/interrupts
+static struct Disk proc_disk;
+
+// Disks by drive number, the digit of "0:/"
+static struct Disk* disks[BIMBLEOS_MAX_DISKS];
+
+/**
+ * @brief Make 'disk' reachable as drive number disk->id
+ * 
+ * @param disk 
+ * @return int 
+ */
+int disk_register(struct Disk* disk)
 {
-    outb(0x1F6, (lba >> 24) | 0xE0);
-    outb(0x1F2, total);
-    outb(0x1F3, (unsigned char)(lba & 0xff));
-    outb(0x1F4, (unsigned char)(lba >> 8));
-    outb(0x1F5, (unsigned char)(lba >> 16));
-    outb(0x1F7, 0x20);
-
-    unsigned short* ptr = (unsigned short*) buf;
-    for (int b = 0; b < total; b++)
+    if (disk->id < 0 || disk->id >= BIMBLEOS_MAX_DISKS)
     {
-        // Wait for the buffer to be ready
-        char c = insb(0x1F7);
-        while(!(c & 0x08))
-        {
-            c = insb(0x1F7);
-        }
-
-        // Copy from hard disk to memory
-        for (int i = 0; i < 256; i++)
-        {
-            *ptr = insw(0x1F0);
-            ptr++;
-        }
+        return -EINVARG;
+    }
 
+    if (disks[disk->id])
+    {
+        return -EISTKN;
     }
+
+    disks[disk->id] = disk;
     return 0;
 }
 
+void disk_unregister(struct Disk* disk)
+{
+    if (disk->id >= 0 && disk->id < BIMBLEOS_MAX_DISKS && disks[disk->id] == disk)
+    {
+        disks[disk->id] = 0;
+    }
+    bcache_invalidate(disk);
+}
 
 /**
- * @brief Search for disks and initialize them. Currently only support real hard-drive. Will be expanded later
+ * @brief Search for disks and initialize them: every ATA disk answering IDENTIFY, procfs and a
+ *        RAM disk with the image BIMBLEOS_RAM_DISK_IMAGE if the boot disk has one.
+ *        Each disk gets the filesystem it is formatted with, if any
  * 
  */
 void disk_search_and_init(){
     
-    memset(&disk,0,sizeof(disk));
-    disk.type = BIMBLEOS_DISK_TYPE_REAL;
-    disk.id = 0;
-    disk.sector_size = BIMBLEOS_SECTOR_SIZE;
-    disk.filesystem = fs_resolve(&disk);
-    
+    ata_init();
+    for (int i = 0; i < ATA_TOTAL_DRIVES; i++)
+    {
+        struct AtaDrive* drive = ata_get(i);
+        // We were loaded from the primary master, keep it even if it did not answer
+        if (!drive->present && i != 0)
+        {
+            continue;
+        }
+
+        struct Disk* disk = &ata_disks[i];
+        memset(disk, 0, sizeof(struct Disk));
+        disk->type = BIMBLEOS_DISK_TYPE_REAL;
+        disk->id = ata_disk_ids[i];
+        disk->sector_size = BIMBLEOS_SECTOR_SIZE;
+        disk->total_sectors = drive->total_sectors;
+        disk->driver_private = drive;
+        disk_register(disk);
+        disk->filesystem = fs_resolve(disk);
+    }
+
+    memset(&proc_disk, 0, sizeof(proc_disk));
+    proc_disk.type = BIMBLEOS_DISK_TYPE_PROC;
+    proc_disk.id = BIMBLEOS_PROC_DISK_ID;
+    proc_disk.sector_size = BIMBLEOS_SECTOR_SIZE;
+    disk_register(&proc_disk);
+    proc_disk.filesystem = fs_resolve(&proc_disk);
+
+    // Optional, images without one simply have no 2:/
+    ramdisk_load(BIMBLEOS_RAM_DISK_ID, BIMBLEOS_RAM_DISK_IMAGE);
 }
 
 
 struct Disk* disk_get(int index){
 
-    switch(index){
-        case 0: return &disk;
-        default: return 0;
+    if (index < 0 || index >= BIMBLEOS_MAX_DISKS)
+    {
+        return 0;
     }
+
+    return disks[index];
 }
 
 int disk_read_block(struct Disk* idisk, int lba,int total,void * buff){
 
-    if(idisk != &disk){
+    int res = -EIO;
+    if (lba < 0 || total < 0 || (idisk->total_sectors && (uint32_t)lba + total > idisk->total_sectors))
+    {
+        return -EIO;
+    }
+
+    switch (idisk->type)
+    {
+        case BIMBLEOS_DISK_TYPE_REAL:
+            trace_disk_submit(lba, total);
+            res = ata_read_sectors(idisk->driver_private, lba, total, buff);
+            trace_disk_complete(lba, total, res);
+            break;
+
+        case BIMBLEOS_DISK_TYPE_RAM:
+            res = ramdisk_read(idisk, lba, total, buff);
+            break;
+    }
+
+    return res;
+
+}
+
+int disk_write_block(struct Disk* idisk, int lba, int total, const void* buff)
+{
+    int res = -EIO;
+    if (lba < 0 || total < 0 || (idisk->total_sectors && (uint32_t)lba + total > idisk->total_sectors))
+    {
         return -EIO;
     }
 
-    return disk_read_sector(lba,total,buff);
+    switch (idisk->type)
+    {
+        case BIMBLEOS_DISK_TYPE_REAL:
+            trace_disk_submit(lba, total);
+            res = ata_write_sectors(idisk->driver_private, lba, total, buff);
+            trace_disk_complete(lba, total, res);
+            break;
+
+        case BIMBLEOS_DISK_TYPE_RAM:
+            res = ramdisk_write(idisk, lba, total, buff);
+            break;
+    }
+
+    return res;
+}
 
-}
\ No newline at end of file
+/**
+ * @brief Make the writes the disk has taken durable, ATA drives keep them in their own cache
+ * 
+ * @param idisk 
+ * @return int 
+ */
+int disk_flush(struct Disk* idisk)
+{
+    if (idisk->type == BIMBLEOS_DISK_TYPE_REAL)
+    {
+        return ata_flush(idisk->driver_private);
+    }
+
+    return 0;
+}
@@ -1,23 +1,51 @@
 #ifndef DISK_H
 #define DISK_H
 
+#include <stdint.h>
+
 typedef unsigned int PEACHOS_DISK_TYPE;
 
 // Represent real physical hard disk
 #define BIMBLEOS_DISK_TYPE_REAL 0
 
+// Virtual disk without sectors, its files are generated by procfs
+#define BIMBLEOS_DISK_TYPE_PROC 1
+
+// Sectors kept in kernel memory, see ramdisk.c
+#define BIMBLEOS_DISK_TYPE_RAM 2
+
 struct Disk
 {
     PEACHOS_DISK_TYPE type;
     int id; 
     int sector_size;
+    uint32_t total_sectors;     // 0 when the size is unknown
     struct Filesystem* filesystem;
 
     void* fs_private;
+
+    // Data of the driver behind the disk, the sectors of a RAM disk
+    void* driver_private;
+};
+
+// Raw read benchmark of one disk, must match the stdlib definition
+struct DiskBench
+{
+    uint32_t lba;               // First sector read
+    uint32_t sectors;           // Sectors per read
+    uint32_t total_sectors;     // Sectors read in all, 0 only reports disk_sectors
+    uint32_t cycles_low;        // Time stamp counter cycles the reads took
+    uint32_t cycles_high;
+    uint32_t commands;          // ATA commands the reads took, 0 for other disks
+    uint32_t disk_sectors;      // Size of the disk, 0 when unknown
 };
 
 void disk_search_and_init();
+int disk_register(struct Disk *disk);
+void disk_unregister(struct Disk *disk);
 struct Disk * disk_get(int);
 int disk_read_block(struct Disk *, int, int, void *);
+int disk_write_block(struct Disk *, int, int, const void *);
+int disk_flush(struct Disk *);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,165 @@
+#include "ramdisk.h"
+#include "disk.h"
+#include "memory/memory.h"
+#include "memory/heap/kheap.h"
+#include "fs/file.h"
+#include "config.h"
+#include "status.h"
+#include "kernel.h"
+
+/**
+ * @brief Free a RAM disk that is not registered
+ *
+ * @param disk
+ */
+static void ramdisk_free(struct Disk *disk)
+{
+    if (disk->driver_private)
+    {
+        kfree(disk->driver_private);
+    }
+    kfree(disk);
+}
+
+/**
+ * @brief Create a zeroed RAM disk on drive number 'id'. The sectors come from the kernel heap,
+ *        reads are a memcpy so filesystems can be measured without the ATA controller
+ *
+ * @param id
+ * @param total_sectors
+ * @return struct Disk* The registered disk or an error
+ */
+struct Disk *ramdisk_create(int id, uint32_t total_sectors)
+{
+    int res = 0;
+    struct Disk *disk = 0;
+    if (total_sectors == 0)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    disk = kzalloc(sizeof(struct Disk));
+    if (!disk)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    disk->type = BIMBLEOS_DISK_TYPE_RAM;
+    disk->id = id;
+    disk->sector_size = BIMBLEOS_SECTOR_SIZE;
+    disk->total_sectors = total_sectors;
+    disk->driver_private = kzalloc(total_sectors * BIMBLEOS_SECTOR_SIZE);
+    if (!disk->driver_private)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    res = disk_register(disk);
+
+out:
+    if (res < 0)
+    {
+        if (disk)
+        {
+            ramdisk_free(disk);
+        }
+        return ERROR(res);
+    }
+    return disk;
+}
+
+/**
+ * @brief Create a RAM disk holding the disk image 'filename' and resolve its filesystem,
+ *        e.g. a FAT16 image loaded from 0:/ram.img becomes 2:/
+ *
+ * @param id
+ * @param filename
+ * @return int
+ */
+int ramdisk_load(int id, const char *filename)
+{
+    int res = 0;
+    struct Disk *disk = 0;
+    int fd = fopen(filename, "r");
+    if (fd <= 0)
+    {
+        res = -EIO;
+        goto out;
+    }
+
+    struct FileStat stat;
+    res = fstat(fd, &stat);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    disk = ramdisk_create(id, (stat.filesize + BIMBLEOS_SECTOR_SIZE - 1) / BIMBLEOS_SECTOR_SIZE);
+    if (ISERR(disk))
+    {
+        res = ERROR_I(disk);
+        disk = 0;
+        goto out;
+    }
+
+    char *data = disk->driver_private;
+    for (uint32_t offset = 0; offset < stat.filesize; offset += BIMBLEOS_RAM_DISK_LOAD_CHUNK)
+    {
+        uint32_t chunk = stat.filesize - offset < BIMBLEOS_RAM_DISK_LOAD_CHUNK ? stat.filesize - offset : BIMBLEOS_RAM_DISK_LOAD_CHUNK;
+        if (fread(data + offset, chunk, 1, fd) != 1)
+        {
+            res = -EIO;
+            goto out;
+        }
+    }
+
+    // Unknown images are kept as raw sectors without a filesystem
+    disk->filesystem = fs_resolve(disk);
+
+out:
+    if (fd)
+    {
+        fclose(fd);
+    }
+
+    if (res < 0 && disk)
+    {
+        disk_unregister(disk);
+        ramdisk_free(disk);
+    }
+    return res;
+}
+
+/**
+ * @brief Copy 'total' sectors starting at 'lba' out of the RAM disk
+ *
+ * @param disk
+ * @param lba
+ * @param total
+ * @param buf
+ * @return int
+ */
+int ramdisk_read(struct Disk *disk, int lba, int total, void *buf)
+{
+    if (lba < 0 || total < 0 || (uint32_t)lba + total > disk->total_sectors)
+    {
+        return -EIO;
+    }
+
+    memcpy(buf, (char *)disk->driver_private + lba * disk->sector_size, total * disk->sector_size);
+    return 0;
+}
+
+int ramdisk_write(struct Disk *disk, int lba, int total, const void *buf)
+{
+    if (lba < 0 || total < 0 || (uint32_t)lba + total > disk->total_sectors)
+    {
+        return -EIO;
+    }
+
+    memcpy((char *)disk->driver_private + lba * disk->sector_size, (void *)buf, total * disk->sector_size);
+    return 0;
+}
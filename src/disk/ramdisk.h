@@ -0,0 +1,13 @@
+#ifndef RAMDISK_H
+#define RAMDISK_H
+
+#include <stdint.h>
+
+struct Disk;
+
+struct Disk *ramdisk_create(int id, uint32_t total_sectors);
+int ramdisk_load(int id, const char *filename);
+int ramdisk_read(struct Disk *disk, int lba, int total, void *buf);
+int ramdisk_write(struct Disk *disk, int lba, int total, const void *buf);
+
+#endif
@@ -1,4 +1,5 @@
 #include "streamer.h"
+#include "bcache.h"
 #include "memory/heap/kheap.h"
 #include "config.h"
 #include <stdbool.h>
@@ -20,7 +21,7 @@ struct DiskStream * diskstreamer_new(int disk_id)
         return 0;
     }
 
-    struct DiskStream* diskStreamer = kzalloc(sizeof(diskStreamer));
+    struct DiskStream* diskStreamer = kzalloc(sizeof(struct DiskStream));
     diskStreamer->pos = 0;
     diskStreamer->disk = disk;
     return diskStreamer;
@@ -36,7 +37,7 @@ int diskstreamer_seek(struct DiskStream* stream, int pos)
 
 
 /**
- * @brief Read 'total' bytes into 'out'
+ * @brief Read 'total' bytes into 'out', through the buffer cache
  * 
  * @param stream 
  * @param out 
@@ -45,36 +46,55 @@ int diskstreamer_seek(struct DiskStream* stream, int pos)
  */
 int diskstreamer_read(struct DiskStream* stream, void* out, int total)
 {
-    int sector = stream->pos / BIMBLEOS_SECTOR_SIZE;
-    int offset = stream->pos % BIMBLEOS_SECTOR_SIZE;
-    int total_to_read = total;
-    bool overflow = (offset+total_to_read) >= BIMBLEOS_SECTOR_SIZE;
-    char buff[BIMBLEOS_SECTOR_SIZE];
-
-    if (overflow)
+    int res = 0;
+    while (total > 0)
     {
-        total_to_read -= (offset+total_to_read) - BIMBLEOS_SECTOR_SIZE;
+        int sector = stream->pos / BIMBLEOS_SECTOR_SIZE;
+        int offset = stream->pos % BIMBLEOS_SECTOR_SIZE;
+        int total_to_read = total > BIMBLEOS_SECTOR_SIZE - offset ? BIMBLEOS_SECTOR_SIZE - offset : total;
+        res = bcache_read(stream->disk, sector, offset, out, total_to_read);
+        if (res < 0)
+        {
+            break;
+        }
+
+        // Adjust the stream
+        out = (char*)out + total_to_read;
+        stream->pos += total_to_read;
+        total -= total_to_read;
     }
 
-    int res = disk_read_block(stream->disk, sector, 1, buff);
-    if (res < 0)
-    {
-        goto out;
-    }
+    return res;
+}
 
-   
-    for (int i = 0; i < total_to_read; i++)
+/**
+ * @brief Write 'total' bytes from 'in' at the current position. They reach the disk when the
+ *        buffer cache writes them back
+ * 
+ * @param stream 
+ * @param in 
+ * @param total 
+ * @return int 
+ */
+int diskstreamer_write(struct DiskStream* stream, const void* in, int total)
+{
+    int res = 0;
+    while (total > 0)
     {
-        *(char*)out++ = buff[offset+i];
+        int sector = stream->pos / BIMBLEOS_SECTOR_SIZE;
+        int offset = stream->pos % BIMBLEOS_SECTOR_SIZE;
+        int total_to_write = total > BIMBLEOS_SECTOR_SIZE - offset ? BIMBLEOS_SECTOR_SIZE - offset : total;
+        res = bcache_write(stream->disk, sector, offset, in, total_to_write);
+        if (res < 0)
+        {
+            break;
+        }
+
+        in = (const char*)in + total_to_write;
+        stream->pos += total_to_write;
+        total -= total_to_write;
     }
 
-    // Adjust the stream
-    stream->pos += total_to_read;
-    if (overflow)
-    {
-        res = diskstreamer_read(stream, out, total-total_to_read);
-    }
-out:
     return res;
 }
 
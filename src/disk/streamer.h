@@ -11,6 +11,7 @@ struct DiskStream
 struct DiskStream *diskstreamer_new(int);
 int diskstreamer_seek(struct DiskStream *, int);
 int diskstreamer_read(struct DiskStream *, void *, int);
+int diskstreamer_write(struct DiskStream *, const void *, int);
 void diskstreamer_close(struct DiskStream *);
 
 #endif
\ No newline at end of file
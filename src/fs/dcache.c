@@ -0,0 +1,233 @@
+#include "dcache.h"
+#include "disk/disk.h"
+#include "memory/memory.h"
+#include "string/string.h"
+#include "memory/heap/kheap.h"
+#include "status.h"
+
+// Names looked up in directories and what was found, so resolving a path again neither reads
+// nor parses the directories on the way. Names that were not found are kept as negative
+// entries. Keyed by disk, parent directory and name, compared without case as in FAT.
+// Filesystems tell the cache about every directory entry they change. Callers hold fs_lock
+
+static struct DentryCacheEntry* dcache_entries = 0;    // Allocated by dcache_init
+static int dcache_buckets[BIMBLEOS_DCACHE_BUCKETS];
+static struct DentryCacheStats dcache_stats;
+static uint32_t dcache_clock;
+
+/**
+ * @brief Allocate the entries from the kernel heap, kheap_init must have run
+ *
+ * @return int
+ */
+int dcache_init()
+{
+    dcache_entries = kzalloc(sizeof(struct DentryCacheEntry) * BIMBLEOS_DCACHE_ENTRIES);
+    if (!dcache_entries)
+    {
+        return -ENOMEM;
+    }
+
+    memset(&dcache_stats, 0, sizeof(dcache_stats));
+    for (int i = 0; i < BIMBLEOS_DCACHE_BUCKETS; i++)
+    {
+        dcache_buckets[i] = -1;
+    }
+    return 0;
+}
+
+static int dcache_bucket(struct Disk* disk, uint32_t parent, const char* name)
+{
+    // FNV-1a over the lower case name
+    uint32_t hash = 2166136261u ^ (disk->id * 2654435761u) ^ parent;
+    for (; *name; name++)
+    {
+        char c = (*name >= 'A' && *name <= 'Z') ? *name + 32 : *name;
+        hash = (hash ^ (uint8_t)c) * 16777619u;
+    }
+
+    return hash % BIMBLEOS_DCACHE_BUCKETS;
+}
+
+static bool dcache_cacheable(const char* name)
+{
+    return strnlen(name, BIMBLEOS_DCACHE_NAME_LENGTH) < BIMBLEOS_DCACHE_NAME_LENGTH;
+}
+
+static struct DentryCacheEntry* dcache_find(struct Disk* disk, uint32_t parent, const char* name)
+{
+    for (int i = dcache_buckets[dcache_bucket(disk, parent, name)]; i >= 0; i = dcache_entries[i].next)
+    {
+        struct DentryCacheEntry* entry = &dcache_entries[i];
+        if (entry->disk == disk && entry->parent == parent && istrncmp(entry->name, name, sizeof(entry->name)) == 0)
+        {
+            return entry;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Unlink 'entry' from its bucket and mark it unused
+ *
+ * @param entry
+ */
+static void dcache_remove(struct DentryCacheEntry* entry)
+{
+    int index = entry - dcache_entries;
+    int* link = &dcache_buckets[dcache_bucket(entry->disk, entry->parent, entry->name)];
+    while (*link != index)
+    {
+        link = &dcache_entries[*link].next;
+    }
+
+    *link = entry->next;
+    memset(entry, 0, sizeof(*entry));
+}
+
+/**
+ * @brief Look 'name' up in directory 'parent'. A hit copies the directory entry to 'data' and
+ *        its position to 'position'
+ *
+ * @param disk
+ * @param parent
+ * @param name
+ * @param data BIMBLEOS_DCACHE_DATA_SIZE bytes
+ * @param position
+ * @return int DCACHE_HIT, DCACHE_NEGATIVE or DCACHE_MISS
+ */
+int dcache_lookup(struct Disk* disk, uint32_t parent, const char* name, void* data, uint32_t* position)
+{
+    struct DentryCacheEntry* entry = dcache_cacheable(name) ? dcache_find(disk, parent, name) : 0;
+    if (!entry)
+    {
+        dcache_stats.misses++;
+        return DCACHE_MISS;
+    }
+
+    entry->last_used = ++dcache_clock;
+    if (entry->negative)
+    {
+        dcache_stats.negative_hits++;
+        return DCACHE_NEGATIVE;
+    }
+
+    dcache_stats.hits++;
+    memcpy(data, entry->data, sizeof(entry->data));
+    *position = entry->position;
+    return DCACHE_HIT;
+}
+
+/**
+ * @brief Remember what looking up 'name' in 'parent' found, 0 for 'data' when it was not
+ *        found. Replaces what was known about the name, the least recently used entry makes
+ *        room for it
+ *
+ * @param disk
+ * @param parent
+ * @param name
+ * @param data
+ * @param position
+ */
+void dcache_insert(struct Disk* disk, uint32_t parent, const char* name, const void* data, uint32_t position)
+{
+    if (!dcache_cacheable(name))
+    {
+        return;
+    }
+
+    struct DentryCacheEntry* entry = dcache_find(disk, parent, name);
+    if (entry)
+    {
+        dcache_remove(entry);
+    }
+    else
+    {
+        int victim = 0;
+        for (int i = 0; i < BIMBLEOS_DCACHE_ENTRIES; i++)
+        {
+            if (!dcache_entries[i].disk)
+            {
+                victim = i;
+                break;
+            }
+
+            if (dcache_entries[i].last_used < dcache_entries[victim].last_used)
+            {
+                victim = i;
+            }
+        }
+
+        entry = &dcache_entries[victim];
+        if (entry->disk)
+        {
+            dcache_remove(entry);
+            dcache_stats.evictions++;
+        }
+    }
+
+    int bucket = dcache_bucket(disk, parent, name);
+    entry->disk = disk;
+    entry->parent = parent;
+    strncpy(entry->name, name, sizeof(entry->name));
+    entry->negative = !data;
+    entry->position = position;
+    if (data)
+    {
+        memcpy(entry->data, (void*)data, sizeof(entry->data));
+    }
+    entry->last_used = ++dcache_clock;
+    entry->next = dcache_buckets[bucket];
+    dcache_buckets[bucket] = entry - dcache_entries;
+}
+
+/**
+ * @brief The directory entry at 'position' changed to 'data', or was deleted for 0
+ *
+ * @param disk
+ * @param position
+ * @param data
+ */
+void dcache_update(struct Disk* disk, uint32_t position, const void* data)
+{
+    for (int i = 0; i < BIMBLEOS_DCACHE_ENTRIES; i++)
+    {
+        struct DentryCacheEntry* entry = &dcache_entries[i];
+        if (entry->disk != disk || entry->negative || entry->position != position)
+        {
+            continue;
+        }
+
+        if (data)
+        {
+            memcpy(entry->data, (void*)data, sizeof(entry->data));
+            continue;
+        }
+
+        dcache_remove(entry);
+        dcache_stats.invalidations++;
+    }
+}
+
+/**
+ * @brief Forget every name on 'disk', e.g. when its filesystem is mounted again
+ *
+ * @param disk
+ */
+void dcache_invalidate(struct Disk* disk)
+{
+    for (int i = 0; i < BIMBLEOS_DCACHE_ENTRIES; i++)
+    {
+        if (dcache_entries[i].disk == disk)
+        {
+            dcache_remove(&dcache_entries[i]);
+            dcache_stats.invalidations++;
+        }
+    }
+}
+
+void dcache_get_stats(struct DentryCacheStats* stats)
+{
+    memcpy(stats, &dcache_stats, sizeof(*stats));
+}
@@ -0,0 +1,47 @@
+#ifndef DCACHE_H
+#define DCACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+struct Disk;
+
+// Results of dcache_lookup
+enum
+{
+    DCACHE_MISS,
+    DCACHE_HIT,
+    DCACHE_NEGATIVE             // The name is known not to be in the directory
+};
+
+// One name looked up in a directory
+struct DentryCacheEntry
+{
+    struct Disk* disk;          // 0 while the entry is unused
+    uint32_t parent;            // The filesystem's id of the directory, e.g. its first cluster
+    char name[BIMBLEOS_DCACHE_NAME_LENGTH];
+    bool negative;
+    uint32_t position;          // The filesystem's id of the entry, e.g. its place on the disk
+    char data[BIMBLEOS_DCACHE_DATA_SIZE];   // Copy of the directory entry
+    uint32_t last_used;         // LRU clock of the last lookup
+    int next;                   // Next entry in the same hash bucket, -1 ends the chain
+};
+
+struct DentryCacheStats
+{
+    uint32_t hits;
+    uint32_t negative_hits;     // Hits that found the name missing
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t invalidations;     // Entries dropped because the directory changed
+};
+
+int dcache_init();
+int dcache_lookup(struct Disk* disk, uint32_t parent, const char* name, void* data, uint32_t* position);
+void dcache_insert(struct Disk* disk, uint32_t parent, const char* name, const void* data, uint32_t position);
+void dcache_update(struct Disk* disk, uint32_t position, const void* data);
+void dcache_invalidate(struct Disk* disk);
+void dcache_get_stats(struct DentryCacheStats* stats);
+
+#endif
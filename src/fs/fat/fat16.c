@@ -5,6 +5,7 @@
 #include "status.h"
 #include "config.h"
 #include "fs/file.h"
+#include "fs/dcache.h"
 #include "memory/memory.h"
 #include "kernel.h"
 #include "memory/heap/kheap.h"
@@ -17,6 +18,9 @@ struct Filesystem fat16_fs = {
     .seek = fat16_seek,
     .stat = fat16_stat,
     .close = fat16_close,
+    .write = fat16_write,
+    .unlink = fat16_unlink,
+    .flush = fat16_flush,
 };
 
 struct Filesystem * fat16_init()
@@ -26,51 +30,23 @@ struct Filesystem * fat16_init()
 }
 
 
-int fat16_get_total_items_for_directory(struct Disk *disk, uint32_t directory_start_sector)
+/**
+ * @brief Entries before the end marker, an entry whose name starts with zero. Deleted entries
+ *        are counted so every entry keeps the index of its slot on the disk
+ * 
+ * @param items 
+ * @param capacity 
+ * @return int 
+ */
+static int fat16_count_directory_items(struct FAT_DirectoryItem *items, int capacity)
 {
-    struct FAT_DirectoryItem item;
-    struct FAT_DirectoryItem empty_item;
-    memset(&empty_item, 0, sizeof(empty_item));
-
-    struct FAT_Private *fat_private = disk->fs_private;
-
-    int res = 0;
     int i = 0;
-    int directory_start_pos = directory_start_sector * disk->sector_size;
-    struct DiskStream *stream = fat_private->directory_stream;
-    if (diskstreamer_seek(stream, directory_start_pos) != BIMBLEOS_ALL_OK)
-    {
-        res = -EIO;
-        goto out;
-    }
-
-    while (1)
+    while (i < capacity && items[i].filename[0] != 0x00)
     {
-        if (diskstreamer_read(stream, &item, sizeof(item)) != BIMBLEOS_ALL_OK)
-        {
-            res = -EIO;
-            goto out;
-        }
-
-        if (item.filename[0] == 0x00)
-        {
-            // We are done
-            break;
-        }
-
-        // Is the item unused
-        if (item.filename[0] == 0xE5)
-        {
-            continue;
-        }
-
         i++;
     }
 
-    res = i;
-
-out:
-    return res;
+    return i;
 }
 
 int fat16_sector_to_absolute(struct Disk *disk, int sector)
@@ -105,8 +81,6 @@ int fat16_get_root_directory(struct Disk *disk, struct FAT_Private *fat_private,
         total_sectors += 1;
     }
 
-    
-    int total_items = fat16_get_total_items_for_directory(disk, root_dir_sector_pos);
 
     dir = kzalloc(root_dir_size);
     if (!dir)
@@ -129,7 +103,9 @@ int fat16_get_root_directory(struct Disk *disk, struct FAT_Private *fat_private,
     }
 
     directory->item = dir;
-    directory->total = total_items;
+    directory->total = fat16_count_directory_items(dir, root_dir_entries);
+    directory->capacity = root_dir_entries;
+    directory->cluster = 0;
     directory->sector_pos = root_dir_sector_pos;
     directory->ending_sector_pos = root_dir_sector_pos + (root_dir_size / disk->sector_size);
     
@@ -153,6 +129,97 @@ static void fat16_init_private(struct Disk *disk, struct FAT_Private *private)
     private->directory_stream = diskstreamer_new(disk->id);
 }
 
+static void fat16_free_private(struct FAT_Private *private)
+{
+    struct DiskStream *streams[] = {private->cluster_read_stream, private->fat_read_stream, private->directory_stream};
+    for (int i = 0; i < sizeof(streams) / sizeof(streams[0]); i++)
+    {
+        if (streams[i])
+        {
+            diskstreamer_close(streams[i]);
+        }
+    }
+
+    void *buffers[] = {private->root_directory.item, private->fat, private->fat_dirty, private->cluster_map};
+    for (int i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++)
+    {
+        if (buffers[i])
+        {
+            kfree(buffers[i]);
+        }
+    }
+
+    kfree(private);
+}
+
+/**
+ * @brief Read the first FAT copy into memory and build the free cluster map from it. Clusters
+ *        past the end of the disk are never handed out, the boot sector of disk 0 claims more
+ *        sectors than the image has
+ * 
+ * @param disk 
+ * @param private 
+ * @return int 
+ */
+static int fat16_load_fat(struct Disk *disk, struct FAT_Private *private)
+{
+    int res = 0;
+    struct FAT_Header *header = &private->header.primary_header;
+    uint32_t fat_size = header->sectors_per_fat * disk->sector_size;
+    uint32_t total_sectors = header->number_of_sectors ? header->number_of_sectors : header->sectors_big;
+    if (disk->total_sectors && disk->total_sectors < total_sectors)
+    {
+        total_sectors = disk->total_sectors;
+    }
+
+    uint32_t data_sector = private->root_directory.ending_sector_pos;
+    if (fat_size == 0 || header->sectors_per_cluster == 0 || total_sectors <= data_sector)
+    {
+        res = -EFSNOTUS;
+        goto out;
+    }
+
+    private->fat_entries = (total_sectors - data_sector) / header->sectors_per_cluster + 2;
+    if (private->fat_entries > fat_size / BIMBLEOS_FAT16_FAT_ENTRY_SIZE)
+    {
+        private->fat_entries = fat_size / BIMBLEOS_FAT16_FAT_ENTRY_SIZE;
+    }
+
+    uint32_t map_words = (private->fat_entries + 31) / 32;
+    private->fat = kzalloc(fat_size);
+    private->fat_dirty = kzalloc(header->sectors_per_fat * sizeof(bool));
+    private->cluster_map = kzalloc(map_words * sizeof(uint32_t));
+    if (!private->fat || !private->fat_dirty || !private->cluster_map)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    struct DiskStream *stream = private->fat_read_stream;
+    if (diskstreamer_seek(stream, header->reserved_sectors * disk->sector_size) != BIMBLEOS_ALL_OK ||
+        diskstreamer_read(stream, private->fat, fat_size) != BIMBLEOS_ALL_OK)
+    {
+        res = -EIO;
+        goto out;
+    }
+
+    // Clusters 0 and 1 are reserved and the bits past the last cluster pad the map, both stay set
+    for (uint32_t cluster = 0; cluster < map_words * 32; cluster++)
+    {
+        if (cluster < 2 || cluster >= private->fat_entries || private->fat[cluster] != BIMBLEOS_FAT16_UNUSED)
+        {
+            private->cluster_map[cluster / 32] |= 1u << (cluster % 32);
+            continue;
+        }
+
+        private->free_clusters++;
+    }
+    private->next_free = 2;
+
+out:
+    return res;
+}
+
 /**
  * @brief Return zero if the disk has FAT16 filesystem
  * 
@@ -166,6 +233,9 @@ int fat16_resolve(struct Disk *disk)
     struct FAT_Private *fat_private = kzalloc(sizeof(struct FAT_Private));
     fat16_init_private(disk, fat_private);
 
+    // Names found on whatever was mounted before mean nothing now
+    dcache_invalidate(disk);
+
     disk->fs_private = fat_private;
     disk->filesystem = &fat16_fs;
 
@@ -198,6 +268,8 @@ int fat16_resolve(struct Disk *disk)
         goto out;
     }
 
+    res = fat16_load_fat(disk, fat_private);
+
 out:
     if (stream)
     {
@@ -206,7 +278,7 @@ out:
 
     if (res < 0)
     {
-        kfree(fat_private);
+        fat16_free_private(fat_private);
         disk->fs_private = 0;
     }
     return res;
@@ -276,33 +348,171 @@ static uint32_t fat16_get_first_fat_sector(struct FAT_Private *private)
     return private->header.primary_header.reserved_sectors;
 }
 
+static void fat16_set_first_cluster(struct FAT_DirectoryItem *item, uint32_t cluster)
+{
+    item->high_16_bits_first_cluster = 0;
+    item->low_16_bits_first_cluster = cluster;
+}
+
+static int fat16_get_cluster_size(struct Disk *disk)
+{
+    struct FAT_Private *private = disk->fs_private;
+    return private->header.primary_header.sectors_per_cluster * disk->sector_size;
+}
+
+/**
+ * @brief The FAT entry of 'cluster'. The FAT is held in memory, following a chain reads nothing
+ * 
+ * @param disk 
+ * @param cluster 
+ * @return int 
+ */
 static int fat16_get_fat_entry(struct Disk *disk, int cluster)
 {
-    int res = -1;
     struct FAT_Private *private = disk->fs_private;
-    struct DiskStream *stream = private->fat_read_stream;
-    if (!stream)
+    if (cluster < 0 || cluster >= private->fat_entries)
     {
-        goto out;
+        return -EIO;
     }
 
-    uint32_t fat_table_position = fat16_get_first_fat_sector(private) * disk->sector_size;
-    res = diskstreamer_seek(stream, fat_table_position * (cluster * BIMBLEOS_FAT16_FAT_ENTRY_SIZE));
-    if (res < 0)
+    return private->fat[cluster];
+}
+
+/**
+ * @brief Change the FAT entry of 'cluster' in memory and keep the free cluster map in step.
+ *        The disk sees it on the next fat16_flush
+ * 
+ * @param disk 
+ * @param cluster 
+ * @param value 
+ */
+static void fat16_set_fat_entry(struct Disk *disk, uint32_t cluster, uint16_t value)
+{
+    struct FAT_Private *private = disk->fs_private;
+    uint32_t *word = &private->cluster_map[cluster / 32];
+    uint32_t bit = 1u << (cluster % 32);
+    if (value == BIMBLEOS_FAT16_UNUSED && (*word & bit))
     {
-        goto out;
+        *word &= ~bit;
+        private->free_clusters++;
+        if (cluster < private->next_free)
+        {
+            private->next_free = cluster;
+        }
+    }
+    else if (value != BIMBLEOS_FAT16_UNUSED && !(*word & bit))
+    {
+        *word |= bit;
+        private->free_clusters--;
     }
 
-    uint16_t result = 0;
-    res = diskstreamer_read(stream, &result, sizeof(result));
-    if (res < 0)
+    private->fat[cluster] = value;
+    uint32_t sector = cluster * BIMBLEOS_FAT16_FAT_ENTRY_SIZE / disk->sector_size;
+    if (!private->fat_dirty[sector])
     {
-        goto out;
+        private->fat_dirty[sector] = true;
+        private->fat_dirty_sectors++;
     }
+}
 
-    res = result;
-out:
-    return res;
+/**
+ * @brief Take a free cluster and end a chain with it. The map is searched a word of 32
+ *        clusters at a time from where the last search stopped
+ * 
+ * @param disk 
+ * @return int The cluster, negative when the disk is full
+ */
+static int fat16_allocate_cluster(struct Disk *disk)
+{
+    struct FAT_Private *private = disk->fs_private;
+    if (!private->free_clusters)
+    {
+        return -ENOMEM;
+    }
+
+    uint32_t words = (private->fat_entries + 31) / 32;
+    uint32_t word = (private->next_free / 32) % words;
+    for (uint32_t i = 0; i <= words; i++, word = (word + 1) % words)
+    {
+        uint32_t used = private->cluster_map[word];
+        if (used == 0xFFFFFFFF)
+        {
+            continue;
+        }
+
+        for (int bit = 0; bit < 32; bit++)
+        {
+            if (!(used & (1u << bit)))
+            {
+                uint32_t cluster = word * 32 + bit;
+                fat16_set_fat_entry(disk, cluster, BIMBLEOS_FAT16_LAST_CLUSTER);
+                private->next_free = cluster + 1;
+                return cluster;
+            }
+        }
+    }
+
+    return -ENOMEM;
+}
+
+/**
+ * @brief Give every cluster of the chain starting at 'cluster' back to the free map
+ * 
+ * @param disk 
+ * @param cluster 
+ */
+static void fat16_free_chain(struct Disk *disk, int cluster)
+{
+    struct FAT_Private *private = disk->fs_private;
+
+    // A chain holds each cluster at most once, anything longer loops in a damaged FAT
+    for (uint32_t i = 0; i < private->fat_entries && cluster >= 2 && cluster < private->fat_entries; i++)
+    {
+        int next = private->fat[cluster];
+        fat16_set_fat_entry(disk, cluster, BIMBLEOS_FAT16_UNUSED);
+        if (next >= BIMBLEOS_FAT16_RESERVED_START)
+        {
+            break;
+        }
+        cluster = next;
+    }
+}
+
+/**
+ * @brief Clusters in the chain starting at 'cluster', 0 for none
+ * 
+ * @param disk 
+ * @param cluster 
+ * @param last_cluster Set to the last cluster of the chain
+ * @return int 
+ */
+static int fat16_get_chain_length(struct Disk *disk, int cluster, int *last_cluster)
+{
+    struct FAT_Private *private = disk->fs_private;
+    int length = 0;
+    *last_cluster = 0;
+    while (cluster >= 2 && cluster < private->fat_entries)
+    {
+        if (++length > private->fat_entries)
+        {
+            return -EIO;
+        }
+
+        *last_cluster = cluster;
+        int next = private->fat[cluster];
+        if (next >= BIMBLEOS_FAT16_END_OF_CHAIN)
+        {
+            break;
+        }
+
+        if (next < 2 || next >= BIMBLEOS_FAT16_RESERVED_START)
+        {
+            return -EIO;
+        }
+        cluster = next;
+    }
+
+    return length;
 }
 
 /**
@@ -323,7 +533,13 @@ static int fat16_get_cluster_for_offset(struct Disk *disk, int starting_cluster,
     for (int i = 0; i < clusters_ahead; i++)
     {
         int entry = fat16_get_fat_entry(disk, cluster_to_use);
-        if (entry == 0xFF8 || entry == 0xFFF)
+        if (entry < 0)
+        {
+            res = entry;
+            goto out;
+        }
+
+        if (entry >= BIMBLEOS_FAT16_END_OF_CHAIN)
         {
             // We are at the last entry in the file
             res = -EIO;
@@ -338,7 +554,7 @@ static int fat16_get_cluster_for_offset(struct Disk *disk, int starting_cluster,
         }
 
         // Reserved sector?
-        if (entry == 0xFF0 || entry == 0xFF6)
+        if (entry >= BIMBLEOS_FAT16_RESERVED_START)
         {
             res = -EIO;
             goto out;
@@ -373,7 +589,8 @@ static int fat16_read_internal_from_stream(struct Disk *disk, struct DiskStream
 
     int starting_sector = fat16_cluster_to_sector(private, cluster_to_use);
     int starting_pos = (starting_sector * disk->sector_size) + offset_from_cluster;
-    int total_to_read = total > size_of_cluster_bytes ? size_of_cluster_bytes : total;
+    // Stop at the end of the cluster, the next one need not follow it on disk
+    int total_to_read = total > size_of_cluster_bytes - offset_from_cluster ? size_of_cluster_bytes - offset_from_cluster : total;
     res = diskstreamer_seek(stream, starting_pos);
     if (res != BIMBLEOS_ALL_OK)
     {
@@ -404,6 +621,84 @@ static int fat16_read_internal(struct Disk *disk, int starting_cluster, int offs
     return fat16_read_internal_from_stream(disk, stream, starting_cluster, offset, total, out);
 }
 
+/**
+ * @brief Write 'total' bytes at 'offset' of the chain starting at 'starting_cluster', which
+ *        must already be long enough
+ * 
+ * @param disk 
+ * @param starting_cluster 
+ * @param offset 
+ * @param total 
+ * @param in 
+ * @return int 
+ */
+static int fat16_write_internal(struct Disk *disk, int starting_cluster, int offset, int total, const char *in)
+{
+    int res = 0;
+    struct FAT_Private *private = disk->fs_private;
+    struct DiskStream *stream = private->cluster_read_stream;
+    int size_of_cluster_bytes = fat16_get_cluster_size(disk);
+    int cluster = fat16_get_cluster_for_offset(disk, starting_cluster, offset);
+    while (total > 0)
+    {
+        if (cluster < 2)
+        {
+            res = cluster < 0 ? cluster : -EIO;
+            goto out;
+        }
+
+        int offset_from_cluster = offset % size_of_cluster_bytes;
+        int total_to_write = total > size_of_cluster_bytes - offset_from_cluster ? size_of_cluster_bytes - offset_from_cluster : total;
+        res = diskstreamer_seek(stream, fat16_cluster_to_sector(private, cluster) * disk->sector_size + offset_from_cluster);
+        if (res != BIMBLEOS_ALL_OK)
+        {
+            goto out;
+        }
+
+        res = diskstreamer_write(stream, in, total_to_write);
+        if (res != BIMBLEOS_ALL_OK)
+        {
+            goto out;
+        }
+
+        in += total_to_write;
+        offset += total_to_write;
+        total -= total_to_write;
+        if (total > 0)
+        {
+            // Step along the chain rather than walking it again from the start
+            cluster = fat16_get_fat_entry(disk, cluster);
+        }
+    }
+
+out:
+    return res;
+}
+
+/**
+ * @brief Fill 'cluster' with zeros
+ * 
+ * @param disk 
+ * @param cluster 
+ * @return int 
+ */
+static int fat16_zero_cluster(struct Disk *disk, int cluster)
+{
+    int res = 0;
+    char zeros[BIMBLEOS_SECTOR_SIZE];
+    struct FAT_Private *private = disk->fs_private;
+    struct DiskStream *stream = private->cluster_read_stream;
+    memset(zeros, 0, sizeof(zeros));
+
+    res = diskstreamer_seek(stream, fat16_cluster_to_sector(private, cluster) * disk->sector_size);
+    for (int i = 0; i < private->header.primary_header.sectors_per_cluster && res == BIMBLEOS_ALL_OK; i++)
+    {
+        res = diskstreamer_write(stream, zeros, disk->sector_size);
+    }
+
+    return res;
+}
+
 void fat16_free_directory(struct FAT_Directory *directory)
 {
     if (!directory)
@@ -433,29 +728,35 @@ void fat16_fat_item_free(struct FAT_Item *item)
     kfree(item);
 }
 
-struct FAT_Directory *fat16_load_fat_directory(struct Disk *disk, struct FAT_DirectoryItem *item)
+/**
+ * @brief Load the subdirectory starting at 'cluster'
+ * 
+ * @param disk 
+ * @param cluster 
+ * @return struct FAT_Directory* 0 on failure
+ */
+static struct FAT_Directory *fat16_load_directory(struct Disk *disk, int cluster)
 {
     int res = 0;
-    struct FAT_Directory *directory = 0;
-    struct FAT_Private *fat_private = disk->fs_private;
-    if (!(item->attribute & FAT_FILE_SUBDIRECTORY))
+    struct FAT_Directory *directory = kzalloc(sizeof(struct FAT_Directory));
+    if (!directory)
     {
-        res = -EINVARG;
+        res = -ENOMEM;
         goto out;
     }
 
-    directory = kzalloc(sizeof(struct FAT_Directory));
-    if (!directory)
+    // The whole chain is read, the entries of a directory need not fit in its first cluster
+    int last_cluster = 0;
+    int total_clusters = fat16_get_chain_length(disk, cluster, &last_cluster);
+    if (total_clusters <= 0)
     {
-        res = -ENOMEM;
+        res = -EIO;
         goto out;
     }
 
-    int cluster = fat16_get_first_cluster(item);
-    int cluster_sector = fat16_cluster_to_sector(fat_private, cluster);
-    int total_items = fat16_get_total_items_for_directory(disk, cluster_sector);
-    directory->total = total_items;
-    int directory_size = directory->total * sizeof(struct FAT_DirectoryItem);
+    int directory_size = total_clusters * fat16_get_cluster_size(disk);
+    directory->cluster = cluster;
+    directory->capacity = directory_size / sizeof(struct FAT_DirectoryItem);
     directory->item = kzalloc(directory_size);
     if (!directory->item)
     {
@@ -469,13 +770,27 @@ struct FAT_Directory *fat16_load_fat_directory(struct Disk *disk, struct FAT_Dir
         goto out;
     }
 
+    directory->total = fat16_count_directory_items(directory->item, directory->capacity);
+
 out:
     if (res != BIMBLEOS_ALL_OK)
     {
         fat16_free_directory(directory);
+        directory = 0;
     }
     return directory;
 }
+
+struct FAT_Directory *fat16_load_fat_directory(struct Disk *disk, struct FAT_DirectoryItem *item)
+{
+    if (!(item->attribute & FAT_FILE_SUBDIRECTORY))
+    {
+        return 0;
+    }
+
+    return fat16_load_directory(disk, fat16_get_first_cluster(item));
+}
+
 struct FAT_Item *fat16_new_fat_item_for_directory_item(struct Disk *disk, struct FAT_DirectoryItem *item)
 {
     struct FAT_Item *f_item = kzalloc(sizeof(struct FAT_Item));
@@ -488,6 +803,11 @@ struct FAT_Item *fat16_new_fat_item_for_directory_item(struct Disk *disk, struct
     {
         f_item->directory = fat16_load_fat_directory(disk, item);
         f_item->type = FAT_ITEM_TYPE_DIRECTORY;
+        if (!f_item->directory)
+        {
+            kfree(f_item);
+            return 0;
+        }
         return f_item;
     }
 
@@ -496,71 +816,585 @@ struct FAT_Item *fat16_new_fat_item_for_directory_item(struct Disk *disk, struct
     return f_item;
 }
 
-struct FAT_Item *fat16_find_item_in_directory(struct Disk *disk, struct FAT_Directory *directory, const char *name)
+/**
+ * @brief Byte position on the disk of entry 'index' of 'directory'
+ * 
+ * @param disk 
+ * @param directory 
+ * @param index 
+ * @return int 
+ */
+static int fat16_get_directory_item_position(struct Disk *disk, struct FAT_Directory *directory, int index)
+{
+    struct FAT_Private *fat_private = disk->fs_private;
+    int offset = index * sizeof(struct FAT_DirectoryItem);
+    if (!directory->cluster)
+    {
+        return directory->sector_pos * disk->sector_size + offset;
+    }
+
+    int cluster = fat16_get_cluster_for_offset(disk, directory->cluster, offset);
+    if (cluster < 0)
+    {
+        return cluster;
+    }
+
+    return fat16_cluster_to_sector(fat_private, cluster) * disk->sector_size + offset % fat16_get_cluster_size(disk);
+}
+
+/**
+ * @brief Write 'item' to the directory entry at byte 'pos'. The root directory is kept in
+ *        memory as well, its copy is updated with it
+ * 
+ * @param disk 
+ * @param pos 
+ * @param item 
+ * @return int 
+ */
+static int fat16_write_directory_item(struct Disk *disk, uint32_t pos, struct FAT_DirectoryItem *item)
+{
+    int res = 0;
+    struct FAT_Private *fat_private = disk->fs_private;
+    struct FAT_Directory *root = &fat_private->root_directory;
+    struct DiskStream *stream = fat_private->directory_stream;
+    res = diskstreamer_seek(stream, pos);
+    if (res != BIMBLEOS_ALL_OK)
+    {
+        goto out;
+    }
+
+    res = diskstreamer_write(stream, item, sizeof(struct FAT_DirectoryItem));
+    if (res != BIMBLEOS_ALL_OK)
+    {
+        goto out;
+    }
+
+    bool deleted = item->filename[0] == 0x00 || item->filename[0] == BIMBLEOS_FAT16_DELETED_ITEM;
+    dcache_update(disk, pos, deleted ? 0 : item);
+
+    uint32_t root_pos = root->sector_pos * disk->sector_size;
+    if (pos >= root_pos && pos < root_pos + root->capacity * sizeof(struct FAT_DirectoryItem))
+    {
+        int index = (pos - root_pos) / sizeof(struct FAT_DirectoryItem);
+        memcpy(&root->item[index], item, sizeof(struct FAT_DirectoryItem));
+        if (index >= root->total && item->filename[0] != 0x00)
+        {
+            root->total = index + 1;
+        }
+    }
+
+out:
+    return res;
+}
+
+static int fat16_find_index_in_directory(struct FAT_Directory *directory, const char *name)
 {
-    struct FAT_Item *f_item = 0;
     char tmp_filename[BIMBLEOS_MAX_PATH];
     for (int i = 0; i < directory->total; i++)
     {
+        if (directory->item[i].filename[0] == BIMBLEOS_FAT16_DELETED_ITEM)
+        {
+            continue;
+        }
+
         fat16_get_full_relative_filename(&directory->item[i], tmp_filename, sizeof(tmp_filename));
         if (istrncmp(tmp_filename, name, sizeof(tmp_filename)) == 0)
         {
-            // Found it let's create a new fat_item
-            f_item = fat16_new_fat_item_for_directory_item(disk, &directory->item[i]);
+            return i;
+        }
+    }
+
+    return -EIO;
+}
+
+/**
+ * @brief Find 'name' in the directory starting at cluster 'parent', 0 for the root directory.
+ *        The directory is only loaded and searched when the dentry cache does not know the
+ *        answer, which it is told afterwards
+ * 
+ * @param disk 
+ * @param parent 
+ * @param name 
+ * @param item Set to a copy of the directory entry
+ * @param pos Set to the position of the entry on the disk
+ * @return int 
+ */
+static int fat16_lookup(struct Disk *disk, uint32_t parent, const char *name, struct FAT_DirectoryItem *item, uint32_t *pos)
+{
+    int res = 0;
+    struct FAT_Private *fat_private = disk->fs_private;
+    struct FAT_Directory *directory = &fat_private->root_directory;
+    switch (dcache_lookup(disk, parent, name, item, pos))
+    {
+    case DCACHE_HIT:
+        goto out;
+
+    case DCACHE_NEGATIVE:
+        res = -EIO;
+        goto out;
+    }
+
+    if (parent)
+    {
+        directory = fat16_load_directory(disk, parent);
+        if (!directory)
+        {
+            res = -EIO;
+            goto out;
         }
     }
 
+    int index = fat16_find_index_in_directory(directory, name);
+    if (index < 0)
+    {
+        dcache_insert(disk, parent, name, 0, 0);
+        res = index;
+        goto out;
+    }
+
+    res = fat16_get_directory_item_position(disk, directory, index);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    *pos = res;
+    memcpy(item, &directory->item[index], sizeof(struct FAT_DirectoryItem));
+    dcache_insert(disk, parent, name, item, *pos);
+    res = 0;
+
+out:
+    if (directory != &fat_private->root_directory)
+    {
+        fat16_free_directory(directory);
+    }
+    return res;
+}
+
+/**
+ * @brief The item of the path parts from 'path' up to but not including 'end', 0 walks the
+ *        whole path
+ * 
+ * @param disk 
+ * @param path 
+ * @param end 
+ * @return struct FAT_Item* 
+ */
+static struct FAT_Item *fat16_walk_path(struct Disk *disk, struct PathPart *path, struct PathPart *end)
+{
+    struct FAT_Item *f_item = 0;
+    struct FAT_DirectoryItem item;
+    uint32_t pos = 0;
+    uint32_t parent = 0;
+    for (struct PathPart *part = path; part != end; part = part->next)
+    {
+        if (part != path)
+        {
+            if (!(item.attribute & FAT_FILE_SUBDIRECTORY))
+            {
+                goto out;
+            }
+            parent = fat16_get_first_cluster(&item);
+        }
+
+        if (fat16_lookup(disk, parent, part->part, &item, &pos) < 0)
+        {
+            goto out;
+        }
+    }
+
+    f_item = fat16_new_fat_item_for_directory_item(disk, &item);
+    if (f_item)
+    {
+        f_item->entry_pos = pos;
+    }
+
+out:
     return f_item;
 }
 
 struct FAT_Item *fat16_get_directory_entry(struct Disk *disk, struct PathPart* path)
 {
-    struct FAT_Private *fat_private = disk->fs_private;
-    struct FAT_Item *current_item = 0;
-    struct FAT_Item *root_item = fat16_find_item_in_directory(disk, &fat_private->root_directory, path->part);
-    if (!root_item)
+    return fat16_walk_path(disk, path, 0);
+}
+
+static bool fat16_is_short_name_char(char c)
+{
+    const char *invalid = "\"*+,/:;<=>?[\\]|";
+    if (c <= ' ' || c >= 0x7F)
+    {
+        return false;
+    }
+
+    for (; *invalid; invalid++)
+    {
+        if (c == *invalid)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Space padded upper case 8.3 name of 'name', "log.txt" becomes "LOG     TXT"
+ * 
+ * @param item 
+ * @param name 
+ * @return int -EINVARG for names that do not fit
+ */
+static int fat16_set_short_name(struct FAT_DirectoryItem *item, const char *name)
+{
+    memset(item->filename, ' ', sizeof(item->filename));
+    memset(item->ext, ' ', sizeof(item->ext));
+
+    uint8_t *out = item->filename;
+    int max = sizeof(item->filename);
+    int length = 0;
+    for (; *name; name++)
+    {
+        if (*name == '.')
+        {
+            if (out != item->filename || length == 0)
+            {
+                return -EINVARG;
+            }
+
+            out = item->ext;
+            max = sizeof(item->ext);
+            length = 0;
+            continue;
+        }
+
+        if (length >= max || !fat16_is_short_name_char(*name))
+        {
+            return -EINVARG;
+        }
+
+        out[length++] = (*name >= 'a' && *name <= 'z') ? *name - 32 : *name;
+    }
+
+    return item->filename[0] == ' ' ? -EINVARG : 0;
+}
+
+/**
+ * @brief Grow a subdirectory that has no free entry left by one zeroed cluster. The root
+ *        directory has a fixed size
+ * 
+ * @param disk 
+ * @param directory 
+ * @return int 
+ */
+static int fat16_extend_directory(struct Disk *disk, struct FAT_Directory *directory)
+{
+    int res = 0;
+    int last_cluster = 0;
+    if (!directory->cluster)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    res = fat16_get_chain_length(disk, directory->cluster, &last_cluster);
+    if (res <= 0)
+    {
+        res = -EIO;
+        goto out;
+    }
+
+    int cluster = fat16_allocate_cluster(disk);
+    if (cluster < 0)
+    {
+        res = cluster;
+        goto out;
+    }
+
+    // Zeroed entries read as the end of the directory
+    res = fat16_zero_cluster(disk, cluster);
+    if (res < 0)
+    {
+        fat16_set_fat_entry(disk, cluster, BIMBLEOS_FAT16_UNUSED);
+        goto out;
+    }
+
+    fat16_set_fat_entry(disk, last_cluster, cluster);
+    directory->capacity += fat16_get_cluster_size(disk) / sizeof(struct FAT_DirectoryItem);
+
+out:
+    return res;
+}
+
+/**
+ * @brief Add an empty file called 'name' to 'directory', in the first deleted entry or after
+ *        the last one
+ * 
+ * @param disk 
+ * @param directory 
+ * @param name 
+ * @return struct FAT_Item* The new file or an error
+ */
+static struct FAT_Item *fat16_create_item(struct Disk *disk, struct FAT_Directory *directory, const char *name)
+{
+    int res = 0;
+    struct FAT_Item *f_item = 0;
+    struct FAT_DirectoryItem item;
+    memset(&item, 0, sizeof(item));
+    res = fat16_set_short_name(&item, name);
+    if (res < 0)
     {
         goto out;
     }
+    item.attribute = FAT_FILE_ARCHIVED;
 
-    struct PathPart *next_part = path->next;
-    current_item = root_item;
-    while (next_part != 0)
+    int index = directory->total;
+    for (int i = 0; i < directory->total; i++)
     {
-        if (current_item->type != FAT_ITEM_TYPE_DIRECTORY)
+        if (directory->item[i].filename[0] == BIMBLEOS_FAT16_DELETED_ITEM)
         {
-            current_item = 0;
+            index = i;
             break;
         }
+    }
+
+    if (index >= directory->capacity)
+    {
+        res = fat16_extend_directory(disk, directory);
+        if (res < 0)
+        {
+            goto out;
+        }
+    }
 
-        struct FAT_Item *tmp_item = fat16_find_item_in_directory(disk, current_item->directory, next_part->part);
-        fat16_fat_item_free(current_item);
-        current_item = tmp_item;
-        next_part = next_part->next;
+    int pos = fat16_get_directory_item_position(disk, directory, index);
+    if (pos < 0)
+    {
+        res = pos;
+        goto out;
+    }
+
+    res = fat16_write_directory_item(disk, pos, &item);
+    if (res < 0)
+    {
+        goto out;
     }
+
+    // A new last entry moves the end marker behind it
+    if (index == directory->total && index + 1 < directory->capacity)
+    {
+        struct FAT_DirectoryItem end_item;
+        memset(&end_item, 0, sizeof(end_item));
+        int end_pos = fat16_get_directory_item_position(disk, directory, index + 1);
+        res = end_pos < 0 ? end_pos : fat16_write_directory_item(disk, end_pos, &end_item);
+        if (res < 0)
+        {
+            goto out;
+        }
+    }
+
+    // Replaces the negative entry the failed lookup before the create left
+    dcache_insert(disk, directory->cluster, name, &item, pos);
+
+    f_item = fat16_new_fat_item_for_directory_item(disk, &item);
+    if (!f_item)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+    f_item->entry_pos = pos;
+
 out:
-    return current_item;
+    if (res < 0)
+    {
+        return ERROR(res);
+    }
+    return f_item;
 }
 
 /**
- * @brief 
+ * @brief Create the file at 'path' in its parent directory, which must exist
+ * 
+ * @param disk 
+ * @param path 
+ * @return struct FAT_Item* The new file or an error
+ */
+static struct FAT_Item *fat16_create_file(struct Disk *disk, struct PathPart *path)
+{
+    struct FAT_Private *fat_private = disk->fs_private;
+    struct FAT_Directory *directory = &fat_private->root_directory;
+    struct FAT_Item *parent_item = 0;
+    struct FAT_Item *f_item = 0;
+    struct PathPart *last_part = path;
+    while (last_part->next)
+    {
+        last_part = last_part->next;
+    }
+
+    if (last_part != path)
+    {
+        parent_item = fat16_walk_path(disk, path, last_part);
+        if (!parent_item || parent_item->type != FAT_ITEM_TYPE_DIRECTORY)
+        {
+            f_item = ERROR(-EIO);
+            goto out;
+        }
+        directory = parent_item->directory;
+    }
+
+    f_item = fat16_create_item(disk, directory, last_part->part);
+
+out:
+    if (parent_item)
+    {
+        fat16_fat_item_free(parent_item);
+    }
+    return f_item;
+}
+
+/**
+ * @brief Shrink the file of 'f_item' to 'size' bytes, the clusters past it are freed
+ * 
+ * @param disk 
+ * @param f_item 
+ * @param size 
+ * @return int 
+ */
+static int fat16_truncate(struct Disk *disk, struct FAT_Item *f_item, uint32_t size)
+{
+    int res = 0;
+    struct FAT_Private *fat_private = disk->fs_private;
+    struct FAT_DirectoryItem *item = f_item->item;
+    if (size >= item->filesize)
+    {
+        goto out;
+    }
+
+    int first_cluster = fat16_get_first_cluster(item);
+    if (size == 0)
+    {
+        fat16_free_chain(disk, first_cluster);
+        fat16_set_first_cluster(item, 0);
+    }
+    else
+    {
+        int last_cluster = fat16_get_cluster_for_offset(disk, first_cluster, size - 1);
+        if (last_cluster < 0)
+        {
+            res = last_cluster;
+            goto out;
+        }
+
+        int next_cluster = fat_private->fat[last_cluster];
+        fat16_set_fat_entry(disk, last_cluster, BIMBLEOS_FAT16_LAST_CLUSTER);
+        if (next_cluster < BIMBLEOS_FAT16_END_OF_CHAIN)
+        {
+            fat16_free_chain(disk, next_cluster);
+        }
+    }
+
+    item->filesize = size;
+    res = fat16_write_directory_item(disk, f_item->entry_pos, item);
+
+out:
+    return res;
+}
+
+/**
+ * @brief Grow the chain of 'item' until it holds 'size' bytes. Fails before taking any
+ *        cluster when there are not enough free ones
+ * 
+ * @param disk 
+ * @param item 
+ * @param size 
+ * @return int 
+ */
+static int fat16_reserve_clusters(struct Disk *disk, struct FAT_DirectoryItem *item, uint32_t size)
+{
+    int res = 0;
+    struct FAT_Private *fat_private = disk->fs_private;
+    int size_of_cluster_bytes = fat16_get_cluster_size(disk);
+    int needed = (size + size_of_cluster_bytes - 1) / size_of_cluster_bytes;
+    int last_cluster = 0;
+    int length = fat16_get_chain_length(disk, fat16_get_first_cluster(item), &last_cluster);
+    if (length < 0)
+    {
+        res = length;
+        goto out;
+    }
+
+    if (needed - length > (int)fat_private->free_clusters)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    for (; length < needed; length++)
+    {
+        int cluster = fat16_allocate_cluster(disk);
+        if (cluster < 0)
+        {
+            res = cluster;
+            goto out;
+        }
+
+        if (last_cluster)
+        {
+            fat16_set_fat_entry(disk, last_cluster, cluster);
+        }
+        else
+        {
+            fat16_set_first_cluster(item, cluster);
+        }
+        last_cluster = cluster;
+    }
+
+out:
+    return res;
+}
+
+/**
+ * @brief Open the file at 'path_part'. Writing creates a missing file and empties an existing
+ *        one, appending creates it and starts at its end
  * 
  * @param disk 
  * @param path_part 
  * @param filemode 
  * @return void* Pointer to file descriptor
  */
-void *fat16_open(struct Disk *disk, struct PathPart *path_part, FILE_MODE filemode)
+/**
+ * @brief Whether opening the file entry at 'entry_pos' in 'filemode' clashes with a descriptor
+ *        open on it. Each descriptor writes back its own copy of the entry, so a writer must
+ *        have the file to itself
+ * 
+ * @param disk 
+ * @param entry_pos 
+ * @param filemode 
+ * @return true 
+ */
+static bool fat16_open_conflicts(struct Disk *disk, uint32_t entry_pos, FILE_MODE filemode)
 {
-   struct FAT_FileDescriptor *descriptor = 0;
-    int err_code = 0;
-    // Currently only support reading     
-    if (filemode != FILE_MODE_READ)
+    struct FAT_Private *private = disk->fs_private;
+    for (struct FAT_FileDescriptor *open = private->open_files; open; open = open->next)
     {
-        err_code = -ERDONLY;
-        goto err_out;
+        if (open->item->type != FAT_ITEM_TYPE_FILE || open->item->entry_pos != entry_pos)
+        {
+            continue;
+        }
+
+        if (filemode != FILE_MODE_READ || open->mode != FILE_MODE_READ)
+        {
+            return true;
+        }
     }
 
+    return false;
+}
+
+void *fat16_open(struct Disk *disk, struct PathPart *path_part, FILE_MODE filemode)
+{
+    struct FAT_FileDescriptor *descriptor = 0;
+    int err_code = 0;
+
     descriptor = kzalloc(sizeof(struct FAT_FileDescriptor));
     if (!descriptor)
     {
@@ -569,24 +1403,84 @@ void *fat16_open(struct Disk *disk, struct PathPart *path_part, FILE_MODE filemo
     }
 
     descriptor->item = fat16_get_directory_entry(disk, path_part);
+    if (!descriptor->item && filemode != FILE_MODE_READ)
+    {
+        descriptor->item = fat16_create_file(disk, path_part);
+        if (ISERR(descriptor->item))
+        {
+            err_code = ERROR_I(descriptor->item);
+            descriptor->item = 0;
+            goto err_out;
+        }
+    }
+
     if (!descriptor->item)
     {
         err_code = -EIO;
         goto err_out;
     }
 
-    descriptor->pos = 0;
+    if (descriptor->item->type == FAT_ITEM_TYPE_FILE && fat16_open_conflicts(disk, descriptor->item->entry_pos, filemode))
+    {
+        err_code = -EBUSY;
+        goto err_out;
+    }
+
+    if (filemode != FILE_MODE_READ)
+    {
+        if (descriptor->item->type != FAT_ITEM_TYPE_FILE)
+        {
+            err_code = -EINVARG;
+            goto err_out;
+        }
+
+        if (descriptor->item->item->attribute & FAT_FILE_READ_ONLY)
+        {
+            err_code = -ERDONLY;
+            goto err_out;
+        }
+    }
+
+    if (filemode == FILE_MODE_WRITE)
+    {
+        err_code = fat16_truncate(disk, descriptor->item, 0);
+        if (err_code < 0)
+        {
+            goto err_out;
+        }
+    }
+
+    descriptor->pos = filemode == FILE_MODE_APPEND ? descriptor->item->item->filesize : 0;
+    descriptor->mode = filemode;
+    descriptor->disk = disk;
+    struct FAT_Private *private = disk->fs_private;
+    descriptor->next = private->open_files;
+    private->open_files = descriptor;
     return descriptor;
 
 err_out:
-    if(descriptor)
+    if (descriptor)
+    {
+        if (descriptor->item)
+        {
+            fat16_fat_item_free(descriptor->item);
+        }
         kfree(descriptor);
+    }
 
     return ERROR(err_code);
 }
 
 static void fat16_free_file_descriptor(struct FAT_FileDescriptor* desc)
 {
+    struct FAT_Private* private = desc->disk->fs_private;
+    struct FAT_FileDescriptor** link = &private->open_files;
+    while (*link != desc)
+    {
+        link = &(*link)->next;
+    }
+    *link = desc->next;
+
     fat16_fat_item_free(desc->item);
     kfree(desc);
 }
@@ -637,6 +1531,8 @@ int fat16_read(struct Disk *disk, void *descriptor, uint32_t size, uint32_t nmem
         offset += size;
     }
 
+    // Consecutive reads continue where the last one stopped
+    fat_desc->pos = offset;
     res = nmemb;
 out:
     return res;
@@ -682,5 +1578,160 @@ out:
     return res;
 }
 
+/**
+ * @brief Write 'nmemb' items of 'size' bytes at the current position, growing the file and
+ *        its chain as needed. FAT changes stay in memory until fat16_flush
+ * 
+ * @param disk 
+ * @param descriptor 
+ * @param size 
+ * @param nmemb 
+ * @param in 
+ * @return int 'nmemb', negative on failure
+ */
+int fat16_write(struct Disk *disk, void *descriptor, uint32_t size, uint32_t nmemb, const char *in)
+{
+    int res = 0;
+    struct FAT_FileDescriptor *fat_desc = descriptor;
+    struct FAT_Item *f_item = fat_desc->item;
+    if (fat_desc->mode == FILE_MODE_READ)
+    {
+        res = -ERDONLY;
+        goto out;
+    }
 
+    if (f_item->type != FAT_ITEM_TYPE_FILE)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    struct FAT_DirectoryItem *item = f_item->item;
+    uint32_t total = size * nmemb;
+    uint32_t end = fat_desc->pos + total;
+    if ((nmemb && total / nmemb != size) || end < fat_desc->pos)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    res = fat16_reserve_clusters(disk, item, end);
+    if (res == BIMBLEOS_ALL_OK)
+    {
+        res = fat16_write_internal(disk, fat16_get_first_cluster(item), fat_desc->pos, total, in);
+    }
 
+    if (res == BIMBLEOS_ALL_OK)
+    {
+        fat_desc->pos = end;
+        if (end > item->filesize)
+        {
+            item->filesize = end;
+        }
+    }
+
+    // The entry points at every cluster reserved, even when writing the data failed
+    int updated = fat16_write_directory_item(disk, f_item->entry_pos, item);
+    res = res < 0 ? res : updated;
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    res = nmemb;
+out:
+    return res;
+}
+
+/**
+ * @brief Delete the file at 'path' and free its clusters. Fails with -EBUSY while a descriptor
+ *        is open on it, its copy of the entry would bring the freed clusters back
+ * 
+ * @param disk 
+ * @param path 
+ * @return int 
+ */
+int fat16_unlink(struct Disk *disk, struct PathPart *path)
+{
+    int res = 0;
+    struct FAT_Item *f_item = fat16_get_directory_entry(disk, path);
+    if (!f_item)
+    {
+        res = -EIO;
+        goto out;
+    }
+
+    if (f_item->type != FAT_ITEM_TYPE_FILE)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    struct FAT_DirectoryItem *item = f_item->item;
+    if (item->attribute & FAT_FILE_READ_ONLY)
+    {
+        res = -ERDONLY;
+        goto out;
+    }
+
+    // Any open descriptor clashes with a writer
+    if (fat16_open_conflicts(disk, f_item->entry_pos, FILE_MODE_WRITE))
+    {
+        res = -EBUSY;
+        goto out;
+    }
+
+    fat16_free_chain(disk, fat16_get_first_cluster(item));
+    item->filename[0] = BIMBLEOS_FAT16_DELETED_ITEM;
+    res = fat16_write_directory_item(disk, f_item->entry_pos, item);
+
+out:
+    if (f_item)
+    {
+        fat16_fat_item_free(f_item);
+    }
+    return res;
+}
+
+/**
+ * @brief Write the dirty sectors of the FAT to every FAT copy. They go through the buffer
+ *        cache like any other write, bcache_sync puts them on the disk
+ * 
+ * @param disk 
+ * @return int 
+ */
+int fat16_flush(struct Disk *disk)
+{
+    int res = 0;
+    struct FAT_Private *private = disk->fs_private;
+    struct FAT_Header *header = &private->header.primary_header;
+    struct DiskStream *stream = private->fat_read_stream;
+    for (uint32_t sector = 0; sector < header->sectors_per_fat && private->fat_dirty_sectors; sector++)
+    {
+        if (!private->fat_dirty[sector])
+        {
+            continue;
+        }
+
+        for (int copy = 0; copy < header->fat_copies; copy++)
+        {
+            uint32_t fat_sector = fat16_get_first_fat_sector(private) + copy * header->sectors_per_fat + sector;
+            res = diskstreamer_seek(stream, fat_sector * disk->sector_size);
+            if (res == BIMBLEOS_ALL_OK)
+            {
+                res = diskstreamer_write(stream, (char *)private->fat + sector * disk->sector_size, disk->sector_size);
+            }
+
+            if (res < 0)
+            {
+                goto out;
+            }
+        }
+
+        private->fat_dirty[sector] = false;
+        private->fat_dirty_sectors--;
+    }
+
+out:
+    return res;
+}
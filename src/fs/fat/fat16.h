@@ -1,13 +1,18 @@
 #ifndef FAT16_H
 #define FAT16_H
 #include "file.h"
+#include <stdbool.h>
 
 
 
 #define BIMBLEOS_FAT16_SIGNATURE 0x29
 #define BIMBLEOS_FAT16_FAT_ENTRY_SIZE 0x02
-#define BIMBLEOS_FAT16_BAD_SECTOR 0xFF7
+#define BIMBLEOS_FAT16_BAD_SECTOR 0xFFF7
+#define BIMBLEOS_FAT16_RESERVED_START 0xFFF0
+#define BIMBLEOS_FAT16_END_OF_CHAIN 0xFFF8        // This and above end a cluster chain
+#define BIMBLEOS_FAT16_LAST_CLUSTER 0xFFFF        // Written to end the chains we build
 #define BIMBLEOS_FAT16_UNUSED 0x00
+#define BIMBLEOS_FAT16_DELETED_ITEM 0xE5          // First filename byte of a deleted directory entry
 
 typedef unsigned int FAT_ITEM_TYPE;
 #define FAT_ITEM_TYPE_DIRECTORY 0
@@ -80,7 +85,9 @@ struct FAT_DirectoryItem
 struct FAT_Directory
 {
     struct FAT_DirectoryItem *item;
-    int total;
+    int total;                  // Entries before the end marker, deleted ones included
+    int capacity;               // Entries 'item' has room for
+    int cluster;                // First cluster, 0 for the root directory
     int sector_pos;
     int ending_sector_pos;
 };
@@ -94,12 +101,18 @@ struct FAT_Item
     };
 
     FAT_ITEM_TYPE type;
+    uint32_t entry_pos;         // Byte position of the directory entry on the disk
 };
 
 struct FAT_FileDescriptor
 {
     struct FAT_Item *item;
     uint32_t pos;
+    FILE_MODE mode;
+
+    // Open descriptors of the disk, each holds its own copy of the directory entry
+    struct Disk *disk;
+    struct FAT_FileDescriptor *next;
 };
 
 struct FAT_Private
@@ -114,6 +127,21 @@ struct FAT_Private
 
     // Used in situations where we stream the directory
     struct DiskStream *directory_stream;
+
+    // The first FAT copy, held in memory. Updates mark its sectors dirty and reach every
+    // copy on the disk with fat16_flush
+    uint16_t *fat;
+    uint32_t fat_entries;       // Clusters 0 and 1 included
+    bool *fat_dirty;            // One flag per FAT sector
+    uint32_t fat_dirty_sectors;
+
+    // One bit per cluster, set while it is in use, so allocating does not rescan the FAT
+    uint32_t *cluster_map;
+    uint32_t free_clusters;
+    uint32_t next_free;         // Where the search for a free cluster starts
+
+    // Descriptors open on the disk, see fat16_open_conflicts
+    struct FAT_FileDescriptor *open_files;
 };
 
 
@@ -127,6 +155,9 @@ int fat16_read(struct Disk *disk, void *descriptor, uint32_t size, uint32_t nmem
 int fat16_seek(void *private, uint32_t offset, FILE_SEEK_MODE seek_mode);
 int fat16_stat(struct Disk* disk, void* private, struct FileStat* stat);
 int fat16_close(void* private);
+int fat16_write(struct Disk *disk, void *descriptor, uint32_t size, uint32_t nmemb, const char *in);
+int fat16_unlink(struct Disk *disk, struct PathPart *path);
+int fat16_flush(struct Disk *disk);
 
 
 #endif
\ No newline at end of file
@@ -6,12 +6,18 @@
 #include "kernel.h"
 #include "disk/disk.h"
 #include "fat/fat16.h"
+#include "proc/procfs.h"
 #include "string/string.h"
+#include "smp/spinlock.h"
+#include "disk/bcache.h"
 
 
 struct Filesystem* filesystems[BIMBLEOS_MAX_FILESYSTEMS];
 struct FileDescriptor* file_descriptors[BIMBLEOS_MAX_FILE_DESCRIPTORS];
 
+// Filesystem drivers keep shared stream state per disk, so one cpu at a time goes through the VFS
+static struct Spinlock fs_lock = SPINLOCK_INIT;
+
 /**
  * @brief Return a pointer to free Filesystem from 'filesystems'
  * 
@@ -55,6 +61,8 @@ void fs_insert_filesystem(struct Filesystem* filesystem)
  */
 static void fs_static_load()
 {
+    // procfs first, it claims only the proc disk and spares FAT16 probing a disk without sectors
+    fs_insert_filesystem(procfs_init());
     fs_insert_filesystem(fat16_init());
 }
 
@@ -129,6 +137,7 @@ struct Filesystem* fs_resolve(struct Disk* disk)
 int fstat(int fd, struct FileStat* stat)
 {
     int res = 0;
+    spinlock_acquire(&fs_lock);
     struct FileDescriptor* desc = file_get_descriptor(fd);
     if (!desc)
     {
@@ -138,6 +147,7 @@ int fstat(int fd, struct FileStat* stat)
 
     res = desc->filesystem->stat(desc->disk, desc->private_data, stat);
 out:
+    spinlock_release(&fs_lock);
     return res;
 }
 
@@ -165,6 +175,7 @@ FILE_MODE file_get_mode_by_string(const char* str)
 int fseek(int fd, int offset, FILE_SEEK_MODE whence)
 {
     int res = 0;
+    spinlock_acquire(&fs_lock);
     struct FileDescriptor* desc = file_get_descriptor(fd);
     if (!desc)
     {
@@ -174,11 +185,13 @@ int fseek(int fd, int offset, FILE_SEEK_MODE whence)
 
     res = desc->filesystem->seek(desc->private_data, offset, whence);
 out:
+    spinlock_release(&fs_lock);
     return res;
 }
 int fopen(const char* filename, const char* mode_str)
 {
     int res = 0;
+    spinlock_acquire(&fs_lock);
     struct PathRoot* root_path = pathparser_parse(filename, NULL);
     if (!root_path)
     {
@@ -233,10 +246,7 @@ int fopen(const char* filename, const char* mode_str)
     res = desc->index;
 
 out:
-    // fopen shouldnt return negative values
-    if (res < 0)
-        res = 0;
-
+    spinlock_release(&fs_lock);
     return res;
 }
 
@@ -251,6 +261,7 @@ static void file_free_descriptor(struct FileDescriptor* desc)
 int fclose(int fd)
 {
     int res = 0;
+    spinlock_acquire(&fs_lock);
     struct FileDescriptor* desc = file_get_descriptor(fd);
     if (!desc)
     {
@@ -261,14 +272,21 @@ int fclose(int fd)
     res = desc->filesystem->close(desc->private_data);
     if (res == BIMBLEOS_ALL_OK)
     {
+        // Metadata a filesystem batches in memory reaches the disk once its files are closed
+        if (desc->filesystem->flush)
+        {
+            res = desc->filesystem->flush(desc->disk);
+        }
         file_free_descriptor(desc);
     }
 out:
+    spinlock_release(&fs_lock);
     return res;
 }
 int fread(void* ptr, uint32_t size, uint32_t nmemb, int fd)
 {
     int res = 0;
+    spinlock_acquire(&fs_lock);
     if (size == 0 || nmemb == 0 || fd < 1)
     {
         res = -EINVARG;
@@ -284,5 +302,105 @@ int fread(void* ptr, uint32_t size, uint32_t nmemb, int fd)
 
     res = desc->filesystem->read(desc->disk, desc->private_data, size, nmemb, (char*) ptr);
 out:
+    spinlock_release(&fs_lock);
+    return res;
+}
+
+int fwrite(const void* ptr, uint32_t size, uint32_t nmemb, int fd)
+{
+    int res = 0;
+    spinlock_acquire(&fs_lock);
+    if (size == 0 || nmemb == 0 || fd < 1)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    struct FileDescriptor* desc = file_get_descriptor(fd);
+    if (!desc)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    if (!desc->filesystem->write)
+    {
+        res = -ERDONLY;
+        goto out;
+    }
+
+    res = desc->filesystem->write(desc->disk, desc->private_data, size, nmemb, (const char*) ptr);
+out:
+    spinlock_release(&fs_lock);
     return res;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Delete the file 'filename', e.g. 0:/log.txt. Files still open can not be deleted
+ * 
+ * @param filename 
+ * @return int -EBUSY while the file is open
+ */
+int funlink(const char* filename)
+{
+    int res = 0;
+    spinlock_acquire(&fs_lock);
+    struct PathRoot* root_path = pathparser_parse(filename, NULL);
+    if (!root_path || !root_path->first)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    struct Disk* disk = disk_get(root_path->drive_no);
+    if (!disk || !disk->filesystem)
+    {
+        res = -EIO;
+        goto out;
+    }
+
+    if (!disk->filesystem->unlink)
+    {
+        res = -ERDONLY;
+        goto out;
+    }
+
+    res = disk->filesystem->unlink(disk, root_path->first);
+    if (res == BIMBLEOS_ALL_OK && disk->filesystem->flush)
+    {
+        res = disk->filesystem->flush(disk);
+    }
+out:
+    if (root_path)
+    {
+        pathparser_free(root_path);
+    }
+    spinlock_release(&fs_lock);
+    return res;
+}
+
+/**
+ * @brief Flush what every filesystem holds in memory, then write the buffer cache back and
+ *        flush the drive caches
+ * 
+ * @return int 
+ */
+int fs_sync()
+{
+    int res = 0;
+    spinlock_acquire(&fs_lock);
+    for (int i = 0; i < BIMBLEOS_MAX_DISKS; i++)
+    {
+        struct Disk* disk = disk_get(i);
+        if (disk && disk->filesystem && disk->filesystem->flush)
+        {
+            int flushed = disk->filesystem->flush(disk);
+            res = res < 0 ? res : flushed;
+        }
+    }
+
+    int synced = bcache_sync();
+    res = res < 0 ? res : synced;
+    spinlock_release(&fs_lock);
+    return res;
+}
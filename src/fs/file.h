@@ -35,6 +35,9 @@ typedef int (*FS_READ_FUNCTION)(struct Disk *disk, void *private, uint32_t size,
 typedef int (*FS_RESOLVE_FUNCTION)(struct Disk *);
 typedef int (*FS_CLOSE_FUNCTION)(void *);
 typedef int (*FS_SEEK_FUNCTION)(void *, uint32_t, FILE_SEEK_MODE);
+typedef int (*FS_WRITE_FUNCTION)(struct Disk *disk, void *private, uint32_t size, uint32_t nmemb, const char *in);
+typedef int (*FS_UNLINK_FUNCTION)(struct Disk *disk, struct PathPart *path);
+typedef int (*FS_FLUSH_FUNCTION)(struct Disk *disk);
 
 struct FileStat
 {
@@ -55,6 +58,11 @@ struct Filesystem
     FS_SEEK_FUNCTION seek;
     FS_CLOSE_FUNCTION close;
     FS_STAT_FUNCTION stat;
+    // Optional, filesystems without them are read only
+    FS_WRITE_FUNCTION write;
+    FS_UNLINK_FUNCTION unlink;
+    // Optional, writes state held in memory back to the disk
+    FS_FLUSH_FUNCTION flush;
     char name[20];
 };
 
@@ -77,6 +85,9 @@ void fs_init();
 int fopen(const char *, const char *);
 int fseek(int, int, FILE_SEEK_MODE);
 int fread(void *, uint32_t , uint32_t, int);
+int fwrite(const void *, uint32_t, uint32_t, int);
+int funlink(const char *);
+int fs_sync();
 int fstat(int, struct FileStat *);
 int fclose(int);
 void fs_insert_filesystem(struct Filesystem *);
@@ -0,0 +1,386 @@
+#include "procfs.h"
+#include "config.h"
+#include "status.h"
+#include "kernel.h"
+#include "disk/disk.h"
+#include "disk/ata.h"
+#include "disk/bcache.h"
+#include "fs/dcache.h"
+#include "memory/memory.h"
+#include "memory/heap/kheap.h"
+#include "string/string.h"
+#include "idt/stats.h"
+#include "isr80h/stats.h"
+#include "memory/heap/heap.h"
+
+static void procfs_interrupts(struct ProcfsBuffer *buffer);
+static void procfs_syscalls(struct ProcfsBuffer *buffer);
+static void procfs_heap(struct ProcfsBuffer *buffer);
+static void procfs_disks(struct ProcfsBuffer *buffer);
+static void procfs_bcache(struct ProcfsBuffer *buffer);
+static void procfs_dcache(struct ProcfsBuffer *buffer);
+
+struct Filesystem procfs_fs =
+{
+    .resolve = procfs_resolve,
+    .open = procfs_open,
+    .read = procfs_read,
+    .seek = procfs_seek,
+    .stat = procfs_stat,
+    .close = procfs_close,
+};
+
+static struct ProcfsFile procfs_files[] =
+{
+    {.name = "interrupts", .generate = procfs_interrupts},
+    {.name = "syscalls", .generate = procfs_syscalls},
+    {.name = "heap", .generate = procfs_heap},
+    {.name = "disks", .generate = procfs_disks},
+    {.name = "bcache", .generate = procfs_bcache},
+    {.name = "dcache", .generate = procfs_dcache},
+};
+
+struct Filesystem *procfs_init()
+{
+    strcpy(procfs_fs.name, "PROCFS");
+    return &procfs_fs;
+}
+
+static void procfs_write_string(struct ProcfsBuffer *buffer, const char *str)
+{
+    while (*str && buffer->length < buffer->size)
+    {
+        buffer->data[buffer->length++] = *str++;
+    }
+}
+
+/**
+ * @brief Write a decimal number right aligned to 'width'
+ * 
+ * @param buffer 
+ * @param value 
+ * @param width 
+ */
+static void procfs_write_number(struct ProcfsBuffer *buffer, uint32_t value, int width)
+{
+    char digits[11];
+    int loc = sizeof(digits) - 1;
+    digits[loc] = 0;
+    do
+    {
+        digits[--loc] = '0' + (value % 10);
+        value /= 10;
+    } while (value);
+
+    for (int i = sizeof(digits) - 1 - loc; i < width; i++)
+    {
+        procfs_write_string(buffer, " ");
+    }
+    procfs_write_string(buffer, &digits[loc]);
+}
+
+static void procfs_interrupts(struct ProcfsBuffer *buffer)
+{
+    procfs_write_string(buffer, "Interrupt      Count   Mean cycles    Max cycles   Max latency\n");
+    for (int i = 0; i < BIMBLEOS_TOTAL_INTERRUPTS; i++)
+    {
+        struct InterruptStatsEntry entry;
+        if (!idt_stats_get(i, &entry))
+        {
+            continue;
+        }
+
+        procfs_write_number(buffer, entry.interrupt, 9);
+        procfs_write_number(buffer, entry.count, 11);
+        procfs_write_number(buffer, entry.mean_cycles, 14);
+        procfs_write_number(buffer, entry.max_cycles, 14);
+        procfs_write_number(buffer, entry.max_latency_cycles, 14);
+        procfs_write_string(buffer, "\n");
+    }
+}
+
+static void procfs_syscalls(struct ProcfsBuffer *buffer)
+{
+    procfs_write_string(buffer, "Command      Count   Mean cycles    P99 cycles\n");
+    for (int i = 0; i < BIMBLEOS_MAX_TRACKED_ISR80H_COMMANDS; i++)
+    {
+        struct SyscallStatsEntry entry;
+        if (!isr80h_stats_get(i, &entry))
+        {
+            continue;
+        }
+
+        procfs_write_number(buffer, entry.command, 7);
+        procfs_write_number(buffer, entry.count, 11);
+        procfs_write_number(buffer, entry.mean_cycles, 14);
+        procfs_write_number(buffer, entry.p99_cycles, 14);
+        procfs_write_string(buffer, "\n");
+    }
+}
+
+/**
+ * @brief Write a number in hexadecimal, zero padded to 8 digits
+ * 
+ * @param buffer 
+ * @param value 
+ */
+static void procfs_write_hex(struct ProcfsBuffer *buffer, uint32_t value)
+{
+    char digits[9];
+    for (int i = 7; i >= 0; i--)
+    {
+        digits[i] = "0123456789abcdef"[value & 0xF];
+        value >>= 4;
+    }
+    digits[8] = 0;
+
+    procfs_write_string(buffer, "0x");
+    procfs_write_string(buffer, digits);
+}
+
+static void procfs_heap(struct ProcfsBuffer *buffer)
+{
+    struct HeapStats stats;
+    kheap_get_stats(&stats);
+
+    procfs_write_string(buffer, "Total blocks     ");
+    procfs_write_number(buffer, stats.total_blocks, 10);
+    procfs_write_string(buffer, "\nUsed blocks      ");
+    procfs_write_number(buffer, stats.used_blocks, 10);
+    procfs_write_string(buffer, "\nFree blocks      ");
+    procfs_write_number(buffer, stats.free_blocks, 10);
+    procfs_write_string(buffer, "\nLargest free run ");
+    procfs_write_number(buffer, stats.largest_free_run, 10);
+    procfs_write_string(buffer, "\nPeak used blocks ");
+    procfs_write_number(buffer, stats.peak_used_blocks, 10);
+    procfs_write_string(buffer, "\nAllocations      ");
+    procfs_write_number(buffer, stats.allocations, 10);
+    procfs_write_string(buffer, "\nFrees            ");
+    procfs_write_number(buffer, stats.frees, 10);
+    procfs_write_string(buffer, "\nFailed           ");
+    procfs_write_number(buffer, stats.failed_allocations, 10);
+    procfs_write_string(buffer, "\n");
+
+    struct KheapCallerStats callers[BIMBLEOS_KHEAP_MAX_CALLERS];
+    int total = kheap_get_callers(callers, BIMBLEOS_KHEAP_MAX_CALLERS);
+    if (total == 0)
+    {
+        return;
+    }
+
+    procfs_write_string(buffer, "\nCaller       Allocations     Blocks       Peak\n");
+    for (int i = 0; i < total; i++)
+    {
+        procfs_write_hex(buffer, callers[i].caller);
+        procfs_write_number(buffer, callers[i].allocations, 14);
+        procfs_write_number(buffer, callers[i].blocks, 11);
+        procfs_write_number(buffer, callers[i].peak_blocks, 11);
+        procfs_write_string(buffer, "\n");
+    }
+}
+
+static void procfs_disks(struct ProcfsBuffer *buffer)
+{
+    static const char *types[] = {"ATA ", "PROC", "RAM "};
+    procfs_write_string(buffer, "Drive Type      Sectors LBA48 Filesystem Model\n");
+    for (int i = 0; i < BIMBLEOS_MAX_DISKS; i++)
+    {
+        struct Disk *disk = disk_get(i);
+        if (!disk)
+        {
+            continue;
+        }
+
+        procfs_write_number(buffer, disk->id, 5);
+        procfs_write_string(buffer, " ");
+        procfs_write_string(buffer, disk->type < sizeof(types) / sizeof(types[0]) ? types[disk->type] : "?   ");
+        procfs_write_number(buffer, disk->total_sectors, 13);
+
+        struct AtaDrive *drive = disk->type == BIMBLEOS_DISK_TYPE_REAL ? disk->driver_private : 0;
+        procfs_write_string(buffer, drive && drive->lba48 ? " yes   " : " no    ");
+
+        const char *filesystem = disk->filesystem ? disk->filesystem->name : "-";
+        procfs_write_string(buffer, filesystem);
+        for (int pad = strlen(filesystem); pad < 11; pad++)
+        {
+            procfs_write_string(buffer, " ");
+        }
+        procfs_write_string(buffer, drive ? drive->model : "");
+        procfs_write_string(buffer, "\n");
+    }
+}
+
+static void procfs_bcache(struct ProcfsBuffer *buffer)
+{
+    struct BufferCacheStats stats;
+    bcache_get_stats(&stats);
+
+    procfs_write_string(buffer, "Buffers        ");
+    procfs_write_number(buffer, BIMBLEOS_BCACHE_BUFFERS, 10);
+    procfs_write_string(buffer, "\nHits           ");
+    procfs_write_number(buffer, stats.hits, 10);
+    procfs_write_string(buffer, "\nMisses         ");
+    procfs_write_number(buffer, stats.misses, 10);
+    procfs_write_string(buffer, "\nEvictions      ");
+    procfs_write_number(buffer, stats.evictions, 10);
+    procfs_write_string(buffer, "\nDirty          ");
+    procfs_write_number(buffer, stats.dirty, 10);
+    procfs_write_string(buffer, "\nWritten back   ");
+    procfs_write_number(buffer, stats.write_backs, 10);
+    procfs_write_string(buffer, "\nWrite commands ");
+    procfs_write_number(buffer, stats.write_commands, 10);
+    procfs_write_string(buffer, "\nSyncs          ");
+    procfs_write_number(buffer, stats.syncs, 10);
+    procfs_write_string(buffer, "\n");
+}
+
+static void procfs_dcache(struct ProcfsBuffer *buffer)
+{
+    struct DentryCacheStats stats;
+    dcache_get_stats(&stats);
+    uint32_t lookups = stats.hits + stats.negative_hits + stats.misses;
+
+    procfs_write_string(buffer, "Entries        ");
+    procfs_write_number(buffer, BIMBLEOS_DCACHE_ENTRIES, 10);
+    procfs_write_string(buffer, "\nHits           ");
+    procfs_write_number(buffer, stats.hits, 10);
+    procfs_write_string(buffer, "\nNegative hits  ");
+    procfs_write_number(buffer, stats.negative_hits, 10);
+    procfs_write_string(buffer, "\nMisses         ");
+    procfs_write_number(buffer, stats.misses, 10);
+    procfs_write_string(buffer, "\nHit rate %     ");
+    procfs_write_number(buffer, lookups ? (stats.hits + stats.negative_hits) * 100 / lookups : 0, 10);
+    procfs_write_string(buffer, "\nEvictions      ");
+    procfs_write_number(buffer, stats.evictions, 10);
+    procfs_write_string(buffer, "\nInvalidations  ");
+    procfs_write_number(buffer, stats.invalidations, 10);
+    procfs_write_string(buffer, "\n");
+}
+
+/**
+ * @brief procfs only lives on the virtual proc disk
+ * 
+ * @param disk 
+ * @return int 
+ */
+int procfs_resolve(struct Disk *disk)
+{
+    return disk->type == BIMBLEOS_DISK_TYPE_PROC ? 0 : -EFSNOTUS;
+}
+
+static struct ProcfsFile *procfs_get_file(const char *name)
+{
+    for (int i = 0; i < sizeof(procfs_files) / sizeof(procfs_files[0]); i++)
+    {
+        if (strncmp(procfs_files[i].name, name, BIMBLEOS_MAX_PATH) == 0)
+        {
+            return &procfs_files[i];
+        }
+    }
+
+    return 0;
+}
+
+void *procfs_open(struct Disk *disk, struct PathPart *path, FILE_MODE mode)
+{
+    if (mode != FILE_MODE_READ)
+    {
+        return ERROR(-ERDONLY);
+    }
+
+    // The directory is flat
+    struct ProcfsFile *file = procfs_get_file(path->part);
+    if (!file || path->next)
+    {
+        return ERROR(-EIO);
+    }
+
+    struct ProcfsFileDescriptor *descriptor = kzalloc(sizeof(struct ProcfsFileDescriptor));
+    if (!descriptor)
+    {
+        return ERROR(-ENOMEM);
+    }
+
+    descriptor->buffer.data = kzalloc(BIMBLEOS_PROCFS_MAX_FILE_SIZE);
+    if (!descriptor->buffer.data)
+    {
+        kfree(descriptor);
+        return ERROR(-ENOMEM);
+    }
+
+    descriptor->buffer.size = BIMBLEOS_PROCFS_MAX_FILE_SIZE;
+    file->generate(&descriptor->buffer);
+    return descriptor;
+}
+
+/**
+ * @brief Copy whole items from the current position
+ * 
+ * @return int Number of items read, fewer than nmemb at the end of the file
+ */
+int procfs_read(struct Disk *disk, void *private, uint32_t size, uint32_t nmemb, char *out)
+{
+    struct ProcfsFileDescriptor *descriptor = private;
+    int res = 0;
+    for (uint32_t i = 0; i < nmemb; i++)
+    {
+        if (descriptor->buffer.length - descriptor->pos < size)
+        {
+            break;
+        }
+
+        memcpy(out, &descriptor->buffer.data[descriptor->pos], size);
+        descriptor->pos += size;
+        out += size;
+        res++;
+    }
+
+    return res;
+}
+
+int procfs_seek(void *private, uint32_t offset, FILE_SEEK_MODE seek_mode)
+{
+    struct ProcfsFileDescriptor *descriptor = private;
+    uint32_t pos = descriptor->pos;
+    switch (seek_mode)
+    {
+    case SEEK_SET:
+        pos = offset;
+        break;
+
+    case SEEK_CUR:
+        pos += offset;
+        break;
+
+    case SEEK_END:
+        pos = descriptor->buffer.length + offset;
+        break;
+
+    default:
+        return -EINVARG;
+    }
+
+    if (pos > descriptor->buffer.length)
+    {
+        return -EIO;
+    }
+
+    descriptor->pos = pos;
+    return 0;
+}
+
+int procfs_stat(struct Disk *disk, void *private, struct FileStat *stat)
+{
+    struct ProcfsFileDescriptor *descriptor = private;
+    stat->filesize = descriptor->buffer.length;
+    stat->flags = FILE_STAT_READ_ONLY;
+    return 0;
+}
+
+int procfs_close(void *private)
+{
+    struct ProcfsFileDescriptor *descriptor = private;
+    kfree(descriptor->buffer.data);
+    kfree(descriptor);
+    return 0;
+}
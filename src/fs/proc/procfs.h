@@ -0,0 +1,38 @@
+#ifndef PROCFS_H
+#define PROCFS_H
+
+#include "file.h"
+#include <stdint.h>
+
+// Text is generated when a file is opened, reads see that snapshot
+struct ProcfsBuffer
+{
+    char *data;
+    uint32_t length;
+    uint32_t size;
+};
+
+typedef void (*PROCFS_GENERATE_FUNCTION)(struct ProcfsBuffer *buffer);
+
+struct ProcfsFile
+{
+    const char *name;
+    PROCFS_GENERATE_FUNCTION generate;
+};
+
+struct ProcfsFileDescriptor
+{
+    struct ProcfsBuffer buffer;
+    uint32_t pos;
+};
+
+struct Filesystem *procfs_init();
+
+int procfs_resolve(struct Disk *disk);
+void *procfs_open(struct Disk *disk, struct PathPart *path, FILE_MODE mode);
+int procfs_read(struct Disk *disk, void *private, uint32_t size, uint32_t nmemb, char *out);
+int procfs_seek(void *private, uint32_t offset, FILE_SEEK_MODE seek_mode);
+int procfs_stat(struct Disk *disk, void *private, struct FileStat *stat);
+int procfs_close(void *private);
+
+#endif
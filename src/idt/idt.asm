@@ -11,6 +11,7 @@ global idt_load
 global enable_interrupts
 global disable_interrupts
 global isr80h_wrapper
+global isr80h_sysenter_wrapper
 global interrupt_pointer_table
 
 idt_load:
@@ -83,24 +84,60 @@ isr80h_wrapper:
     ; EAX holds our command lets push it to the stack for isr80h_handler
     push eax
     call isr80h_handler
-    mov dword[tmp_res], eax     ; We used "tmp_res" here to avoid accidental overwriting eax further
     add esp, 8
 
+    ; Store the result over the saved EAX so popad hands it to user land. A global would be
+    ; overwritten by syscalls running on other cpus
+    mov [esp+28], eax
+
     ; Restore general purpose registers for user land
     popad
-    mov eax, [tmp_res]
     iretd
 
 
+; SYSENTER lands here on the cpu's kernel stack with interrupts disabled. User land passes the
+; command in EAX, its stack pointer in ECX and the return address in EDX
+isr80h_sysenter_wrapper:
+    ; INTERRUPT FRAME START
+        ; Build what the processor pushes for INT 0x80, so the task state can be saved as usual
+        push dword 0x23         ; ss
+        push ecx                ; sp
+        pushfd                  ; flags, SYSENTER cleared IF
+        or dword [esp], 0x200
+        push dword 0x1B         ; cs
+        push edx                ; ip
+    ; Pushes EAX, ECX, EDX, EBX, original ESP, EBP, ESI, and EDI
+    pushad
 
+    ; INTERRUPT FRAME END
 
+    push esp
+    push eax
+    call isr80h_handler
+    add esp, 8
 
+    mov [esp+28], eax
+    popad
+
+    ; SYSEXIT returns to EDX with the stack in ECX
+    mov edx, [esp]
+    mov ecx, [esp+12]
+
+    ; Restore the user flags but keep interrupts off until the STI shadow covers SYSEXIT
+    and dword [esp+8], 0xFFFFFDFF
+    add esp, 8
+    popfd
+    add esp, 8
+    sti
+    sysexit
 
-section .data
-tmp_res: dd 0   ; Inside here is stored the return result from isr80h_handler
 
 
 
+
+
+section .data
+
 %macro interrupt_array_entry 1
     dd int%1
 %endmacro
@@ -6,6 +6,16 @@
 #include "io/io.h"
 #include "task/task.h"
 #include "task/process.h"
+#include "task/ioring.h"
+#include "task/vdso.h"
+#include "smp/smp.h"
+#include "apic/apic.h"
+#include "cpu/cpu.h"
+#include "isr80h/stats.h"
+#include "stats.h"
+#include "profiler/profiler.h"
+#include "trace/trace.h"
+#include "disk/bcache.h"
 
 
 struct idt_desc idt_descriptors[BIMBLEOS_TOTAL_INTERRUPTS];     // Memory space for IDT
@@ -21,22 +31,41 @@ static ISR80H_COMMAND isr80h_commands[BIMBLEOS_MAX_ISR80H_COMMANDS];
 
 
 extern void isr80h_wrapper();
+extern void isr80h_sysenter_wrapper();
 
  
 
 
 
+/**
+ * @brief Common entry of all interrupts. The kernel is mapped in every address space, so the
+ *        interrupted task's page directory stays loaded and only the segment registers change.
+ * 
+ * @param interrupt 
+ * @param frame 
+ */
 void interrupt_handler(int interrupt, struct InterruptFrame* frame)
 {
-    kernel_page();
+    kernel_registers();
+    idt_stats_enter(interrupt);
     if (interrupt_callbacks[interrupt] != 0)
     {
-        task_current_save_state(frame);
+        // An idle cpu was interrupted in kernel land, there is no task state to save
+        if (task_current())
+        {
+            task_current_save_state(frame);
+        }
         interrupt_callbacks[interrupt](frame);
     }
+    idt_stats_exit();
 
     task_page();
-    outb(0x20, 0x20);   // Acknowledge interrupt
+
+    // Acknowledge device interrupts, exceptions and spurious interrupts must not be acknowledged
+    if (interrupt >= BIMBLEOS_IRQ_BASE_INTERRUPT && interrupt != BIMBLEOS_SPURIOUS_INTERRUPT)
+    {
+        apic_eoi();
+    }
 }
 
 extern void* idt_load(struct idtr_desc * ptr);          // Implementation of this function is in assembly          
@@ -52,9 +81,28 @@ void divide_by_zero(){
 void idt_handle_exception()
 {
     print("Exception occured");
+    if (!task_current())
+    {
+        panic("Exception in kernel land\n");
+    }
+
     process_terminate(task_current()->process);
+    idt_stats_exit();
     task_next();
 }
+/**
+ * @brief Page faults end the faulting process like every other exception, the fault address
+ *        is traced first
+ * 
+ * @param frame 
+ */
+void idt_page_fault(struct InterruptFrame* frame)
+{
+    struct Task* task = task_current();
+    trace_page_fault(cpu_read_cr2(), frame->ip, task ? task->process->id : TRACE_IDLE_PID);
+    idt_handle_exception();
+}
+
 // Sets a handler for interrupt number
 void idt_set(int interrupt_no, void * address){
     struct idt_desc * desc =  &idt_descriptors[interrupt_no];
@@ -65,11 +113,27 @@ void idt_set(int interrupt_no, void * address){
     desc->type_attr = 0xEE;
     desc->offset_2 = (uint32_t)address >> 16;
 }
-void idt_clock()
+void idt_clock(struct InterruptFrame* frame)
 {
-    outb(0x20, 0x20);
+    apic_eoi();
+    profiler_sample(frame);
+
+    // Every cpu ticks, the clock follows the boot cpu only
+    if (cpu_current()->id == 0)
+    {
+        vdso_tick();
+        bcache_tick();
+    }
+
+    // Kernel side polling, whatever the task queued on its ring completes without a trap
+    struct Task* task = task_current();
+    if (task && task->process->io_ring)
+    {
+        io_ring_enter(task->process);
+    }
 
-    // Switch to the next task
+    // Switch to the next task, it does not come back here
+    idt_stats_exit();
     task_next();
 }
 
@@ -94,11 +158,37 @@ void idt_init()
         idt_register_interrupt_callback(i,idt_handle_exception);
     }
     
-    idt_register_interrupt_callback(0x20, idt_clock);
+    idt_register_interrupt_callback(BIMBLEOS_PAGE_FAULT_INTERRUPT, idt_page_fault);
+    idt_register_interrupt_callback(BIMBLEOS_TIMER_INTERRUPT, idt_clock);
     
     idt_load(&idtr_descriptor);                             // Load interrupt descriptor table
 }
 
+// Load the already built IDT on the calling cpu
+void idt_load_current()
+{
+    idt_load(&idtr_descriptor);
+}
+
+/**
+ * @brief Point SYSENTER of the calling cpu at isr80h_sysenter_wrapper, a fast path into the same
+ *        command table as INT 0x80. SYSEXIT derives the user selectors from the kernel code
+ *        selector, which matches the GDT layout. Without SEP support only INT 0x80 works.
+ * 
+ * @param kernel_stack_top The cpu's kernel stack, the one in its TSS
+ */
+void idt_sysenter_init(uint32_t kernel_stack_top)
+{
+    if (!cpu_supports_features(CPUID_FEATURE_EDX_SEP))
+    {
+        return;
+    }
+
+    cpu_write_msr(CPU_MSR_SYSENTER_CS, KERNAL_CODE_SELECTOR, 0);
+    cpu_write_msr(CPU_MSR_SYSENTER_ESP, kernel_stack_top, 0);
+    cpu_write_msr(CPU_MSR_SYSENTER_EIP, (uint32_t)isr80h_sysenter_wrapper, 0);
+}
+
 
 
 int idt_register_interrupt_callback(int interrupt, INTERRUPT_CALLBACK_FUNCTION interrupt_callback)
@@ -127,6 +217,28 @@ void isr80h_register_command(int command_id, ISR80H_COMMAND command)
     isr80h_commands[command_id] = command;
 }
 
+/**
+ * @brief System call arguments arrive in EBX, ESI and EDI, in that order
+ * 
+ * @param frame 
+ * @param index 0 to 2
+ * @return uint32_t 
+ */
+uint32_t isr80h_argument(struct InterruptFrame* frame, int index)
+{
+    switch (index)
+    {
+        case 0:
+            return frame->ebx;
+        case 1:
+            return frame->esi;
+        case 2:
+            return frame->edi;
+    }
+
+    return 0;
+}
+
 
 /**
  * @brief Invoke appropriate handle function for INT80H and return a pointer to result.
@@ -156,10 +268,11 @@ void* isr80h_handle_command(int command, struct InterruptFrame* frame)
 }
 
 /**
- * @brief 1) Switches to kernel page directory 
+ * @brief 1) Loads kernel segment registers, the task's page directory stays loaded
  *        2) Saves current running task.
- *        3) Gets the interrupt result ( by calling "isr80h_handle_command" )
- *        4) Switches to current task's page directory
+ *        3) Gets the interrupt result ( by calling "isr80h_handle_command" ), timing it with
+ *           the time stamp counter for the system call statistics
+ *        4) Returns to the current task's segments and page directory
  *        5) Returns pointer to interrupt result
  * 
  * @param command 
@@ -169,9 +282,15 @@ void* isr80h_handle_command(int command, struct InterruptFrame* frame)
 void* isr80h_handler(int command, struct InterruptFrame* frame)
 {
     void* res = 0;
-    kernel_page();
+    kernel_registers();
     task_current_save_state(frame);
+    isr80h_stats_enter(command);
+    uint16_t pid = task_current()->process->id;
+    trace_syscall_enter(pid, command);
+    uint64_t start = cpu_rdtsc();
     res = isr80h_handle_command(command, frame);
+    isr80h_stats_exit(command, (uint32_t)(cpu_rdtsc() - start));
+    trace_syscall_exit(pid, command, res);
     task_page();
     return res;
 } 
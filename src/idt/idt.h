@@ -41,9 +41,12 @@ typedef void(*INTERRUPT_CALLBACK_FUNCTION)();
 
 
 void idt_init();
+void idt_load_current();
+void idt_sysenter_init(uint32_t kernel_stack_top);
 void enable_interrupts();
 void disable_interrupts();
 void isr80h_register_command(int  , ISR80H_COMMAND  );
+uint32_t isr80h_argument(struct InterruptFrame* frame, int index);
 int idt_register_interrupt_callback(int interrupt, INTERRUPT_CALLBACK_FUNCTION interrupt_callback);
 
 #endif
\ No newline at end of file
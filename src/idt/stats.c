@@ -0,0 +1,100 @@
+#include "stats.h"
+#include "config.h"
+#include "smp/smp.h"
+#include "cpu/cpu.h"
+#include "apic/apic.h"
+#include "stats/histogram.h"
+#include "memory/heap/kheap.h"
+#include "status.h"
+
+struct InterruptStats
+{
+    uint32_t count;
+    uint32_t max_latency;
+
+    // Cycles from entering interrupt_handler to leaving the callback
+    struct Histogram handler_cycles;
+};
+
+// BIMBLEOS_TOTAL_INTERRUPTS entries, allocated by idt_stats_init
+static struct InterruptStats *idt_stats = 0;
+
+/**
+ * @brief Allocate the table from the kernel heap, before any interrupt is enabled
+ * 
+ * @return int 
+ */
+int idt_stats_init()
+{
+    idt_stats = kzalloc(sizeof(struct InterruptStats) * BIMBLEOS_TOTAL_INTERRUPTS);
+    return idt_stats ? 0 : -ENOMEM;
+}
+
+/**
+ * @brief Count the interrupt and start timing it on the calling cpu. Kernel code runs with
+ *        interrupts disabled, so a cpu services one interrupt at a time.
+ * 
+ * @param interrupt 
+ */
+void idt_stats_enter(int interrupt)
+{
+    struct InterruptStats *stats = &idt_stats[interrupt];
+    __atomic_add_fetch(&stats->count, 1, __ATOMIC_RELAXED);
+
+    // Only the local APIC timer tells when it was raised
+    if (interrupt == BIMBLEOS_TIMER_INTERRUPT)
+    {
+        uint32_t latency = apic_timer_latency();
+        uint32_t max = __atomic_load_n(&stats->max_latency, __ATOMIC_RELAXED);
+        while (latency > max && !__atomic_compare_exchange_n(&stats->max_latency, &max, latency, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+        }
+    }
+
+    struct Cpu *cpu = cpu_current();
+    cpu->interrupt = interrupt;
+    cpu->interrupt_timed = true;
+    cpu->interrupt_start = cpu_rdtsc();
+}
+
+/**
+ * @brief Stop timing the interrupt of the calling cpu. Handlers that switch tasks call this
+ *        before task_next, later calls do nothing.
+ * 
+ */
+void idt_stats_exit()
+{
+    struct Cpu *cpu = cpu_current();
+    if (!cpu->interrupt_timed)
+    {
+        return;
+    }
+
+    cpu->interrupt_timed = false;
+    histogram_add(&idt_stats[cpu->interrupt].handler_cycles, (uint32_t)(cpu_rdtsc() - cpu->interrupt_start));
+}
+
+/**
+ * @brief Snapshot of the statistics of one interrupt
+ * 
+ * @param interrupt 
+ * @param entry 
+ * @return true The interrupt was raised at least once
+ */
+bool idt_stats_get(int interrupt, struct InterruptStatsEntry *entry)
+{
+    struct InterruptStats *stats = &idt_stats[interrupt];
+    if (!stats->count)
+    {
+        return false;
+    }
+
+    spinlock_acquire(&stats->handler_cycles.lock);
+    entry->interrupt = interrupt;
+    entry->count = stats->count;
+    entry->mean_cycles = histogram_mean(&stats->handler_cycles);
+    entry->max_cycles = stats->handler_cycles.max;
+    entry->max_latency_cycles = stats->max_latency;
+    spinlock_release(&stats->handler_cycles.lock);
+    return true;
+}
@@ -0,0 +1,22 @@
+#ifndef IDT_STATS_H
+#define IDT_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// One row of the interrupt table handed to user land, must match the stdlib definition
+struct InterruptStatsEntry
+{
+    uint32_t interrupt;
+    uint32_t count;
+    uint32_t mean_cycles;           // Time in the handler
+    uint32_t max_cycles;
+    uint32_t max_latency_cycles;    // From the interrupt being raised to the handler, timer only
+};
+
+int idt_stats_init();
+void idt_stats_enter(int interrupt);
+void idt_stats_exit();
+bool idt_stats_get(int interrupt, struct InterruptStatsEntry *entry);
+
+#endif
@@ -0,0 +1,244 @@
+#include "file.h"
+#include "config.h"
+#include "status.h"
+#include "kernel.h"
+#include "idt/idt.h"
+#include "fs/file.h"
+#include "task/task.h"
+#include "task/process.h"
+#include "memory/heap/kheap.h"
+#include "disk/disk.h"
+#include "disk/ata.h"
+#include "cpu/cpu.h"
+
+/**
+ * @brief Open a file, e.g. 0:/blank.elf or 9:/interrupts
+ * 
+ * @param frame path, mode string
+ * @return void* The file descriptor, negative on failure
+ */
+void* isr80h_command16_fopen(struct InterruptFrame* frame)
+{
+    char filename[BIMBLEOS_MAX_PATH];
+    char mode[2];
+    struct Task* task = task_current();
+    if (strncpy_from_user(task, filename, (const char*)isr80h_argument(frame, 0), sizeof(filename)) < 0 ||
+        strncpy_from_user(task, mode, (const char*)isr80h_argument(frame, 1), sizeof(mode)) < 0)
+    {
+        return ERROR(-EINVARG);
+    }
+
+    return (void*)process_fopen(task->process, filename, mode);
+}
+
+/**
+ * @brief Read exactly 'size' bytes from the current position through a kernel buffer
+ * 
+ * @param frame file descriptor, buffer, size
+ * @return void* 'size', 0 once the file has fewer bytes left, negative on failure
+ */
+void* isr80h_command17_fread(struct InterruptFrame* frame)
+{
+    int fd = (int)isr80h_argument(frame, 0);
+    void* buffer = (void*)isr80h_argument(frame, 1);
+    uint32_t size = isr80h_argument(frame, 2);
+    struct Task* task = task_current();
+    int res = 0;
+
+    if (!process_owns_file(task->process, fd) || size == 0 || size > BIMBLEOS_MAX_USER_FILE_READ)
+    {
+        return ERROR(-EINVARG);
+    }
+
+    void* kernel_buffer = kzalloc(size);
+    if (!kernel_buffer)
+    {
+        return ERROR(-ENOMEM);
+    }
+
+    res = fread(kernel_buffer, size, 1, fd);
+    if (res <= 0)
+    {
+        goto out;
+    }
+
+    res = copy_to_user(task, buffer, kernel_buffer, size);
+    if (res < 0)
+    {
+        goto out;
+    }
+    res = size;
+
+out:
+    kfree(kernel_buffer);
+    return (void*)res;
+}
+
+void* isr80h_command18_fclose(struct InterruptFrame* frame)
+{
+    int fd = (int)isr80h_argument(frame, 0);
+    return (void*)process_fclose(task_current()->process, fd);
+}
+
+void* isr80h_command19_fstat(struct InterruptFrame* frame)
+{
+    int fd = (int)isr80h_argument(frame, 0);
+    void* user_stat = (void*)isr80h_argument(frame, 1);
+    struct Task* task = task_current();
+    if (!process_owns_file(task->process, fd))
+    {
+        return ERROR(-EINVARG);
+    }
+
+    struct FileStat stat;
+    int res = fstat(fd, &stat);
+    if (res < 0)
+    {
+        return (void*)res;
+    }
+
+    return (void*)copy_to_user(task, user_stat, &stat, sizeof(stat));
+}
+
+/**
+ * @brief Read sectors straight from a disk, below any filesystem, and time it. Sectors go to a
+ *        kernel buffer and are dropped, interrupts stay off until the reads are done
+ * 
+ * @param frame drive number, struct DiskBench with lba, sectors and total_sectors
+ * @return void* 0, negative on failure
+ */
+void* isr80h_command23_disk_bench(struct InterruptFrame* frame)
+{
+    struct Disk* disk = disk_get((int)isr80h_argument(frame, 0));
+    void* user_bench = (void*)isr80h_argument(frame, 1);
+    struct Task* task = task_current();
+    struct DiskBench bench;
+    void* buffer = 0;
+    int res = 0;
+
+    if (!disk || copy_from_user(task, &bench, user_bench, sizeof(bench)) < 0)
+    {
+        return ERROR(-EINVARG);
+    }
+
+    bench.disk_sectors = disk->total_sectors;
+    bench.cycles_low = 0;
+    bench.cycles_high = 0;
+    bench.commands = 0;
+    if (bench.total_sectors == 0)
+    {
+        goto out;
+    }
+
+    if (bench.sectors == 0 || bench.sectors > BIMBLEOS_DISK_BENCH_MAX_SECTORS)
+    {
+        return ERROR(-EINVARG);
+    }
+
+    buffer = kmalloc(bench.sectors * disk->sector_size);
+    if (!buffer)
+    {
+        return ERROR(-ENOMEM);
+    }
+
+    struct AtaDrive* drive = disk->type == BIMBLEOS_DISK_TYPE_REAL ? disk->driver_private : 0;
+    uint32_t commands = drive ? drive->read_commands : 0;
+    uint64_t start = cpu_rdtsc();
+    for (uint32_t done = 0; done < bench.total_sectors; done += bench.sectors)
+    {
+        uint32_t count = bench.total_sectors - done < bench.sectors ? bench.total_sectors - done : bench.sectors;
+        res = disk_read_block(disk, bench.lba + done, count, buffer);
+        if (res < 0)
+        {
+            goto out;
+        }
+    }
+    uint64_t cycles = cpu_rdtsc() - start;
+
+    bench.cycles_low = (uint32_t)cycles;
+    bench.cycles_high = (uint32_t)(cycles >> 32);
+    bench.commands = drive ? drive->read_commands - commands : 0;
+
+out:
+    if (buffer)
+    {
+        kfree(buffer);
+    }
+
+    if (res < 0)
+    {
+        return (void*)res;
+    }
+    return (void*)copy_to_user(task, user_bench, &bench, sizeof(bench));
+}
+
+/**
+ * @brief Write filesystem metadata and every cached sector back and flush the drive caches
+ * 
+ * @param frame 
+ * @return void* 0, negative on failure
+ */
+void* isr80h_command24_sync(struct InterruptFrame* frame)
+{
+    return (void*)fs_sync();
+}
+
+/**
+ * @brief Write 'size' bytes at the current position through a kernel buffer
+ * 
+ * @param frame file descriptor, buffer, size
+ * @return void* 'size', negative on failure
+ */
+void* isr80h_command25_fwrite(struct InterruptFrame* frame)
+{
+    int fd = (int)isr80h_argument(frame, 0);
+    const void* buffer = (const void*)isr80h_argument(frame, 1);
+    uint32_t size = isr80h_argument(frame, 2);
+    struct Task* task = task_current();
+    int res = 0;
+
+    if (!process_owns_file(task->process, fd) || size == 0 || size > BIMBLEOS_MAX_USER_FILE_WRITE)
+    {
+        return ERROR(-EINVARG);
+    }
+
+    void* kernel_buffer = kmalloc(size);
+    if (!kernel_buffer)
+    {
+        return ERROR(-ENOMEM);
+    }
+
+    res = copy_from_user(task, kernel_buffer, buffer, size);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    res = fwrite(kernel_buffer, size, 1, fd);
+    if (res < 0)
+    {
+        goto out;
+    }
+    res = size;
+
+out:
+    kfree(kernel_buffer);
+    return (void*)res;
+}
+
+/**
+ * @brief Delete a file, e.g. 0:/log.txt
+ * 
+ * @param frame path
+ * @return void* 0, negative on failure
+ */
+void* isr80h_command26_unlink(struct InterruptFrame* frame)
+{
+    char filename[BIMBLEOS_MAX_PATH];
+    if (strncpy_from_user(task_current(), filename, (const char*)isr80h_argument(frame, 0), sizeof(filename)) < 0)
+    {
+        return ERROR(-EINVARG);
+    }
+
+    return (void*)funlink(filename);
+}
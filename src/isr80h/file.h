@@ -0,0 +1,14 @@
+#ifndef ISR80H_FILE_H
+#define ISR80H_FILE_H
+
+struct InterruptFrame;
+void* isr80h_command16_fopen(struct InterruptFrame* frame);
+void* isr80h_command17_fread(struct InterruptFrame* frame);
+void* isr80h_command18_fclose(struct InterruptFrame* frame);
+void* isr80h_command19_fstat(struct InterruptFrame* frame);
+void* isr80h_command23_disk_bench(struct InterruptFrame* frame);
+void* isr80h_command24_sync(struct InterruptFrame* frame);
+void* isr80h_command25_fwrite(struct InterruptFrame* frame);
+void* isr80h_command26_unlink(struct InterruptFrame* frame);
+
+#endif
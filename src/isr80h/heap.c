@@ -1,18 +1,66 @@
 #include "heap.h"
 #include "task/task.h"
 #include "task/process.h"
+#include "idt/idt.h"
+#include "kernel.h"
+#include "status.h"
+#include "config.h"
+#include "memory/heap/heap.h"
+#include "memory/heap/kheap.h"
 #include <stddef.h>
 
 void* isr80h_command4_malloc(struct InterruptFrame* frame)
 {
-    size_t size = (int)task_get_stack_item(task_current(), 0);
+    size_t size = isr80h_argument(frame, 0);
     return process_malloc(task_current()->process, size);
 }
 
 
 void* isr80h_command5_free(struct InterruptFrame* frame)
 {
-    void* ptr_to_free = task_get_stack_item(task_current(), 0);
-    process_free(task_current()->process, ptr_to_free);
+    void* ptr_to_free = (void*)isr80h_argument(frame, 0);
+    struct Process* process = task_current()->process;
+
+    // The kernel keeps using the ring until the process ends
+    if (ptr_to_free == process->io_ring)
+    {
+        return 0;
+    }
+
+    process_free(process, ptr_to_free);
     return 0;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Copy the kernel heap counters and the call sites holding the most blocks
+ * 
+ * @param frame struct HeapStats, buffer of struct KheapCallerStats, maximum number of rows
+ * @return void* Number of call site rows copied
+ */
+void* isr80h_command22_kheap_stats(struct InterruptFrame* frame)
+{
+    struct HeapStats *stats = (struct HeapStats *)isr80h_argument(frame, 0);
+    struct KheapCallerStats *buffer = (struct KheapCallerStats *)isr80h_argument(frame, 1);
+    int max = (int)isr80h_argument(frame, 2);
+    struct KheapCallerStats callers[BIMBLEOS_KHEAP_MAX_CALLERS];
+    struct HeapStats heap;
+
+    kheap_get_stats(&heap);
+    if (copy_to_user(task_current(), stats, &heap, sizeof(heap)) < 0)
+    {
+        return ERROR(-EINVARG);
+    }
+
+    if (max > BIMBLEOS_KHEAP_MAX_CALLERS)
+    {
+        max = BIMBLEOS_KHEAP_MAX_CALLERS;
+    }
+
+    int total = kheap_get_callers(callers, max);
+    if (total > 0 && copy_to_user(task_current(), buffer, callers, total * sizeof(callers[0])) < 0)
+    {
+        return ERROR(-EINVARG);
+    }
+
+    return (void*)total;
+}
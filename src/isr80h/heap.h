@@ -5,5 +5,6 @@
 struct InterruptFrame;
 void* isr80h_command4_malloc(struct InterruptFrame* frame);
 void* isr80h_command5_free(struct InterruptFrame* frame);
+void* isr80h_command22_kheap_stats(struct InterruptFrame* frame);
 
 #endif
\ No newline at end of file
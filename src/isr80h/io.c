@@ -1,12 +1,19 @@
 #include "io.h"
 #include "task/task.h"
+#include "task/process.h"
+#include "task/ioring.h"
 #include "kernel.h"
 #include "keyboard/keyboard.h"
+#include "idt/idt.h"
+#include "status.h"
 void* isr80h_command1_print(struct InterruptFrame* frame)
 {
-    void* user_space_msg_buffer = task_get_stack_item(task_current(), 0);
+    void* user_space_msg_buffer = (void*)isr80h_argument(frame, 0);
     char buf[1024];
-    copy_string_from_task(task_current(), user_space_msg_buffer, buf, sizeof(buf));
+    if (strncpy_from_user(task_current(), buf, user_space_msg_buffer, sizeof(buf)) < 0)
+    {
+        return ERROR(-EINVARG);
+    }
 
     print(buf);
     return 0;
@@ -22,7 +29,31 @@ void* isr80h_command2_getkey(struct InterruptFrame* frame)
 
 void* isr80h_command3_putchar(struct InterruptFrame* frame)
 {
-    char c = (char)(int) task_get_stack_item(task_current(), 0);
+    char c = (char)isr80h_argument(frame, 0);
     terminal_writechar(c, 15);
     return 0;
-}
\ No newline at end of file
+}
+
+void* isr80h_command11_ioring_setup(struct InterruptFrame* frame)
+{
+    return io_ring_setup(task_current()->process);
+}
+
+void* isr80h_command12_ioring_enter(struct InterruptFrame* frame)
+{
+    return (void*)io_ring_enter(task_current()->process);
+}
+
+/**
+ * @brief Print a buffer of known length, the stdlib flushes stdout with it. Longer buffers
+ *        than BIMBLEOS_MAX_USER_FILE_WRITE are written in part
+ * 
+ * @param frame 
+ * @return void* Number of characters written
+ */
+void* isr80h_command13_write(struct InterruptFrame* frame)
+{
+    const char* buffer = (const char*)isr80h_argument(frame, 0);
+    uint32_t length = isr80h_argument(frame, 1);
+    return (void*)terminal_print_from_user(task_current(), buffer, length);
+}
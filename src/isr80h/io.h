@@ -6,4 +6,7 @@ struct InterruptFrame;
 void* isr80h_command1_print(struct InterruptFrame* frame);
 void* isr80h_command2_getkey(struct InterruptFrame* frame);
 void* isr80h_command3_putchar(struct InterruptFrame* frame);
+void* isr80h_command11_ioring_setup(struct InterruptFrame* frame);
+void* isr80h_command12_ioring_enter(struct InterruptFrame* frame);
+void* isr80h_command13_write(struct InterruptFrame* frame);
 #endif
\ No newline at end of file
@@ -4,6 +4,10 @@
 #include "heap.h"
 #include "process.h"
 #include "misc.h"
+#include "stats.h"
+#include "profiler.h"
+#include "trace.h"
+#include "file.h"
 
 void isr80h_register_commands(){
     isr80h_register_command(SYSTEM_COMMAND0_SUM, isr80h_command0_sum);
@@ -16,5 +20,22 @@ void isr80h_register_commands(){
     isr80h_register_command(SYSTEM_COMMAND7_INVOKE_SYSTEM_COMMAND, isr80h_command7_invoke_system_command);
     isr80h_register_command(SYSTEM_COMMAND8_GET_PROGRAM_ARGUMENTS, isr80h_command8_get_program_arguments);
     isr80h_register_command(SYSTEM_COMMAND9_EXIT, isr80h_command9_exit);
+    isr80h_register_command(SYSTEM_COMMAND10_YIELD, isr80h_command10_yield);
+    isr80h_register_command(SYSTEM_COMMAND11_IORING_SETUP, isr80h_command11_ioring_setup);
+    isr80h_register_command(SYSTEM_COMMAND12_IORING_ENTER, isr80h_command12_ioring_enter);
+    isr80h_register_command(SYSTEM_COMMAND13_WRITE, isr80h_command13_write);
+    isr80h_register_command(SYSTEM_COMMAND14_SYSCALL_STATS, isr80h_command14_syscall_stats);
+    isr80h_register_command(SYSTEM_COMMAND15_INTERRUPT_STATS, isr80h_command15_interrupt_stats);
+    isr80h_register_command(SYSTEM_COMMAND16_FOPEN, isr80h_command16_fopen);
+    isr80h_register_command(SYSTEM_COMMAND17_FREAD, isr80h_command17_fread);
+    isr80h_register_command(SYSTEM_COMMAND18_FCLOSE, isr80h_command18_fclose);
+    isr80h_register_command(SYSTEM_COMMAND19_FSTAT, isr80h_command19_fstat);
+    isr80h_register_command(SYSTEM_COMMAND20_PROFILER, isr80h_command20_profiler);
+    isr80h_register_command(SYSTEM_COMMAND21_TRACE, isr80h_command21_trace);
+    isr80h_register_command(SYSTEM_COMMAND22_KHEAP_STATS, isr80h_command22_kheap_stats);
+    isr80h_register_command(SYSTEM_COMMAND23_DISK_BENCH, isr80h_command23_disk_bench);
+    isr80h_register_command(SYSTEM_COMMAND24_SYNC, isr80h_command24_sync);
+    isr80h_register_command(SYSTEM_COMMAND25_FWRITE, isr80h_command25_fwrite);
+    isr80h_register_command(SYSTEM_COMMAND26_UNLINK, isr80h_command26_unlink);
     
 }
\ No newline at end of file
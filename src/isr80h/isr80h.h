@@ -13,7 +13,24 @@ enum SystemCommands
     SYSTEM_COMMAND6_PROCESS_LOAD_START,
     SYSTEM_COMMAND7_INVOKE_SYSTEM_COMMAND,
     SYSTEM_COMMAND8_GET_PROGRAM_ARGUMENTS,
-    SYSTEM_COMMAND9_EXIT
+    SYSTEM_COMMAND9_EXIT,
+    SYSTEM_COMMAND10_YIELD,
+    SYSTEM_COMMAND11_IORING_SETUP,
+    SYSTEM_COMMAND12_IORING_ENTER,
+    SYSTEM_COMMAND13_WRITE,
+    SYSTEM_COMMAND14_SYSCALL_STATS,
+    SYSTEM_COMMAND15_INTERRUPT_STATS,
+    SYSTEM_COMMAND16_FOPEN,
+    SYSTEM_COMMAND17_FREAD,
+    SYSTEM_COMMAND18_FCLOSE,
+    SYSTEM_COMMAND19_FSTAT,
+    SYSTEM_COMMAND20_PROFILER,
+    SYSTEM_COMMAND21_TRACE,
+    SYSTEM_COMMAND22_KHEAP_STATS,
+    SYSTEM_COMMAND23_DISK_BENCH,
+    SYSTEM_COMMAND24_SYNC,
+    SYSTEM_COMMAND25_FWRITE,
+    SYSTEM_COMMAND26_UNLINK
 };
 
 void isr80h_register_commands();
@@ -1,11 +1,12 @@
 #include "misc.h"
 #include "kernel.h"
 #include "task/task.h"
+#include "idt/idt.h"
 
 void* isr80h_command0_sum(struct InterruptFrame* frame)
 {
-    int v1 = (int)task_get_stack_item(task_current(),0);
-    int v2 = (int)task_get_stack_item(task_current(),1);
+    int v1 = (int)isr80h_argument(frame, 0);
+    int v2 = (int)isr80h_argument(frame, 1);
      
     return (void*)v1 + v2;
 }
\ No newline at end of file
@@ -6,13 +6,15 @@
 #include "status.h"
 #include "config.h"
 #include "kernel.h"
+#include "idt/idt.h"
+#include "memory/heap/kheap.h"
 
 
 void* isr80h_command6_process_load_start(struct InterruptFrame* frame)
 {
-    void* filename_user_ptr = task_get_stack_item(task_current(), 0);
+    void* filename_user_ptr = (void*)isr80h_argument(frame, 0);
     char filename[BIMBLEOS_MAX_PATH];
-    int res = copy_string_from_task(task_current(), filename_user_ptr, filename, sizeof(filename));
+    int res = strncpy_from_user(task_current(), filename, filename_user_ptr, sizeof(filename));
     if (res < 0)
     {
         goto out;
@@ -29,53 +31,117 @@ void* isr80h_command6_process_load_start(struct InterruptFrame* frame)
         goto out;
     }
 
-    task_switch(process->task);             
-    task_return(&process->task->registers); // We now switched to task's IP. therefore  we will never execute further in this function
+    task_yield_to(process->task);           // We now switched to task's IP. therefore  we will never execute further in this function
 
 out:
     return 0;   // This line will never be executed
 }
 
+static void isr80h_free_command_arguments(struct CommandArgument* argument)
+{
+    while (argument)
+    {
+        struct CommandArgument* next = argument->next;
+        kfree(argument);
+        argument = next;
+    }
+}
+
+/**
+ * @brief Copy the user land list of command arguments into the kernel, so nothing user land
+ *        changes or unmaps afterwards can affect us
+ * 
+ * @param task 
+ * @param user_argument 
+ * @return struct CommandArgument* 0 if the list is not accessible to the task
+ */
+static struct CommandArgument* isr80h_copy_command_arguments(struct Task* task, struct CommandArgument* user_argument)
+{
+    struct CommandArgument* root = 0;
+    struct CommandArgument* last = 0;
+    for (int i = 0; user_argument && i < BIMBLEOS_MAX_COMMAND_ARGUMENTS; i++)
+    {
+        struct CommandArgument* argument = kzalloc(sizeof(struct CommandArgument));
+        if (!argument)
+        {
+            goto out_err;
+        }
+
+        if (copy_from_user(task, argument, user_argument, sizeof(struct CommandArgument)) < 0)
+        {
+            kfree(argument);
+            goto out_err;
+        }
+
+        argument->argument[sizeof(argument->argument) - 1] = 0;
+        user_argument = argument->next;
+        argument->next = 0;
+
+        if (last)
+        {
+            last->next = argument;
+        }
+        else
+        {
+            root = argument;
+        }
+        last = argument;
+    }
+
+    return root;
+
+out_err:
+    isr80h_free_command_arguments(root);
+    return 0;
+}
+
 void* isr80h_command7_invoke_system_command(struct InterruptFrame* frame)
 {
-    struct CommandArgument* arguments = task_virtual_address_to_physical(task_current(), task_get_stack_item(task_current(), 0));
-    if (!arguments || strlen(arguments[0].argument) == 0)
+    struct CommandArgument* root_command_argument = isr80h_copy_command_arguments(task_current(), (struct CommandArgument*)isr80h_argument(frame, 0));
+    if (!root_command_argument || strlen(root_command_argument->argument) == 0)
     {
+        isr80h_free_command_arguments(root_command_argument);
         return ERROR(-EINVARG);
     }
 
-    struct CommandArgument* root_command_argument = &arguments[0];
     const char* program_name = root_command_argument->argument;
 
     char path[BIMBLEOS_MAX_PATH];
     strcpy(path, "0:/");
-    strncpy(path+3, program_name, sizeof(path));
+    strncpy(path+3, program_name, sizeof(path) - 3);
     
     struct Process* process = 0;
     int res = process_load_switch(path, &process);
     if (res < 0)
     {
-        return ERROR(res);
+        goto out;
     }
     
     res = process_inject_arguments(process, root_command_argument);
     if (res < 0)
     {
-        return ERROR(res);
+        goto out;
     }
 
-    task_switch(process->task);
-    task_return(&process->task->registers);
+    isr80h_free_command_arguments(root_command_argument);
+    task_yield_to(process->task);
 
-    return 0;
+out:
+    isr80h_free_command_arguments(root_command_argument);
+    return ERROR(res);
 }
 
 void* isr80h_command8_get_program_arguments(struct InterruptFrame* frame)
 {
     struct Process* process = task_current()->process;
-    struct ProcessArguments* arguments = task_virtual_address_to_physical(task_current(), task_get_stack_item(task_current(), 0));
+    struct ProcessArguments arguments;
+
+    process_get_arguments(process, &arguments.argc, &arguments.argv);
+    if (copy_to_user(task_current(), (void*)isr80h_argument(frame, 0), &arguments, sizeof(arguments)) < 0)
+    {
+        return ERROR(-EINVARG);
+    }
 
-    process_get_arguments(process, &arguments->argc, &arguments->argv);
     return 0;
 }
 
@@ -85,4 +151,16 @@ void* isr80h_command9_exit(struct InterruptFrame* frame)
     process_terminate(process);
     task_next();
     return 0;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Give up the rest of the time slice, the caller stays ready
+ * 
+ * @param frame 
+ * @return void* 
+ */
+void* isr80h_command10_yield(struct InterruptFrame* frame)
+{
+    task_next();
+    return 0;
+}
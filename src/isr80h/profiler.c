@@ -0,0 +1,34 @@
+#include "profiler.h"
+#include "idt/idt.h"
+#include "status.h"
+#include "profiler/profiler.h"
+
+/**
+ * @brief Start or stop the sampling profiler, or dump its samples to COM1
+ * 
+ * @param frame PROFILER_START, PROFILER_STOP or PROFILER_DUMP
+ * @return void* 
+ */
+void* isr80h_command20_profiler(struct InterruptFrame* frame)
+{
+    int res = 0;
+    switch (isr80h_argument(frame, 0))
+    {
+    case PROFILER_START:
+        res = profiler_start();
+        break;
+
+    case PROFILER_STOP:
+        profiler_stop();
+        break;
+
+    case PROFILER_DUMP:
+        res = profiler_dump();
+        break;
+
+    default:
+        res = -EINVARG;
+    }
+
+    return (void*)res;
+}
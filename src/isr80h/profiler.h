@@ -0,0 +1,7 @@
+#ifndef ISR80H_PROFILER_H
+#define ISR80H_PROFILER_H
+
+struct InterruptFrame;
+void* isr80h_command20_profiler(struct InterruptFrame* frame);
+
+#endif
@@ -0,0 +1,131 @@
+#include "stats.h"
+#include "config.h"
+#include "kernel.h"
+#include "status.h"
+#include "idt/idt.h"
+#include "task/task.h"
+#include "task/process.h"
+#include "task/vdso.h"
+#include "stats/histogram.h"
+#include "idt/stats.h"
+
+// Cycles spent in each command, from kernel entry to the return to user land
+static struct Histogram isr80h_stats[BIMBLEOS_MAX_TRACKED_ISR80H_COMMANDS];
+
+// Calls counted at entry, yield, exit and process_load_start may never come back
+static uint32_t isr80h_calls[BIMBLEOS_MAX_TRACKED_ISR80H_COMMANDS];
+
+/**
+ * @brief Count a system call against its command and the calling process
+ * 
+ * @param command 
+ */
+void isr80h_stats_enter(int command)
+{
+    struct Task *task = task_current();
+    if (task && task->process)
+    {
+        vdso_process_syscall(task->process);
+    }
+
+    if (command < 0 || command >= BIMBLEOS_MAX_TRACKED_ISR80H_COMMANDS)
+    {
+        return;
+    }
+
+    __atomic_add_fetch(&isr80h_calls[command], 1, __ATOMIC_RELAXED);
+}
+
+void isr80h_stats_exit(int command, uint32_t cycles)
+{
+    if (command < 0 || command >= BIMBLEOS_MAX_TRACKED_ISR80H_COMMANDS)
+    {
+        return;
+    }
+
+    histogram_add(&isr80h_stats[command], cycles);
+}
+
+/**
+ * @brief Snapshot of the statistics of one command
+ * 
+ * @param command 
+ * @param entry 
+ * @return true The command was called at least once
+ */
+bool isr80h_stats_get(int command, struct SyscallStatsEntry *entry)
+{
+    if (command < 0 || command >= BIMBLEOS_MAX_TRACKED_ISR80H_COMMANDS || !isr80h_calls[command])
+    {
+        return false;
+    }
+
+    struct Histogram *histogram = &isr80h_stats[command];
+    spinlock_acquire(&histogram->lock);
+    entry->command = command;
+    entry->count = isr80h_calls[command];
+    entry->mean_cycles = histogram_mean(histogram);
+    entry->p99_cycles = histogram_percentile(histogram, 99);
+    spinlock_release(&histogram->lock);
+    return true;
+}
+
+/**
+ * @brief Copy a row for every command that was called at least once
+ * 
+ * @param frame buffer of struct SyscallStatsEntry, maximum number of rows
+ * @return void* Number of rows copied
+ */
+void* isr80h_command14_syscall_stats(struct InterruptFrame* frame)
+{
+    struct SyscallStatsEntry *buffer = (struct SyscallStatsEntry *)isr80h_argument(frame, 0);
+    int max = (int)isr80h_argument(frame, 1);
+    int total = 0;
+
+    for (int i = 0; i < BIMBLEOS_MAX_TRACKED_ISR80H_COMMANDS && total < max; i++)
+    {
+        struct SyscallStatsEntry entry;
+        if (!isr80h_stats_get(i, &entry))
+        {
+            continue;
+        }
+
+        if (copy_to_user(task_current(), &buffer[total], &entry, sizeof(entry)) < 0)
+        {
+            return ERROR(-EINVARG);
+        }
+        total++;
+    }
+
+    return (void*)total;
+}
+
+/**
+ * @brief Copy a row for every interrupt vector that was raised at least once
+ * 
+ * @param frame buffer of struct InterruptStatsEntry, maximum number of rows
+ * @return void* Number of rows copied
+ */
+void* isr80h_command15_interrupt_stats(struct InterruptFrame* frame)
+{
+    struct InterruptStatsEntry *buffer = (struct InterruptStatsEntry *)isr80h_argument(frame, 0);
+    int max = (int)isr80h_argument(frame, 1);
+    int total = 0;
+
+    for (int i = 0; i < BIMBLEOS_TOTAL_INTERRUPTS && total < max; i++)
+    {
+        struct InterruptStatsEntry entry;
+        if (!idt_stats_get(i, &entry))
+        {
+            continue;
+        }
+
+        if (copy_to_user(task_current(), &buffer[total], &entry, sizeof(entry)) < 0)
+        {
+            return ERROR(-EINVARG);
+        }
+        total++;
+    }
+
+    return (void*)total;
+}
@@ -0,0 +1,24 @@
+#ifndef ISR80H_STATS_H
+#define ISR80H_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// One row of the system call table handed to user land, must match the stdlib definition
+struct SyscallStatsEntry
+{
+    uint32_t command;
+    uint32_t count;
+    uint32_t mean_cycles;
+    uint32_t p99_cycles;
+};
+
+struct InterruptFrame;
+
+void isr80h_stats_enter(int command);
+void isr80h_stats_exit(int command, uint32_t cycles);
+bool isr80h_stats_get(int command, struct SyscallStatsEntry *entry);
+void* isr80h_command14_syscall_stats(struct InterruptFrame* frame);
+void* isr80h_command15_interrupt_stats(struct InterruptFrame* frame);
+
+#endif
@@ -0,0 +1,34 @@
+#include "trace.h"
+#include "idt/idt.h"
+#include "status.h"
+#include "trace/trace.h"
+
+/**
+ * @brief Start tracing the given events, stop, or dump the trace to COM1
+ * 
+ * @param frame TRACE_START, TRACE_STOP or TRACE_DUMP, bit per event id for TRACE_START
+ * @return void* 
+ */
+void* isr80h_command21_trace(struct InterruptFrame* frame)
+{
+    int res = 0;
+    switch (isr80h_argument(frame, 0))
+    {
+    case TRACE_START:
+        res = trace_start(isr80h_argument(frame, 1));
+        break;
+
+    case TRACE_STOP:
+        trace_stop();
+        break;
+
+    case TRACE_DUMP:
+        res = trace_dump();
+        break;
+
+    default:
+        res = -EINVARG;
+    }
+
+    return (void*)res;
+}
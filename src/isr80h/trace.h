@@ -0,0 +1,7 @@
+#ifndef ISR80H_TRACE_H
+#define ISR80H_TRACE_H
+
+struct InterruptFrame;
+void* isr80h_command21_trace(struct InterruptFrame* frame);
+
+#endif
@@ -5,6 +5,8 @@ global _start
 global kernel_registers
  
 extern kernel_main
+extern kernel_bss_start
+extern kernel_bss_end
 
 CODE_SEG equ 0x8
 DATA_SEG equ 0x10
@@ -36,6 +38,14 @@ _start:
         mov al, 00000001b   ; Put PIC in x86 mode
         out 0x21, al
 
+    ;Zero .bss, it is not part of kernel.bin so the boot sector did not load it
+        mov edi, kernel_bss_start
+        mov ecx, kernel_bss_end
+        sub ecx, edi
+        xor eax, eax
+        cld
+        rep stosb
+
     call kernel_main
     jmp $
  
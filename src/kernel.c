@@ -1,13 +1,16 @@
 #include "kernel.h"
 #include "idt/idt.h"
+#include "idt/stats.h"
 #include "io/io.h"
 #include "memory/heap/kheap.h"
 #include "memory/paging/paging.h"
 #include "disk/disk.h"
 #include "disk/streamer.h"
+#include "disk/bcache.h"
 #include "string/string.h"
 #include "fs/pparser.h"
 #include "fs/file.h"
+#include "fs/dcache.h"
 #include "gdt/gdt.h"
 #include "keyboard/keyboard.h"
 #include "config.h"
@@ -15,6 +18,12 @@
 #include "task/tss.h"
 #include "task/process.h"
 #include "isr80h/isr80h.h"
+#include "smp/smp.h"
+#include "smp/spinlock.h"
+#include "cpu/cpu.h"
+#include "cpu/fpu.h"
+#include "task/vdso.h"
+#include "serial/serial.h"
 #include <stdint.h>
 #include <stddef.h>
 
@@ -22,7 +31,6 @@
 
 static struct PageDirectory_4GB *kernelPageDirectory = 0;
 struct Gdt gdt_real[BIMBLEOS_TOTAL_GDT_SEGMENT];
-struct Tss tss;
 
 
 struct GdtStructured gdt_structured[BIMBLEOS_TOTAL_GDT_SEGMENT]  = {
@@ -31,13 +39,18 @@ struct GdtStructured gdt_structured[BIMBLEOS_TOTAL_GDT_SEGMENT]  = {
     {.base = 0x00, .limit = 0xFFFFFFFF, .type = 0x92},              // Kernel Mode Data Segment 
     {.base = 0x00, .limit = 0xFFFFFFFF, .type = 0xFA},              // User Mode Code Segment 
     {.base = 0x00, .limit = 0xFFFFFFFF, .type = 0xF2},              // User Mode Data Segment 
-    {.base = (uint32_t)&tss, .limit = sizeof(tss), .type = 0x89},   // Task State Segment 
+                                                                    // Task State Segments of every cpu are filled in kernel_main
 };
 
 uint16_t *video_mem = 0;
 int terminal_row = 0;
 int terminal_column = 0;
 
+// Serializes output of all cpus
+static struct Spinlock terminal_lock = SPINLOCK_INIT;
+
+static void terminal_write(char character, char color);
+
 
 
 // Return character and color in little endian that can be placed in video memory
@@ -61,7 +74,7 @@ void terminal_backspace()
     }
 
     terminal_column -=1;
-    terminal_writechar(' ', 15);
+    terminal_write(' ', 15);
     terminal_column -=1;
 }
 
@@ -81,12 +94,12 @@ void terminal_putchar(int x, int y, char character, char color)
 
 
 /**
- * @brief Prints a character on screen
+ * @brief Prints a character on screen. Caller must hold terminal_lock
  * 
  * @param character 
  * @param color 
  */
-void terminal_writechar(char character, char color)
+static void terminal_write(char character, char color)
 {
     if (character == '\n')
     {
@@ -113,17 +126,85 @@ void terminal_writechar(char character, char color)
 
 
 /**
- * @brief Print a string on screen
+ * @brief Prints a character on screen and COM1
+ * 
+ * @param character 
+ * @param color 
+ */
+void terminal_writechar(char character, char color)
+{
+    serial_log(&character, 1);
+    spinlock_acquire(&terminal_lock);
+    terminal_write(character, color);
+    spinlock_release(&terminal_lock);
+}
+
+
+/**
+ * @brief Print 'length' characters on screen under a single lock acquisition, mirrored to COM1
  * 
  * @param str 
+ * @param length 
  */
-void print(const char *str)
+void terminal_print(const char *str, int length)
+{
+    serial_log(str, length);
+    spinlock_acquire(&terminal_lock);
+    for (int i = 0; i < length; i++)
+    {
+        terminal_write(str[i], 15);
+    }
+    spinlock_release(&terminal_lock);
+}
+
+/**
+ * @brief Print 'length' characters from user land of 'task', copied in chunks through a
+ *        stack buffer. Callers run with interrupts disabled, so at most
+ *        BIMBLEOS_MAX_USER_FILE_WRITE characters are printed per call
+ * 
+ * @param task 
+ * @param user 
+ * @param length 
+ * @return int Number of characters printed
+ */
+int terminal_print_from_user(struct Task *task, const char *user, uint32_t length)
 {
+    char buf[256];
+    uint32_t written = 0;
+    if (length > BIMBLEOS_MAX_USER_FILE_WRITE)
+    {
+        length = BIMBLEOS_MAX_USER_FILE_WRITE;
+    }
 
-    for (int i = 0; i < strlen(str); i++)
+    while (written < length)
     {
-        terminal_writechar(str[i], 15);
+        uint32_t chunk = length - written;
+        if (chunk > sizeof(buf))
+        {
+            chunk = sizeof(buf);
+        }
+
+        int res = copy_from_user(task, buf, user + written, chunk);
+        if (res < 0)
+        {
+            return res;
+        }
+
+        terminal_print(buf, chunk);
+        written += chunk;
     }
+
+    return written;
+}
+
+/**
+ * @brief Print a string on screen
+ * 
+ * @param str 
+ */
+void print(const char *str)
+{
+    terminal_print(str, strlen(str));
 }
 
 
@@ -176,28 +257,57 @@ void kernel_main()
     // Initialize Video memeory
     terminal_initialize();
 
-    // Setup GDT
+    // COM1 mirrors the screen and carries profiles and traces to the host
+    serial_init();
+
+    // Setup GDT, one Task State Segment per cpu
+    for (int i = 0; i < BIMBLEOS_MAX_CPUS; i++)
+    {
+        gdt_structured[BIMBLEOS_GDT_TSS_INDEX + i].base = (uint32_t)&cpu_get(i)->tss;
+        gdt_structured[BIMBLEOS_GDT_TSS_INDEX + i].limit = sizeof(struct Tss);
+        gdt_structured[BIMBLEOS_GDT_TSS_INDEX + i].type = 0x89;
+    }
     memset(gdt_real,0x00, sizeof(gdt_real));
     gdt_structured_to_gdt(gdt_real,gdt_structured,BIMBLEOS_TOTAL_GDT_SEGMENT);
     gdt_load(gdt_real,sizeof(gdt_real));  
     
     
     kheap_init();
+    if (vdso_init() < 0)
+    {
+        panic("Failed to allocate the vdso page\n");
+    }
+    if (bcache_init() < 0)
+    {
+        panic("Failed to allocate the buffer cache\n");
+    }
+    if (dcache_init() < 0)
+    {
+        panic("Failed to allocate the directory entry cache\n");
+    }
     fs_init();
     disk_search_and_init();
+    if (idt_stats_init() < 0)
+    {
+        panic("Failed to allocate the interrupt statistics\n");
+    }
     idt_init();
+    fpu_init();
 
-    // Setup Task State Segment
-    memset(&tss,0x00, sizeof(tss));
-    tss.esp0 = 0x600000;                // Processor will set the kernel stack to this address when switching from user land to kernel land
-    tss.ss0 = KERNAL_DATA_SELECTOR;
-    tss_load(0x28);                     // 0x28 is offset of TSS in GDT
+    // Setup Task State Segment of the boot cpu
+    cpu_load_tss(cpu_get(0), BIMBLEOS_BSP_KERNEL_STACK_ADDRESS);
+    idt_sysenter_init(BIMBLEOS_BSP_KERNEL_STACK_ADDRESS);
 
 
     // Setup kernel page directory
-    kernelPageDirectory = paging_new(PAGING_IS_WRITEABLE | PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL);
+    kernelPageDirectory = paging_new(PAGING_IS_WRITEABLE | PAGING_IS_PRESENT);
     paging_switch(kernelPageDirectory);
     enable_paging();
+    cpu_enable_global_pages();
+
+    // Bring up the application processors
+    smp_init(kernelPageDirectory);
+    serial_enable_interrupts();
 
     // Register 
     isr80h_register_commands();
@@ -205,27 +315,13 @@ void kernel_main()
     // Initialize all keyboard
     keyboard_init();
 
-    // Load first process
-        struct Process * process = 0;
-        int res = process_load_switch("0:/blank.elf",&process);
-        
-        struct CommandArgument argument;
-        
-        strcpy(argument.argument, "P1");
-        argument.next = 0x00; 
-        process_inject_arguments(process, &argument);
-    
-    // Load second process
-        res = process_load_switch("0:/blank.elf",&process);
-        
-        strcpy(argument.argument, "P2");
-        argument.next = 0x00; 
-        process_inject_arguments(process, &argument);
-
-
+    // Load the shell as the first process, tools/bench.py drives it over COM1
+    struct Process* process = 0;
+    int res = process_load_switch("0:/shell.elf", &process);
     if(res != BIMBLEOS_ALL_OK){
         panic("Failed to load process");
     }
+    task_ready(process->task);
 
     
     task_run_first_ever_task(); 
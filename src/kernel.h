@@ -1,12 +1,14 @@
 #ifndef KERNEL_H
 #define KERNEL_H
 
+#include <stdint.h>
+
 #define VGA_WIDTH 80
 #define VGA_HEIGHT 25
 
 #define ERROR(value) (void *)(value)
 #define ERROR_I(value) (int)(value)
-#define ISERR(value) ((int)value < 0)
+#define ISERR(value) ((long)(value) < 0)       // long is pointer sized on the kernel and the hosted tests
 
 
 
@@ -14,6 +16,10 @@
 
 void print(const char *);
 void terminal_writechar(char character, char color);
+void terminal_print(const char *str, int length);
+
+struct Task;
+int terminal_print_from_user(struct Task *task, const char *user, uint32_t length);
 void kernel_main();
 void panic(const char *);
 
@@ -67,9 +67,6 @@ uint8_t classic_keyboard_scancode_to_char(uint8_t scancode)
 
 void classic_keyboard_handle_interrupt()
 {
-    
-
-    kernel_page();
     uint8_t scancode = 0;
     scancode = insb(KEYBOARD_INPUT_PORT);   // Reads input
     insb(KEYBOARD_INPUT_PORT);              // Ignore rogue byte
@@ -90,9 +87,6 @@ void classic_keyboard_handle_interrupt()
     {
         keyboard_push(c);
     }
-
-    task_page();
-
 }
 
 struct Keyboard* classic_instance()
@@ -9,10 +9,14 @@
 #include "task/process.h"
 #include "task/task.h"
 #include "classic.h"
+#include "smp/spinlock.h"
 
 static  struct Keyboard* keyboard_list_head = 0;
 static  struct Keyboard* keyboard_list_last = 0;
 
+// Keys are pushed by the cpu taking the keyboard IRQ and popped by whichever cpu runs the reader
+static struct Spinlock keyboard_lock = SPINLOCK_INIT;
+
 void keyboard_init()
 {
     keyboard_insert(classic_instance());
@@ -79,9 +83,11 @@ void keyboard_push(char c)
         return;
     }
 
+    spinlock_acquire(&keyboard_lock);
     int real_index = keyboard_get_tail_index(process);
     process->keyboard.buffer[real_index] = c;
     process->keyboard.tail++;
+    spinlock_release(&keyboard_lock);
 }
 
 char keyboard_pop()
@@ -92,15 +98,18 @@ char keyboard_pop()
     }
 
     struct Process* process = task_current()->process;
+    spinlock_acquire(&keyboard_lock);
     int real_index = process->keyboard.head % sizeof(process->keyboard.buffer);
     char c = process->keyboard.buffer[real_index];
     if (c == 0x00)
     {
         // Nothing to pop return zero.
+        spinlock_release(&keyboard_lock);
         return 0;
     }
 
     process->keyboard.buffer[real_index] = 0;
     process->keyboard.head++;
+    spinlock_release(&keyboard_lock);
     return c;
 }
\ No newline at end of file
@@ -33,7 +33,7 @@ out:
 
 static bool heap_validate_alignment(void *ptr)
 {
-    return ((unsigned int)ptr % BIMBLEOS_HEAP_BLOCK_SIZE) == 0;
+    return ((uintptr_t)ptr % BIMBLEOS_HEAP_BLOCK_SIZE) == 0;
 }
 
 /**
@@ -179,7 +179,8 @@ int heap_get_start_block(struct heap *heap, uint32_t total_blocks)
 
     }
     
-    if(blockStart == -1){
+    // A free run at the end of the table may be shorter than asked for
+    if(blockStart == -1 || blockCount != total_blocks){
         return -ENOMEM;
     }
 
@@ -200,6 +201,7 @@ void *heap_malloc_blocks(struct heap *heap, uint32_t total_blocks)
     int start_block = heap_get_start_block(heap,total_blocks);
 
     if(start_block < 0){
+        heap->failed_allocations++;
         goto out;
     }
 
@@ -207,6 +209,12 @@ void *heap_malloc_blocks(struct heap *heap, uint32_t total_blocks)
 
     
     heap_mark_blocks_taken(heap,start_block,total_blocks);
+    heap->allocations++;
+    heap->used_blocks += total_blocks;
+    if (heap->used_blocks > heap->peak_used_blocks)
+    {
+        heap->peak_used_blocks = heap->used_blocks;
+    }
     out:
     return address;
 }
@@ -221,6 +229,11 @@ void *heap_malloc_blocks(struct heap *heap, uint32_t total_blocks)
 void* heap_malloc(struct heap *heap, size_t total_size)
 {
 
+    if (total_size == 0)
+    {
+        return 0;
+    }
+
     size_t aligned_size = heap_align_value_to_upper(total_size);
     uint32_t total_blocks = aligned_size / BIMBLEOS_HEAP_BLOCK_SIZE;
     return heap_malloc_blocks(heap, total_blocks);
@@ -236,20 +249,87 @@ int heap_address_to_block(struct heap* heap, void* address)
 
 
 
-void heap_mark_blocks_free(struct heap* heap, int starting_block)
+/**
+ * @brief Mark the blocks of the allocation starting at 'starting_block' free
+ *
+ * @param heap
+ * @param starting_block
+ * @return int Number of blocks freed
+ */
+int heap_mark_blocks_free(struct heap* heap, int starting_block)
 {
     struct heap_table* table = heap->table;
+    int total = 0;
     for (size_t i = starting_block; i <  table->total_entries; i++)
     {
         HEAP_BLOCK_TABLE_ENTRY entry = table->entries[i];
         table->entries[i] = HEAP_BLOCK_TABLE_ENTRY_FREE;
+        if (heap_get_entry_type(entry) == HEAP_BLOCK_TABLE_ENTRY_TAKEN)
+        {
+            total++;
+        }
         if (!(entry & HEAP_BLOCK_HAS_NEXT))
         {
             break;
         }
     }
+
+    return total;
 }
-void heap_free(struct heap *heap, void *ptr)
+
+/**
+ * @brief Free the allocation at 'ptr'
+ *
+ * @param heap
+ * @param ptr
+ * @return int Number of blocks freed
+ */
+int heap_free(struct heap *heap, void *ptr)
 {
-    heap_mark_blocks_free(heap, heap_address_to_block(heap, ptr));
+    int total = heap_mark_blocks_free(heap, heap_address_to_block(heap, ptr));
+    if (total > 0)
+    {
+        heap->frees++;
+        heap->used_blocks -= total;
+    }
+
+    return total;
+}
+
+//================================== Heap statistics =========================================
+
+/**
+ * @brief Fill 'stats' from the counters and a scan of the heap table for free space
+ *
+ * @param heap
+ * @param stats
+ */
+void heap_get_stats(struct heap *heap, struct HeapStats *stats)
+{
+    struct heap_table* table = heap->table;
+    uint32_t run = 0;
+
+    memset(stats, 0, sizeof(struct HeapStats));
+    for (size_t i = 0; i < table->total_entries; i++)
+    {
+        if (heap_get_entry_type(table->entries[i]) != HEAP_BLOCK_TABLE_ENTRY_FREE)
+        {
+            run = 0;
+            continue;
+        }
+
+        stats->free_blocks++;
+        run++;
+        if (run > stats->largest_free_run)
+        {
+            stats->largest_free_run = run;
+        }
+    }
+
+    stats->total_blocks = table->total_entries;
+    stats->used_blocks = heap->used_blocks;
+    stats->peak_used_blocks = heap->peak_used_blocks;
+    stats->allocations = heap->allocations;
+    stats->frees = heap->frees;
+    stats->failed_allocations = heap->failed_allocations;
 }
\ No newline at end of file
@@ -23,11 +23,34 @@ struct heap
 {
     struct heap_table * table;  // Heap table
     void* saddr;                // Start address for heap memory
+
+    // Counters kept up to date by heap_malloc and heap_free
+    size_t used_blocks;
+    size_t peak_used_blocks;    // High-water mark of used_blocks
+    uint32_t allocations;
+    uint32_t frees;
+    uint32_t failed_allocations;
+};
+
+// Snapshot of a heap, must match the stdlib definition
+struct HeapStats
+{
+    uint32_t total_blocks;
+    uint32_t used_blocks;
+    uint32_t free_blocks;
+    uint32_t largest_free_run;  // Largest allocation in blocks that can still succeed
+    uint32_t peak_used_blocks;
+    uint32_t allocations;
+    uint32_t frees;
+    uint32_t failed_allocations;
 };
 
 int heap_create(struct heap*  , void*  , void*  , struct heap_table*  );
 void* heap_malloc(struct heap*  , size_t  );
-void heap_free(struct heap *heap, void *ptr);
+int heap_free(struct heap *heap, void *ptr);
+int heap_address_to_block(struct heap* heap, void* address);
+void *heap_block_to_address(struct heap *heap, int block);
+void heap_get_stats(struct heap *heap, struct HeapStats *stats);
 
 #define HEAP_H
 #endif
\ No newline at end of file
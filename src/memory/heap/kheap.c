@@ -2,10 +2,98 @@
 #include "kheap.h"
 #include "heap.h"
 #include "config.h"
+#include "smp/spinlock.h"
+#include "trace/trace.h"
  
 struct heap kernel_heap;
 struct heap_table kernel_heap_table;
 
+// The heap table is shared by all cpus
+static struct Spinlock kheap_lock = SPINLOCK_INIT;
+
+#if BIMBLEOS_KHEAP_CALLER_STATS
+// Both live on the heap itself, allocated by kheap_init. Nothing is accounted without them
+// Slot 0 collects the call sites that did not fit in the table
+static struct KheapCallerStats* kheap_callers = 0;
+static int kheap_total_callers = 1;
+
+// Caller slot of the allocation starting at each block, one per heap table entry
+static uint8_t* kheap_block_callers = 0;
+
+/**
+ * @brief Allocate the caller tables, the heap must exist
+ * 
+ */
+static void kheap_callers_init(){
+    size_t callers_size = sizeof(struct KheapCallerStats) * BIMBLEOS_KHEAP_MAX_CALLERS;
+    size_t blocks_size = kernel_heap_table.total_entries;
+    kheap_callers = heap_malloc(&kernel_heap, callers_size);
+    kheap_block_callers = heap_malloc(&kernel_heap, blocks_size);
+    if (!kheap_callers || !kheap_block_callers)
+    {
+        print("Kernel heap caller accounting is off\n");
+        kheap_callers = 0;
+        kheap_block_callers = 0;
+        return;
+    }
+
+    memset(kheap_callers, 0, callers_size);
+    memset(kheap_block_callers, 0, blocks_size);
+}
+
+/**
+ * @brief Find or add the slot of 'caller', must hold kheap_lock
+ * 
+ * @param caller 
+ * @return int 
+ */
+static int kheap_caller_slot(void* caller){
+    for (int i = 1; i < kheap_total_callers; i++)
+    {
+        if (kheap_callers[i].caller == (uint32_t)caller)
+        {
+            return i;
+        }
+    }
+
+    if (kheap_total_callers == BIMBLEOS_KHEAP_MAX_CALLERS)
+    {
+        return 0;
+    }
+
+    kheap_callers[kheap_total_callers].caller = (uint32_t)caller;
+    return kheap_total_callers++;
+}
+
+static void kheap_account_alloc(void* ptr, size_t size, void* caller){
+    if (!kheap_callers)
+    {
+        return;
+    }
+
+    int slot = kheap_caller_slot(caller);
+    struct KheapCallerStats* stats = &kheap_callers[slot];
+    uint32_t blocks = (size + BIMBLEOS_HEAP_BLOCK_SIZE - 1) / BIMBLEOS_HEAP_BLOCK_SIZE;
+
+    kheap_block_callers[heap_address_to_block(&kernel_heap, ptr)] = slot;
+    stats->allocations++;
+    stats->blocks += blocks;
+    if (stats->blocks > stats->peak_blocks)
+    {
+        stats->peak_blocks = stats->blocks;
+    }
+}
+
+static void kheap_account_free(void* ptr, int blocks){
+    if (!kheap_callers)
+    {
+        return;
+    }
+
+    kheap_callers[kheap_block_callers[heap_address_to_block(&kernel_heap, ptr)]].blocks -= blocks;
+}
+#endif
+
 
 /**
  * @brief Inilializes heap_table : 
@@ -25,16 +113,39 @@ void kheap_init(){
     
     if(res_status < 0){
         print("Failed to create heap\n");
+        return;
     }
 
+#if BIMBLEOS_KHEAP_CALLER_STATS
+    kheap_callers_init();
+#endif
+}
+
+/**
+ * @brief Allocate on behalf of 'caller', the code that called kmalloc or kzalloc
+ * 
+ * @param size 
+ * @param caller 
+ * @return void* 
+ */
+static void* kheap_malloc(size_t size, void* caller){
+    spinlock_acquire(&kheap_lock);
+    void* ptr = heap_malloc(&kernel_heap,size);
+#if BIMBLEOS_KHEAP_CALLER_STATS
+    if(ptr)
+        kheap_account_alloc(ptr, size, caller);
+#endif
+    spinlock_release(&kheap_lock);
+    trace_kheap_alloc(ptr, size, caller);
+    return ptr;
 }
 
 void* kmalloc(size_t size){
-    return heap_malloc(&kernel_heap,size);
+    return kheap_malloc(size, __builtin_return_address(0));
 }
 
 void* kzalloc(size_t size){
-    void* ptr = kmalloc(size);
+    void* ptr = kheap_malloc(size, __builtin_return_address(0));
 
     if(!ptr)
         return 0;
@@ -44,5 +155,64 @@ void* kzalloc(size_t size){
     
 }
 void kfree(void* ptr){
-    heap_free(&kernel_heap,ptr);
+    trace_kheap_free(ptr, __builtin_return_address(0));
+    spinlock_acquire(&kheap_lock);
+    int blocks = heap_free(&kernel_heap,ptr);
+#if BIMBLEOS_KHEAP_CALLER_STATS
+    if(blocks > 0)
+        kheap_account_free(ptr, blocks);
+#else
+    (void)blocks;
+#endif
+    spinlock_release(&kheap_lock);
+}
+
+/**
+ * @brief Snapshot of the kernel heap counters, free blocks and fragmentation
+ * 
+ * @param stats 
+ */
+void kheap_get_stats(struct HeapStats *stats){
+    spinlock_acquire(&kheap_lock);
+    heap_get_stats(&kernel_heap, stats);
+    spinlock_release(&kheap_lock);
+}
+
+/**
+ * @brief Copy the call sites holding the most blocks, largest first
+ * 
+ * @param callers 
+ * @param max 
+ * @return int Number of call sites copied, 0 when caller accounting is compiled out
+ */
+int kheap_get_callers(struct KheapCallerStats *callers, int max){
+    int total = 0;
+#if BIMBLEOS_KHEAP_CALLER_STATS
+    spinlock_acquire(&kheap_lock);
+    for (int i = 0; kheap_callers && i < kheap_total_callers; i++)
+    {
+        struct KheapCallerStats* stats = &kheap_callers[i];
+        if (!stats->allocations)
+        {
+            continue;
+        }
+
+        // Insertion sort on blocks held, the table is small
+        int loc = total < max ? total++ : max;
+        while (loc > 0 && callers[loc - 1].blocks < stats->blocks)
+        {
+            if (loc < max)
+            {
+                callers[loc] = callers[loc - 1];
+            }
+            loc--;
+        }
+        if (loc < max)
+        {
+            callers[loc] = *stats;
+        }
+    }
+    spinlock_release(&kheap_lock);
+#endif
+    return total;
 }
\ No newline at end of file
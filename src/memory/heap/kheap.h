@@ -2,12 +2,25 @@
 #define KHEAP_H
  
 #include<stddef.h>
+#include<stdint.h>
 #include "memory/memory.h"
 
+struct HeapStats;
+
+// Kernel heap usage of one call site, must match the stdlib definition
+struct KheapCallerStats
+{
+    uint32_t caller;            // Return address of the kmalloc or kzalloc call, 0 for untracked sites
+    uint32_t allocations;
+    uint32_t blocks;            // Blocks currently held
+    uint32_t peak_blocks;
+};
 
 void kheap_init();
 void* kmalloc(size_t );
 void* kzalloc(size_t );
 void kfree(void*  );
+void kheap_get_stats(struct HeapStats *stats);
+int kheap_get_callers(struct KheapCallerStats *callers, int max);
 
 #endif
\ No newline at end of file
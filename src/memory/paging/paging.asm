@@ -4,6 +4,7 @@ section .asm
 
 global paging_load_directory
 global enable_paging
+global paging_invalidate
 
 paging_load_directory:
     push ebp
@@ -13,6 +14,12 @@ paging_load_directory:
     pop ebp
     ret
 
+; void paging_invalidate(void* virt)
+paging_invalidate:
+    mov eax, [esp+4]
+    invlpg [eax]
+    ret
+
 enable_paging:
     push ebp
     mov ebp, esp
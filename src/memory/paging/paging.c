@@ -1,14 +1,14 @@
 #include "paging.h"
 #include "memory/heap/kheap.h"
 #include "status.h"
+#include "config.h"
+#include "smp/smp.h"
 
 
 
-static uint32_t *current_directory = 0;
-
-
 /**
- * @brief Create a linear page directory
+ * @brief Create a linear page directory. Supervisor only pages below BIMBLEOS_GLOBAL_PAGES_END
+ *        are marked global, they must look the same in every directory.
  * 
  * @param flags 
  * @return struct PageDirectory_4GB* 
@@ -16,18 +16,25 @@ static uint32_t *current_directory = 0;
 struct PageDirectory_4GB* paging_new(uint8_t flags){
 
     uint32_t * directory = kzalloc(sizeof(uint32_t)* PAGING_TOTAL_ENTRIES_PER_TABLE);
-    int offset = 0;
+    uint32_t offset = 0;
+    uint32_t global = (flags & PAGING_ACCESS_FROM_ALL) ? 0 : PAGING_IS_GLOBAL;
     
     for (size_t i = 0; i < PAGING_TOTAL_ENTRIES_PER_TABLE; i++){
         uint32_t *entry = kzalloc(sizeof(uint32_t) * PAGING_TOTAL_ENTRIES_PER_TABLE);
 
         for (size_t j = 0; j < PAGING_TOTAL_ENTRIES_PER_TABLE; j++)
         {
-            entry[j] =  offset + ((j * PAGING_PAGE_SIZE) | flags) ;
-            
+            uint32_t address = offset + (j * PAGING_PAGE_SIZE);
+            entry[j] = address | flags;
+            if (address < BIMBLEOS_GLOBAL_PAGES_END)
+            {
+                entry[j] |= global;
+            }
         }
         offset+=PAGING_PAGE_SIZE * PAGING_TOTAL_ENTRIES_PER_TABLE;
-        directory[i] = (uint32_t)entry | flags | PAGING_IS_WRITEABLE;
+
+        // Access rights are decided by the page table entries, user pages can be mapped anywhere later
+        directory[i] = (uint32_t)entry | flags | PAGING_IS_WRITEABLE | PAGING_ACCESS_FROM_ALL;
     }
 
     struct PageDirectory_4GB * pageDirectory = kzalloc(sizeof(struct PageDirectory_4GB));
@@ -42,14 +49,31 @@ uint32_t *paging_get_directory(struct PageDirectory_4GB *pageDirectory)
 }
 
 /**
- * @brief Switch to new page directory
+ * @brief Switch the calling cpu to a new page directory. Reloading CR3 flushes the TLB, so
+ *        nothing is done when the directory is already loaded.
  * 
  * @param directory 
  */
 void paging_switch(struct PageDirectory_4GB *directory)
 {
+    struct Cpu *cpu = cpu_current();
+    if (cpu->page_directory == directory)
+    {
+        return;
+    }
+
     paging_load_directory(directory->directoryEntry);
-    current_directory = directory->directoryEntry;
+    cpu->page_directory = directory;
+}
+
+/**
+ * @brief Page directory loaded on the calling cpu
+ * 
+ * @return struct PageDirectory_4GB* 
+ */
+struct PageDirectory_4GB *paging_current()
+{
+    return cpu_current()->page_directory;
 }
 
 bool paging_is_aligned(void* addr){
@@ -122,6 +146,9 @@ int paging_set(uint32_t* directory, void* virt_addr, uint32_t val){
     uint32_t *table = (uint32_t *)(entry & 0xfffff000);
     table[table_index] = val;
 
+    // The directory may be the loaded one, drop whatever translation the TLB still holds
+    paging_invalidate(virt_addr);
+
     return 0;
 }
 
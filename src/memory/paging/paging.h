@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#define PAGING_IS_GLOBAL 0b100000000       // If set, the TLB entry survives CR3 reloads once CR4.PGE is enabled
 #define PAGING_CACHE_DISABLED 0b00010000  // If set, disables page caching
 #define PAGING_WRITE_THROUGH 0b00001000   // If set, write through caching enabled, else write back caching enabled
 #define PAGING_ACCESS_FROM_ALL 0b00000100 // If set, page accesible through all ring level, else only accessible to supervisor ring
@@ -22,6 +23,7 @@ struct PageDirectory_4GB
 struct PageDirectory_4GB *paging_new(uint8_t flags);
 uint32_t *paging_get_directory(struct PageDirectory_4GB *pageDirectory);
 void paging_switch(struct PageDirectory_4GB *directory);
+struct PageDirectory_4GB *paging_current();
 bool paging_is_aligned(void *addr);
 void paging_free(struct PageDirectory_4GB *chunk);
 int paging_get_indexes(void *virt_addr, uint32_t *directory_index_out, uint32_t *table_index_out);
@@ -32,6 +34,7 @@ int paging_map(struct PageDirectory_4GB *directory, void *virt, void *phys, int
 int paging_map_to(struct PageDirectory_4GB *directory, void *virt, void *phys, void *phys_end, int flags);
 uint32_t paging_get(uint32_t *directory, void *virt);
 void paging_load_directory(uint32_t * directory);
+void paging_invalidate(void *virt);
 void* paging_align_to_lower_page(void* addr);
 void* paging_get_physical_address(uint32_t* directory, void* virt);
 
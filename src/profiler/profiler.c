@@ -0,0 +1,150 @@
+#include "profiler.h"
+#include "status.h"
+#include "idt/idt.h"
+#include "smp/smp.h"
+#include "task/task.h"
+#include "task/process.h"
+#include "serial/serial.h"
+#include "string/string.h"
+#include "memory/memory.h"
+#include "memory/heap/kheap.h"
+
+// One ring per cpu, allocated when profiling starts for the first time
+static struct ProfilerRing *profiler_rings = 0;
+static volatile bool profiler_is_running = false;
+
+/**
+ * @brief Clear the rings and start sampling on every timer tick
+ * 
+ * @return int 
+ */
+int profiler_start()
+{
+    profiler_is_running = false;
+    if (!profiler_rings)
+    {
+        profiler_rings = kzalloc(sizeof(struct ProfilerRing) * BIMBLEOS_MAX_CPUS);
+        if (!profiler_rings)
+        {
+            return -ENOMEM;
+        }
+    }
+
+    for (int i = 0; i < BIMBLEOS_MAX_CPUS; i++)
+    {
+        profiler_rings[i].head = 0;
+        profiler_rings[i].total = 0;
+    }
+
+    profiler_is_running = true;
+    return 0;
+}
+
+void profiler_stop()
+{
+    profiler_is_running = false;
+}
+
+bool profiler_running()
+{
+    return profiler_is_running;
+}
+
+/**
+ * @brief Record where the calling cpu was interrupted. Kernel code runs with interrupts
+ *        disabled, so kernel samples only show the idle loop and the interrupt entry.
+ * 
+ * @param frame 
+ */
+void profiler_sample(struct InterruptFrame *frame)
+{
+    if (!profiler_is_running)
+    {
+        return;
+    }
+
+    struct Cpu *cpu = cpu_current();
+    struct ProfilerRing *ring = &profiler_rings[cpu->id];
+    struct ProfilerSample *sample = &ring->samples[ring->head];
+    struct Task *task = task_current();
+
+    sample->eip = frame->ip;
+    sample->cs = frame->cs;
+    sample->pid = task ? task->process->id : PROFILER_IDLE_PID;
+    ring->head = (ring->head + 1) % BIMBLEOS_PROFILER_SAMPLES;
+    ring->total++;
+}
+
+static void profiler_write_record(uint32_t type, uint32_t value, const void *data, uint32_t length)
+{
+    serial_frame_begin(SERIAL_CHANNEL_PROFILE, sizeof(type) + sizeof(value) + length);
+    serial_frame_write(&type, sizeof(type));
+    serial_frame_write(&value, sizeof(value));
+    serial_frame_write(data, length);
+    serial_frame_end();
+}
+
+/**
+ * @brief Send the process table and every sample to COM1 as binary frames for
+ *        tools/profile.py. Sampling stops first so the rings hold still.
+ * 
+ * @return int 
+ */
+int profiler_dump()
+{
+    if (!profiler_rings)
+    {
+        return -EIO;
+    }
+
+    if (!serial_present())
+    {
+        return -EIO;
+    }
+
+    profiler_stop();
+    profiler_write_record(PROFILER_RECORD_BEGIN, BIMBLEOS_PROFILER_SAMPLES, 0, 0);
+    for (int i = 0; i < BIMBLEOS_MAX_PROCESSES; i++)
+    {
+        // The host tool symbolizes user samples against the program of their process
+        const char *name = process_name(i);
+        if (!name[0])
+        {
+            continue;
+        }
+
+        profiler_write_record(PROFILER_RECORD_PROCESS, i, name, strlen(name));
+    }
+
+    for (int cpu = 0; cpu < BIMBLEOS_MAX_CPUS; cpu++)
+    {
+        struct ProfilerRing *ring = &profiler_rings[cpu];
+        if (ring->total == 0)
+        {
+            continue;
+        }
+
+        // Oldest sample first, the ring has wrapped once it is full
+        uint32_t type = PROFILER_RECORD_SAMPLES;
+        uint32_t value = cpu;
+        if (ring->total < BIMBLEOS_PROFILER_SAMPLES)
+        {
+            serial_frame_begin(SERIAL_CHANNEL_PROFILE, sizeof(type) + sizeof(value) + ring->total * sizeof(struct ProfilerSample));
+            serial_frame_write(&type, sizeof(type));
+            serial_frame_write(&value, sizeof(value));
+            serial_frame_write(ring->samples, ring->total * sizeof(struct ProfilerSample));
+        }
+        else
+        {
+            serial_frame_begin(SERIAL_CHANNEL_PROFILE, sizeof(type) + sizeof(value) + sizeof(ring->samples));
+            serial_frame_write(&type, sizeof(type));
+            serial_frame_write(&value, sizeof(value));
+            serial_frame_write(&ring->samples[ring->head], (BIMBLEOS_PROFILER_SAMPLES - ring->head) * sizeof(struct ProfilerSample));
+            serial_frame_write(ring->samples, ring->head * sizeof(struct ProfilerSample));
+        }
+        serial_frame_end();
+    }
+
+    profiler_write_record(PROFILER_RECORD_END, 0, 0, 0);
+    return 0;
+}
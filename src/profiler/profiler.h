@@ -0,0 +1,50 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+// Process id of samples taken while the cpu was idle
+#define PROFILER_IDLE_PID 0xFFFF
+
+enum
+{
+    PROFILER_START,
+    PROFILER_STOP,
+    PROFILER_DUMP
+};
+
+// Records of a profile dump, each a frame on SERIAL_CHANNEL_PROFILE starting with the type
+enum
+{
+    PROFILER_RECORD_BEGIN,
+    PROFILER_RECORD_PROCESS,        // uint32_t pid, program name
+    PROFILER_RECORD_SAMPLES,        // uint32_t cpu, struct ProfilerSample oldest first
+    PROFILER_RECORD_END
+};
+
+struct ProfilerSample
+{
+    uint32_t eip;
+    uint16_t cs;
+    uint16_t pid;
+};
+
+// Written only by the timer interrupt of its cpu, the oldest samples are overwritten
+struct ProfilerRing
+{
+    uint32_t head;
+    uint32_t total;
+    struct ProfilerSample samples[BIMBLEOS_PROFILER_SAMPLES];
+};
+
+struct InterruptFrame;
+
+int profiler_start();
+void profiler_stop();
+bool profiler_running();
+void profiler_sample(struct InterruptFrame *frame);
+int profiler_dump();
+
+#endif
@@ -0,0 +1,347 @@
+#include "bimbleos.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdio.h"
+
+#define BENCH_ROUNDS 5
+#define BENCH_ITERATIONS 10000
+#define BENCH_LAUNCHES 5
+#define BENCH_LAUNCH_TSC_MASK 0x7FFFFFFF    // itoa is signed, pass the child 31 bits
+#define BENCH_READ_FILE "0:/bench.dat"
+#define BENCH_RAM_READ_FILE "2:/bench.dat"   // The same file on the RAM disk, without the ATA controller
+#define BENCH_DISK_READ_SECTORS 8192        // 4 MiB read raw from each disk per round
+#define BENCH_LARGE_DISK 3                  // Secondary master, tools/bench.py attaches a large image there
+
+// Results are printed as "BENCH <name> <value>" lines for tools/bench.py, one per round
+#define BENCH_RESULT(name, value) printf("BENCH %s %u\n", name, (unsigned int)(value))
+
+typedef int (*BENCH_SUM_FUNCTION)(int a, int b);
+
+/**
+ * @brief Average cycles of one system call round trip. The sum command is about the cheapest
+ *        call the kernel has, so this is mostly the cost of entering and leaving the kernel.
+ *
+ * @param sum bimbleos_sum for INT 0x80, bimbleos_fast_sum for SYSENTER
+ * @return int
+ */
+static int bench_syscall_round_trip(BENCH_SUM_FUNCTION sum)
+{
+    unsigned long long start = bimbleos_rdtsc();
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        sum(i, 1);
+    }
+    unsigned long long end = bimbleos_rdtsc();
+
+    // Keep the division 32 bit, there is no libgcc for 64 bit division
+    unsigned int cycles = (unsigned int)(end - start);
+    return cycles / BENCH_ITERATIONS;
+}
+
+/**
+ * @brief Average cycles of one yield while a partner process yields straight back, that is two
+ *        task switches between different address spaces. Only meaningful when both processes
+ *        share a cpu, boot with a single cpu.
+ *
+ * @return int
+ */
+static int bench_context_switch()
+{
+    unsigned long long start = bimbleos_rdtsc();
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        bimbleos_yield();
+    }
+    unsigned long long end = bimbleos_rdtsc();
+
+    unsigned int cycles = (unsigned int)(end - start);
+    return cycles / BENCH_ITERATIONS;
+}
+
+/**
+ * @brief Time stamp counter cycles per millisecond, measured against the kernel clock over a
+ *        few timer ticks
+ * 
+ * @return unsigned int 
+ */
+static unsigned int bench_cycles_per_ms()
+{
+    unsigned int tick_ms = 1000 / bimbleos_ticks_per_second();
+
+    // Start right at a tick so a whole number of ticks is measured
+    unsigned int ticks = bimbleos_ticks();
+    while (bimbleos_ticks() == ticks)
+    {
+    }
+
+    ticks = bimbleos_ticks();
+    unsigned long long start = bimbleos_rdtsc();
+    while (bimbleos_ticks() < ticks + 10)
+    {
+    }
+    unsigned long long end = bimbleos_rdtsc();
+
+    return (unsigned int)(end - start) / (10 * tick_ms);
+}
+
+/**
+ * @brief Microseconds between two time stamp counter readings without 64 bit division, both
+ *        operands are scaled down until the product fits 32 bits
+ * 
+ * @param cycles 
+ * @param cycles_per_ms 
+ * @return unsigned int 
+ */
+static unsigned int bench_cycles_to_us(unsigned long long cycles, unsigned int cycles_per_ms)
+{
+    while (cycles >> 22)
+    {
+        cycles >>= 1;
+        cycles_per_ms >>= 1;
+    }
+
+    return cycles_per_ms ? (unsigned int)cycles * 1000 / cycles_per_ms : 0;
+}
+
+static unsigned int bench_parse_number(const char* str)
+{
+    unsigned int value = 0;
+    while (*str >= '0' && *str <= '9')
+    {
+        value = value * 10 + (*str++ - '0');
+    }
+
+    return value;
+}
+
+/**
+ * @brief Launch latency, the cycles from asking the kernel to run a program until its main
+ *        runs. The child reports it, the start time comes in its arguments
+ * 
+ * @param start Low 31 bits of the time stamp counter before the launch
+ */
+static void bench_launch_child(unsigned int start)
+{
+    unsigned int now = (unsigned int)bimbleos_rdtsc();
+    BENCH_RESULT("launch_cycles", (now - start) & BENCH_LAUNCH_TSC_MASK);
+}
+
+/**
+ * @brief Wait until the programs we started have exited. The process count is refreshed on
+ *        every timer tick, so wait for at least one refresh after the launch
+ * 
+ * @param baseline Processes running before the launch
+ */
+static void bench_wait_for_children(unsigned int baseline)
+{
+    unsigned int launched = bimbleos_ticks();
+    while (bimbleos_ticks() < launched + 2 || bimbleos_process_count() > baseline)
+    {
+        bimbleos_yield();
+    }
+}
+
+static void bench_launch()
+{
+    char command[64];
+    for (int i = 0; i < BENCH_LAUNCHES; i++)
+    {
+        unsigned int baseline = bimbleos_process_count();
+        unsigned int start = (unsigned int)bimbleos_rdtsc() & BENCH_LAUNCH_TSC_MASK;
+
+        strcpy(command, "bench.elf child ");
+        strcpy(&command[strlen(command)], itoa(start));
+        if (bimbleos_system_run(command) < 0)
+        {
+            printf("Failed to launch bench.elf child\n");
+            return;
+        }
+
+        bench_wait_for_children(baseline);
+    }
+}
+
+/**
+ * @brief Read throughput of a whole file in chunks of the largest read the kernel takes
+ * 
+ * @param filename 
+ * @param prefix Prepended to the result names, "" for the boot disk
+ * @param cycles_per_ms 
+ */
+static void bench_read(const char* filename, const char* prefix, unsigned int cycles_per_ms)
+{
+    static char buffer[BIMBLEOS_MAX_FILE_READ];
+    for (int i = 0; i < BENCH_ROUNDS; i++)
+    {
+        int fd = bimbleos_fopen(filename, "r");
+        if (fd < 0)
+        {
+            printf("Skipping the read benchmark, no %s\n", filename);
+            return;
+        }
+
+        struct FileStat stat;
+        if (bimbleos_fstat(fd, &stat) < 0)
+        {
+            bimbleos_fclose(fd);
+            return;
+        }
+
+        unsigned int remaining = stat.filesize;
+        unsigned long long start = bimbleos_rdtsc();
+        while (remaining > 0)
+        {
+            int chunk = remaining > sizeof(buffer) ? sizeof(buffer) : remaining;
+            if (bimbleos_fread(fd, buffer, chunk) != chunk)
+            {
+                break;
+            }
+            remaining -= chunk;
+        }
+        unsigned long long end = bimbleos_rdtsc();
+        bimbleos_fclose(fd);
+
+        unsigned int us = bench_cycles_to_us(end - start, cycles_per_ms);
+        if (remaining || !us)
+        {
+            printf("Failed to read %s\n", filename);
+            return;
+        }
+
+        // Whole milliseconds keep the product in 32 bits
+        printf("BENCH %sread_kib_per_s %u\n", prefix, (stat.filesize / 1024) * 1000 / (us / 1000 ? us / 1000 : 1));
+        printf("BENCH %sread_us %u\n", prefix, us);
+    }
+}
+
+/**
+ * @brief Raw disk reads of one size, reports throughput and the ATA commands they took
+ * 
+ * @param drive 
+ * @param name Result name prefix
+ * @param lba 
+ * @param sectors Sectors per read
+ * @param cycles_per_ms 
+ * @return int 
+ */
+static int bench_disk_read(int drive, const char* name, unsigned int lba, unsigned int sectors, unsigned int cycles_per_ms)
+{
+    for (int i = 0; i < BENCH_ROUNDS; i++)
+    {
+        struct DiskBench bench = {.lba = lba, .sectors = sectors, .total_sectors = BENCH_DISK_READ_SECTORS};
+        if (bimbleos_disk_bench(drive, &bench) < 0)
+        {
+            printf("Failed to read disk %i\n", drive);
+            return -1;
+        }
+
+        unsigned long long cycles = ((unsigned long long)bench.cycles_high << 32) | bench.cycles_low;
+        unsigned int ms = bench_cycles_to_us(cycles, cycles_per_ms) / 1000;
+        printf("BENCH disk%i_%s_kib_per_s %u\n", drive, name, (BENCH_DISK_READ_SECTORS / 2) * 1000 / (ms ? ms : 1));
+        printf("BENCH disk%i_%s_commands %u\n", drive, name, bench.commands);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Raw read throughput of a disk below the filesystem for small, 28 bit sized and
+ *        48 bit sized reads, and at the end of the disk where large disks need LBA48
+ * 
+ * @param drive 
+ * @param cycles_per_ms 
+ */
+static void bench_disk(int drive, unsigned int cycles_per_ms)
+{
+    struct DiskBench bench = {0};
+    if (bimbleos_disk_bench(drive, &bench) < 0 || bench.disk_sectors < BENCH_DISK_READ_SECTORS)
+    {
+        printf("Skipping the raw read benchmark of disk %i\n", drive);
+        return;
+    }
+
+    printf("Raw reads of disk %i, %u sectors\n", drive, bench.disk_sectors);
+    if (bench_disk_read(drive, "read_8", 0, 8, cycles_per_ms) < 0 ||
+        bench_disk_read(drive, "read_256", 0, 256, cycles_per_ms) < 0 ||
+        bench_disk_read(drive, "read_8192", 0, 8192, cycles_per_ms) < 0)
+    {
+        return;
+    }
+
+    bench_disk_read(drive, "end_read_8192", bench.disk_sectors - BENCH_DISK_READ_SECTORS, 8192, cycles_per_ms);
+}
+
+/**
+ * @brief The other end of the ping-pong, yields as often as the benchmark does
+ *
+ */
+static void bench_partner()
+{
+    for (int i = 0; i < BENCH_ROUNDS * BENCH_ITERATIONS; i++)
+    {
+        bimbleos_yield();
+    }
+}
+
+int main(int argc, char**argv)
+{
+    if (argc > 1 && strncmp(argv[1], "partner", 7) == 0)
+    {
+        bench_partner();
+        return 0;
+    }
+
+    if (argc > 2 && strncmp(argv[1], "child", 5) == 0)
+    {
+        bench_launch_child(bench_parse_number(argv[2]));
+        return 0;
+    }
+
+    unsigned int cycles_per_ms = bench_cycles_per_ms();
+    BENCH_RESULT("cycles_per_ms", cycles_per_ms);
+
+    printf("System call round trip, %i iterations per round\n", BENCH_ITERATIONS);
+    if (!bimbleos_has_fast_syscalls())
+    {
+        printf("No SYSENTER on this cpu, skipping the fast path\n");
+    }
+    for (int i = 0; i < BENCH_ROUNDS; i++)
+    {
+        BENCH_RESULT("syscall_int80_cycles", bench_syscall_round_trip(bimbleos_sum));
+        if (bimbleos_has_fast_syscalls())
+        {
+            BENCH_RESULT("syscall_sysenter_cycles", bench_syscall_round_trip(bimbleos_fast_sum));
+        }
+    }
+
+    // Before the ping-pong, its partner would be counted as a child still running
+    printf("Program launch, %i launches\n", BENCH_LAUNCHES);
+    bench_launch();
+
+    printf("Read %s, %i rounds\n", BENCH_READ_FILE, BENCH_ROUNDS);
+    bench_read(BENCH_READ_FILE, "", cycles_per_ms);
+
+    printf("Read %s, %i rounds\n", BENCH_RAM_READ_FILE, BENCH_ROUNDS);
+    bench_read(BENCH_RAM_READ_FILE, "ram_", cycles_per_ms);
+
+    bench_disk(0, cycles_per_ms);
+    bench_disk(BENCH_LARGE_DISK, cycles_per_ms);
+
+    // Starts running the partner right away, it yields back to us
+    unsigned int baseline = bimbleos_process_count();
+    if (bimbleos_system_run("bench.elf partner") < 0)
+    {
+        printf("Failed to start the ping-pong partner\n");
+        return -1;
+    }
+
+    printf("Ping-pong yield, %i iterations per round\n", BENCH_ITERATIONS);
+    for (int i = 0; i < BENCH_ROUNDS; i++)
+    {
+        BENCH_RESULT("yield_cycles", bench_context_switch());
+    }
+
+    bench_wait_for_children(baseline);
+    printf("BENCH done\n");
+    return 0;
+}
@@ -7,6 +7,9 @@
 
 int main(int argc, char**argv)
 { 
+    // Nothing reads input here, only flush when the buffer fills up
+    setvbuf(stdout, 0, _IOFBF, 0);
+
     printf("Running blank.elf");
     while (1)
     {
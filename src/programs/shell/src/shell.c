@@ -1,8 +1,162 @@
 #include "bimbleos.h"
 #include "shell.h"
 #include "stdio.h"
+#include "string.h"
  
  
+/**
+ * @brief Built-in "syscalls": latency of every system call command made since boot
+ * 
+ */
+static void shell_syscall_stats()
+{
+    struct SyscallStatsEntry entries[SHELL_MAX_SYSCALL_STATS];
+    int total = bimbleos_syscall_stats(entries, SHELL_MAX_SYSCALL_STATS);
+    if (total < 0)
+    {
+        printf("Failed to read the system call statistics\n");
+        return;
+    }
+
+    printf("Command      Count   Mean cycles    P99 cycles\n");
+    for (int i = 0; i < total; i++)
+    {
+        printf("%7u %10u %13u %13u\n", entries[i].command, entries[i].count,
+               entries[i].mean_cycles, entries[i].p99_cycles);
+    }
+    printf("This shell made %u system calls\n", bimbleos_syscall_count());
+}
+
+/**
+ * @brief Built-in "heap": kernel heap usage, fragmentation and the call sites holding the
+ *        most blocks. Resolve caller addresses with nm build/kernel.elf
+ * 
+ */
+static void shell_heap_stats()
+{
+    struct HeapStats stats;
+    struct KheapCallerStats callers[SHELL_MAX_HEAP_CALLERS];
+    int total = bimbleos_kheap_stats(&stats, callers, SHELL_MAX_HEAP_CALLERS);
+    if (total < 0)
+    {
+        printf("Failed to read the kernel heap statistics\n");
+        return;
+    }
+
+    printf("Blocks: %u used, %u free of %u, peak %u used\n", stats.used_blocks,
+           stats.free_blocks, stats.total_blocks, stats.peak_used_blocks);
+    printf("Largest free run: %u blocks\n", stats.largest_free_run);
+    printf("Allocations: %u, frees: %u, failed: %u\n", stats.allocations, stats.frees,
+           stats.failed_allocations);
+    if (total == 0)
+    {
+        return;
+    }
+
+    printf("Caller       Allocations     Blocks       Peak\n");
+    for (int i = 0; i < total; i++)
+    {
+        printf("0x%08x %13u %10u %10u\n", callers[i].caller, callers[i].allocations,
+               callers[i].blocks, callers[i].peak_blocks);
+    }
+}
+
+/**
+ * @brief Built-in "cat": print a file, e.g. cat 9:/interrupts
+ * 
+ * @param filename 
+ */
+static void shell_cat(const char* filename)
+{
+    int fd = bimbleos_fopen(filename, "r");
+    if (fd < 0)
+    {
+        printf("Failed to open %s\n", filename);
+        return;
+    }
+
+    struct FileStat stat;
+    if (bimbleos_fstat(fd, &stat) < 0)
+    {
+        printf("Failed to stat %s\n", filename);
+        goto out;
+    }
+
+    char buffer[SHELL_CAT_CHUNK + 1];
+    unsigned int remaining = stat.filesize;
+    while (remaining > 0)
+    {
+        int chunk = remaining > SHELL_CAT_CHUNK ? SHELL_CAT_CHUNK : remaining;
+        if (bimbleos_fread(fd, buffer, chunk) != chunk)
+        {
+            printf("\nFailed to read %s\n", filename);
+            break;
+        }
+
+        buffer[chunk] = 0;
+        fputs(buffer, stdout);
+        remaining -= chunk;
+    }
+
+out:
+    bimbleos_fclose(fd);
+}
+
+/**
+ * @brief Built-in "profile start|stop|dump", dump sends the samples over COM1 for
+ *        tools/profile.py
+ * 
+ * @param operation 
+ */
+static void shell_profile(const char* operation)
+{
+    int res = -1;
+    if (strncmp(operation, "start", 6) == 0)
+    {
+        res = bimbleos_profiler(BIMBLEOS_PROFILER_START);
+    }
+    else if (strncmp(operation, "stop", 5) == 0)
+    {
+        res = bimbleos_profiler(BIMBLEOS_PROFILER_STOP);
+    }
+    else if (strncmp(operation, "dump", 5) == 0)
+    {
+        res = bimbleos_profiler(BIMBLEOS_PROFILER_DUMP);
+    }
+
+    if (res < 0)
+    {
+        printf("Usage: profile start|stop|dump, dump needs a serial port and a profile\n");
+    }
+}
+
+/**
+ * @brief Built-in "trace start|stop|dump", dump sends the trace over COM1 for
+ *        tools/trace2chrome.py
+ * 
+ * @param operation 
+ */
+static void shell_trace(const char* operation)
+{
+    int res = -1;
+    if (strncmp(operation, "start", 6) == 0)
+    {
+        res = bimbleos_trace(BIMBLEOS_TRACE_START, BIMBLEOS_TRACE_ALL_EVENTS);
+    }
+    else if (strncmp(operation, "stop", 5) == 0)
+    {
+        res = bimbleos_trace(BIMBLEOS_TRACE_STOP, 0);
+    }
+    else if (strncmp(operation, "dump", 5) == 0)
+    {
+        res = bimbleos_trace(BIMBLEOS_TRACE_DUMP, 0);
+    }
+
+    if (res < 0)
+    {
+        printf("Usage: trace start|stop|dump, dump needs a serial port and a trace\n");
+    }
+}
 
 int main(int argc, char** argv)
 {
@@ -17,7 +171,44 @@ int main(int argc, char** argv)
 
         bimbleos_terminal_realine(buff,sizeof(buff),true);
         print("\n");
-        bimbleos_system_run(buff);
+        if (strncmp(buff, "syscalls", sizeof(buff)) == 0)
+        {
+            shell_syscall_stats();
+        }
+        else if (strncmp(buff, "heap", sizeof(buff)) == 0)
+        {
+            shell_heap_stats();
+        }
+        else if (strncmp(buff, "sync", sizeof(buff)) == 0)
+        {
+            if (bimbleos_sync() < 0)
+            {
+                printf("Sync failed\n");
+            }
+        }
+        else if (strncmp(buff, "cat ", 4) == 0)
+        {
+            shell_cat(&buff[4]);
+        }
+        else if (strncmp(buff, "rm ", 3) == 0)
+        {
+            if (bimbleos_unlink(&buff[3]) < 0)
+            {
+                printf("Failed to remove %s\n", &buff[3]);
+            }
+        }
+        else if (strncmp(buff, "profile ", 8) == 0)
+        {
+            shell_profile(&buff[8]);
+        }
+        else if (strncmp(buff, "trace ", 6) == 0)
+        {
+            shell_trace(&buff[6]);
+        }
+        else
+        {
+            bimbleos_system_run(buff);
+        }
          
 
         printf("\n");
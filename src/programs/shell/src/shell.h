@@ -1,4 +1,8 @@
 #ifndef SHELL_H
 #define SHELL_H
 
+#define SHELL_MAX_SYSCALL_STATS 32
+#define SHELL_CAT_CHUNK 512
+#define SHELL_MAX_HEAP_CALLERS 10
+
 #endif
\ No newline at end of file
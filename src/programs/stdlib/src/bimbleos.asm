@@ -11,16 +11,44 @@ global bimbleos_process_load_start:function
 global bimbleos_process_get_arguments:function
 global bimbleos_system:function
 global bimbleos_exit:function
+global bimbleos_sum:function
+global bimbleos_yield:function
+global bimbleos_rdtsc:function
+global bimbleos_ioring_setup:function
+global bimbleos_ioring_enter:function
+global bimbleos_write:function
+global bimbleos_syscall_stats:function
+global bimbleos_interrupt_stats:function
+global bimbleos_fopen:function
+global bimbleos_fread:function
+global bimbleos_fclose:function
+global bimbleos_fstat:function
+global bimbleos_profiler:function
+global bimbleos_trace:function
+global bimbleos_kheap_stats:function
+global bimbleos_disk_bench:function
+global bimbleos_sync:function
+global bimbleos_fwrite:function
+global bimbleos_unlink:function
+global bimbleos_fast_sum:function
+global bimbleos_fast_putchar:function
+global bimbleos_fast_getkey:function
+
+
+; System call ABI: the command goes in EAX and up to three arguments in EBX, ESI and EDI.
+; The result comes back in EAX, every other register is preserved. EBX, ESI and EDI are
+; callee saved in C, so the stubs that use them save them first
 
 
 ; void print(const char*)
 print:
     push ebp
     mov ebp, esp
-    push dword[ebp + 8]
+    push ebx
+    mov ebx, [ebp + 8]
     mov eax, 1      ; print command
     int 0x80
-    add esp, 4
+    pop ebx
     pop ebp
     ret
 
@@ -39,10 +67,11 @@ bimbleos_getkey:
 bimbleos_malloc:
     push ebp
     mov ebp, esp
-    push dword[ebp + 8]
+    push ebx
+    mov ebx, [ebp + 8]
     mov eax, 4     ; malloc command
     int 0x80
-    add esp, 4
+    pop ebx
     pop ebp
     ret
 
@@ -52,10 +81,11 @@ bimbleos_malloc:
 bimbleos_free:
     push ebp
     mov ebp, esp
-    push dword[ebp + 8]
+    push ebx
+    mov ebx, [ebp + 8]
     mov eax, 5     ; free command
     int 0x80
-    add esp, 4
+    pop ebx
     pop ebp
     ret
 
@@ -63,10 +93,11 @@ bimbleos_free:
 bimbleos_putchar:
     push ebp
     mov ebp, esp
-    push dword [ebp + 8]
+    push ebx
+    mov ebx, [ebp + 8]
     mov eax, 3       ; putchar command
     int 0x80
-    add esp, 4
+    pop ebx
     pop ebp
     ret
 
@@ -75,10 +106,11 @@ bimbleos_putchar:
 bimbleos_process_load_start:
     push ebp
     mov ebp, esp
-    push dword [ebp + 8]
+    push ebx
+    mov ebx, [ebp + 8]
     mov eax, 6          ; process_load command
     int 0x80
-    add esp, 4
+    pop ebx
     pop ebp
     ret
 
@@ -87,10 +119,11 @@ bimbleos_process_load_start:
 bimbleos_process_get_arguments:
     push ebp
     mov ebp, esp
-    push dword[ebp+8]   ; Variable arguments
+    push ebx
+    mov ebx, [ebp+8]    ; Variable arguments
     mov eax, 8          ; Gets the process arguments command
     int 0x80
-    add esp, 4
+    pop ebx
     pop ebp
     ret
 
@@ -98,10 +131,11 @@ bimbleos_process_get_arguments:
 bimbleos_system:
     push ebp
     mov ebp, esp
-    push dword[ebp+8]   ; Variable "arguments"
+    push ebx
+    mov ebx, [ebp+8]    ; Variable "arguments"
     mov eax, 7          ; runs a system command 
     int 0x80
-    add esp, 4
+    pop ebx
     pop ebp
     ret
 
@@ -112,4 +146,304 @@ bimbleos_exit:
     mov eax, 9          ; Command 9 process exit
     int 0x80
     pop ebp
-    ret
\ No newline at end of file
+    ret
+
+; int bimbleos_sum(int a, int b)
+bimbleos_sum:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push esi
+    mov ebx, [ebp+8]    ; Variable "a"
+    mov esi, [ebp+12]   ; Variable "b"
+    mov eax, 0          ; Command 0 sum
+    int 0x80
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; void bimbleos_yield()
+bimbleos_yield:
+    push ebp
+    mov ebp, esp
+    mov eax, 10         ; Command 10 yield
+    int 0x80
+    pop ebp
+    ret
+
+; struct IoRing* bimbleos_ioring_setup()
+bimbleos_ioring_setup:
+    push ebp
+    mov ebp, esp
+    mov eax, 11         ; Command 11 sets up the system call ring
+    int 0x80
+    pop ebp
+    ret
+
+; int bimbleos_ioring_enter()
+bimbleos_ioring_enter:
+    push ebp
+    mov ebp, esp
+    mov eax, 12         ; Command 12 runs the queued ring submissions
+    int 0x80
+    pop ebp
+    ret
+
+; int bimbleos_write(const char* buffer, size_t length)
+bimbleos_write:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push esi
+    mov ebx, [ebp+8]    ; Variable "buffer"
+    mov esi, [ebp+12]   ; Variable "length"
+    mov eax, 13         ; Command 13 write
+    int 0x80
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_syscall_stats(struct SyscallStatsEntry* entries, int max)
+bimbleos_syscall_stats:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push esi
+    mov ebx, [ebp+8]    ; Variable "entries"
+    mov esi, [ebp+12]   ; Variable "max"
+    mov eax, 14         ; Command 14 syscall stats
+    int 0x80
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_interrupt_stats(struct InterruptStatsEntry* entries, int max)
+bimbleos_interrupt_stats:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push esi
+    mov ebx, [ebp+8]    ; Variable "entries"
+    mov esi, [ebp+12]   ; Variable "max"
+    mov eax, 15         ; Command 15 interrupt stats
+    int 0x80
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_fopen(const char* filename, const char* mode)
+bimbleos_fopen:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push esi
+    mov ebx, [ebp+8]    ; Variable "filename"
+    mov esi, [ebp+12]   ; Variable "mode"
+    mov eax, 16         ; Command 16 fopen
+    int 0x80
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_fread(int fd, void* buffer, size_t size)
+bimbleos_fread:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push esi
+    push edi
+    mov ebx, [ebp+8]    ; Variable "fd"
+    mov esi, [ebp+12]   ; Variable "buffer"
+    mov edi, [ebp+16]   ; Variable "size"
+    mov eax, 17         ; Command 17 fread
+    int 0x80
+    pop edi
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_fclose(int fd)
+bimbleos_fclose:
+    push ebp
+    mov ebp, esp
+    push ebx
+    mov ebx, [ebp+8]    ; Variable "fd"
+    mov eax, 18         ; Command 18 fclose
+    int 0x80
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_fstat(int fd, struct FileStat* stat)
+bimbleos_fstat:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push esi
+    mov ebx, [ebp+8]    ; Variable "fd"
+    mov esi, [ebp+12]   ; Variable "stat"
+    mov eax, 19         ; Command 19 fstat
+    int 0x80
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_profiler(int operation)
+bimbleos_profiler:
+    push ebp
+    mov ebp, esp
+    push ebx
+    mov ebx, [ebp+8]    ; Variable "operation"
+    mov eax, 20         ; Command 20 profiler
+    int 0x80
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_trace(int operation, unsigned int events)
+bimbleos_trace:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push esi
+    mov ebx, [ebp+8]    ; Variable "operation"
+    mov esi, [ebp+12]   ; Variable "events"
+    mov eax, 21         ; Command 21 trace
+    int 0x80
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_kheap_stats(struct HeapStats* stats, struct KheapCallerStats* callers, int max)
+bimbleos_kheap_stats:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push esi
+    push edi
+    mov ebx, [ebp+8]    ; Variable "stats"
+    mov esi, [ebp+12]   ; Variable "callers"
+    mov edi, [ebp+16]   ; Variable "max"
+    mov eax, 22         ; Command 22 kernel heap statistics
+    int 0x80
+    pop edi
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_disk_bench(int drive, struct DiskBench* bench)
+bimbleos_disk_bench:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push esi
+    mov ebx, [ebp+8]    ; Variable "drive"
+    mov esi, [ebp+12]   ; Variable "bench"
+    mov eax, 23         ; Command 23 disk benchmark
+    int 0x80
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_sync()
+bimbleos_sync:
+    push ebp
+    mov ebp, esp
+    mov eax, 24         ; Command 24 sync
+    int 0x80
+    pop ebp
+    ret
+
+; int bimbleos_fwrite(int fd, const void* buffer, size_t size)
+bimbleos_fwrite:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push esi
+    push edi
+    mov ebx, [ebp+8]    ; Variable "fd"
+    mov esi, [ebp+12]   ; Variable "buffer"
+    mov edi, [ebp+16]   ; Variable "size"
+    mov eax, 25         ; Command 25 fwrite
+    int 0x80
+    pop edi
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_unlink(const char* filename)
+bimbleos_unlink:
+    push ebp
+    mov ebp, esp
+    push ebx
+    mov ebx, [ebp+8]    ; Variable "filename"
+    mov eax, 26         ; Command 26 unlink
+    int 0x80
+    pop ebx
+    pop ebp
+    ret
+
+; unsigned long long bimbleos_rdtsc()
+bimbleos_rdtsc:
+    rdtsc               ; Time stamp counter in edx:eax, the 64 bit return registers
+    ret
+
+
+; The bimbleos_fast_* variants enter the kernel with SYSENTER instead of INT 0x80, with the
+; same registers. The kernel also needs our stack pointer in ECX and the return address in EDX
+
+; int bimbleos_fast_sum(int a, int b)
+bimbleos_fast_sum:
+    push ebp
+    mov ebp, esp
+    push ebx
+    push esi
+    mov ebx, [ebp+8]    ; Variable "a"
+    mov esi, [ebp+12]   ; Variable "b"
+    mov eax, 0          ; Command 0 sum
+    mov ecx, esp
+    mov edx, .return
+    sysenter
+.return:
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; void bimbleos_fast_putchar(char c)
+bimbleos_fast_putchar:
+    push ebp
+    mov ebp, esp
+    push ebx
+    mov ebx, [ebp+8]    ; Variable "c"
+    mov eax, 3          ; putchar command
+    mov ecx, esp
+    mov edx, .return
+    sysenter
+.return:
+    pop ebx
+    pop ebp
+    ret
+
+; int bimbleos_fast_getkey()
+bimbleos_fast_getkey:
+    push ebp
+    mov ebp, esp
+    mov eax, 2          ; getkey command
+    mov ecx, esp
+    mov edx, .return
+    sysenter
+.return:
+    pop ebp
+    ret
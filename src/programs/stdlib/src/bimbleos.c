@@ -1,11 +1,16 @@
 #include "bimbleos.h"
 #include "string.h"
 #include "stdlib.h"
+#include "stdio.h"
+#include "vdso.h"
 
 
 
 int bimbleos_getkeyblock()
 {
+    // Whatever was printed must be visible before waiting for input
+    fflush(stdout);
+
     int val = 0;
     do
     {
@@ -105,5 +110,72 @@ int bimbleos_system_run(const char* command)
         return -1;
     }
 
+    // Output stays in order with what the program prints
+    fflush(stdout);
     return bimbleos_system(root_command_argument);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Read one field of the kernel data page consistently, without a system call
+ * 
+ * @param field 
+ * @return unsigned int 
+ */
+static unsigned int bimbleos_vdso_read(volatile uint32_t* field)
+{
+    struct VdsoData* data = (struct VdsoData*)BIMBLEOS_VDSO_DATA_ADDRESS;
+    uint32_t sequence;
+    uint32_t value;
+    do
+    {
+        sequence = data->sequence;
+        value = *field;
+    } while ((sequence & 1) || sequence != data->sequence);
+
+    return value;
+}
+
+unsigned int bimbleos_ticks()
+{
+    return bimbleos_vdso_read(&((struct VdsoData*)BIMBLEOS_VDSO_DATA_ADDRESS)->ticks);
+}
+
+unsigned int bimbleos_ticks_per_second()
+{
+    return bimbleos_vdso_read(&((struct VdsoData*)BIMBLEOS_VDSO_DATA_ADDRESS)->ticks_per_second);
+}
+
+unsigned int bimbleos_uptime_ms()
+{
+    return bimbleos_vdso_read(&((struct VdsoData*)BIMBLEOS_VDSO_DATA_ADDRESS)->uptime_ms);
+}
+
+unsigned int bimbleos_process_count()
+{
+    return bimbleos_vdso_read(&((struct VdsoData*)BIMBLEOS_VDSO_DATA_ADDRESS)->process_count);
+}
+
+/**
+ * @brief Whether the cpu has SYSENTER, the bimbleos_fast_* calls fault without it
+ * 
+ * @return true 
+ */
+bool bimbleos_has_fast_syscalls()
+{
+    return ((struct VdsoData*)BIMBLEOS_VDSO_DATA_ADDRESS)->features & BIMBLEOS_VDSO_FEATURE_SYSENTER;
+}
+
+int bimbleos_getpid()
+{
+    return ((struct VdsoProcessData*)BIMBLEOS_VDSO_PROCESS_ADDRESS)->pid;
+}
+
+/**
+ * @brief System calls made by this process so far, read from the vdso page
+ * 
+ * @return unsigned int 
+ */
+unsigned int bimbleos_syscall_count()
+{
+    return ((struct VdsoProcessData*)BIMBLEOS_VDSO_PROCESS_ADDRESS)->syscall_count;
+}
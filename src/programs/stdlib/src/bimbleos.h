@@ -15,6 +15,92 @@ struct ProcessArguments
     char** argv;
 };
 
+// System call latency of one command, must match the kernel's definition
+struct SyscallStatsEntry
+{
+    unsigned int command;
+    unsigned int count;
+    unsigned int mean_cycles;
+    unsigned int p99_cycles;
+};
+
+// Interrupt counts and handler time of one vector, must match the kernel's definition
+struct InterruptStatsEntry
+{
+    unsigned int interrupt;
+    unsigned int count;
+    unsigned int mean_cycles;
+    unsigned int max_cycles;
+    unsigned int max_latency_cycles;
+};
+
+#define BIMBLEOS_FILE_STAT_READ_ONLY 0x01
+
+// Must match the kernel's definition
+struct FileStat
+{
+    unsigned int flags;
+    unsigned int filesize;
+};
+
+// Kernel heap usage in blocks of 4096 bytes, must match the kernel's definition
+struct HeapStats
+{
+    unsigned int total_blocks;
+    unsigned int used_blocks;
+    unsigned int free_blocks;
+    unsigned int largest_free_run;
+    unsigned int peak_used_blocks;
+    unsigned int allocations;
+    unsigned int frees;
+    unsigned int failed_allocations;
+};
+
+// Kernel heap usage of one call site, must match the kernel's definition
+struct KheapCallerStats
+{
+    unsigned int caller;
+    unsigned int allocations;
+    unsigned int blocks;
+    unsigned int peak_blocks;
+};
+
+// Raw read benchmark of one disk, must match the kernel's definition
+struct DiskBench
+{
+    unsigned int lba;
+    unsigned int sectors;           // Sectors per read
+    unsigned int total_sectors;     // 0 only reports disk_sectors
+    unsigned int cycles_low;
+    unsigned int cycles_high;
+    unsigned int commands;          // ATA commands the reads took
+    unsigned int disk_sectors;
+};
+
+// Largest size bimbleos_fread accepts
+#define BIMBLEOS_MAX_FILE_READ 4096
+// Largest size bimbleos_fwrite accepts
+#define BIMBLEOS_MAX_FILE_WRITE 4096
+
+// Operations of bimbleos_profiler
+enum
+{
+    BIMBLEOS_PROFILER_START,
+    BIMBLEOS_PROFILER_STOP,
+    BIMBLEOS_PROFILER_DUMP
+};
+
+// Operations of bimbleos_trace
+enum
+{
+    BIMBLEOS_TRACE_START,
+    BIMBLEOS_TRACE_STOP,
+    BIMBLEOS_TRACE_DUMP
+};
+
+// Events argument of BIMBLEOS_TRACE_START enabling every tracepoint
+#define BIMBLEOS_TRACE_ALL_EVENTS 0xFFFFFFFF
+
 void print(const char *);
 void* bimbleos_malloc(size_t); 
 void bimbleos_free(void*); 
@@ -28,5 +114,32 @@ void bimbleos_process_get_arguments(struct ProcessArguments*);
 int bimbleos_system(struct CommandArgument* arguments);
 int bimbleos_system_run(const char* command);
 void bimbleos_exit();
+int bimbleos_write(const char* buffer, size_t length);
+int bimbleos_syscall_stats(struct SyscallStatsEntry* entries, int max);
+unsigned int bimbleos_syscall_count();
+int bimbleos_interrupt_stats(struct InterruptStatsEntry* entries, int max);
+int bimbleos_fopen(const char* filename, const char* mode);
+int bimbleos_fread(int fd, void* buffer, size_t size);
+int bimbleos_fclose(int fd);
+int bimbleos_fstat(int fd, struct FileStat* stat);
+int bimbleos_profiler(int operation);
+int bimbleos_trace(int operation, unsigned int events);
+int bimbleos_kheap_stats(struct HeapStats* stats, struct KheapCallerStats* callers, int max);
+int bimbleos_disk_bench(int drive, struct DiskBench* bench);
+int bimbleos_sync();
+int bimbleos_fwrite(int fd, const void* buffer, size_t size);
+int bimbleos_unlink(const char* filename);
+unsigned int bimbleos_ticks();
+unsigned int bimbleos_ticks_per_second();
+unsigned int bimbleos_uptime_ms();
+unsigned int bimbleos_process_count();
+int bimbleos_getpid();
+int bimbleos_sum(int a, int b);
+void bimbleos_yield();
+unsigned long long bimbleos_rdtsc();
+bool bimbleos_has_fast_syscalls();
+int bimbleos_fast_sum(int a, int b);
+void bimbleos_fast_putchar(char c);
+int bimbleos_fast_getkey();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "ioring.h"
+
+static struct IoRing* process_ring = 0;
+
+/**
+ * @brief The process's ring, set up on first use
+ * 
+ * @return struct IoRing* 0 if the kernel could not provide one
+ */
+struct IoRing* ioring_get()
+{
+    if (!process_ring)
+    {
+        process_ring = bimbleos_ioring_setup();
+    }
+
+    return process_ring;
+}
+
+/**
+ * @brief Whether the process set up its ring already, without setting one up
+ * 
+ * @return true 
+ */
+bool ioring_active()
+{
+    return process_ring != 0;
+}
+
+/**
+ * @brief Queue an operation, nothing happens until ioring_enter or the next scheduler tick
+ * 
+ * @return int 0 on success, -1 when there is no ring or it is full
+ */
+int ioring_submit(uint32_t operation, uint32_t argument0, uint32_t argument1, uint32_t user_data)
+{
+    struct IoRing* ring = ioring_get();
+    if (!ring || ring->submission_tail - ring->submission_head >= IORING_TOTAL_ENTRIES)
+    {
+        return -1;
+    }
+
+    struct IoRingSubmission* submission = &ring->submissions[ring->submission_tail % IORING_TOTAL_ENTRIES];
+    submission->operation = operation;
+    submission->argument0 = argument0;
+    submission->argument1 = argument1;
+    submission->user_data = user_data;
+
+    // The entry must be complete before the kernel can see it
+    __sync_synchronize();
+    ring->submission_tail++;
+    return 0;
+}
+
+/**
+ * @brief Trap once to run every queued operation that has room for its completion
+ * 
+ * @return int Number of operations run
+ */
+int ioring_enter()
+{
+    return bimbleos_ioring_enter();
+}
+
+/**
+ * @brief Take the oldest completion
+ * 
+ * @param completion 
+ * @return int 1 if one was taken, 0 if none is ready
+ */
+int ioring_reap(struct IoRingCompletion* completion)
+{
+    struct IoRing* ring = ioring_get();
+    if (!ring || ring->completion_head == ring->completion_tail)
+    {
+        return 0;
+    }
+
+    *completion = ring->completions[ring->completion_head % IORING_TOTAL_ENTRIES];
+    ring->completion_head++;
+    return 1;
+}
+
+/**
+ * @brief Queue an operation and wait for its result. Completions of operations queued before
+ *        it are discarded, so a program mixing its own submissions with printf must reap what
+ *        it needs first.
+ * 
+ * @param operation 
+ * @param argument0 
+ * @param argument1 
+ * @param result The operation's result
+ * @return int 0 once it ran, -1 when there is no ring or it is full
+ */
+int ioring_run(uint32_t operation, uint32_t argument0, uint32_t argument1, int* result)
+{
+    struct IoRing* ring = ioring_get();
+    if (!ring)
+    {
+        return -1;
+    }
+
+    // Every submission gets one completion in the same order, so they share a sequence number
+    uint32_t sequence = ring->submission_tail;
+    if (ioring_submit(operation, argument0, argument1, sequence) < 0)
+    {
+        return -1;
+    }
+
+    struct IoRingCompletion completion;
+    while (1)
+    {
+        if (ring->completion_head == ring->completion_tail)
+        {
+            ioring_enter();
+            continue;
+        }
+
+        uint32_t number = ring->completion_head;
+        ioring_reap(&completion);
+        if (number == sequence)
+        {
+            *result = completion.result;
+            return 0;
+        }
+    }
+}
+
+/**
+ * @brief Run everything queued and discard the completions
+ * 
+ */
+void ioring_flush()
+{
+    struct IoRing* ring = ioring_get();
+    if (!ring)
+    {
+        return;
+    }
+
+    struct IoRingCompletion completion;
+    while (ring->submission_head != ring->submission_tail)
+    {
+        ioring_enter();
+        while (ioring_reap(&completion))
+        {
+        }
+    }
+
+    while (ioring_reap(&completion))
+    {
+    }
+}
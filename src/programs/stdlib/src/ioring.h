@@ -0,0 +1,54 @@
+#ifndef BIMBLEOS_IORING_H
+#define BIMBLEOS_IORING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define IORING_TOTAL_ENTRIES 64
+
+enum IoRingOperation
+{
+    IORING_OP_PUTCHAR,                      // argument0: character
+    IORING_OP_PRINT,                        // argument0: null terminated string
+    IORING_OP_WRITE,                        // argument0: buffer, argument1: length
+    IORING_OP_GETKEY                        // result: key or 0 when none is waiting
+};
+
+struct IoRingSubmission
+{
+    uint32_t operation;
+    uint32_t argument0;
+    uint32_t argument1;
+    uint32_t user_data;
+};
+
+struct IoRingCompletion
+{
+    uint32_t user_data;
+    int32_t result;
+};
+
+// Shared with the kernel, must match its definition
+struct IoRing
+{
+    volatile uint32_t submission_head;
+    volatile uint32_t submission_tail;
+    volatile uint32_t completion_head;
+    volatile uint32_t completion_tail;
+
+    struct IoRingSubmission submissions[IORING_TOTAL_ENTRIES];
+    struct IoRingCompletion completions[IORING_TOTAL_ENTRIES];
+};
+
+struct IoRing* ioring_get();
+bool ioring_active();
+int ioring_submit(uint32_t operation, uint32_t argument0, uint32_t argument1, uint32_t user_data);
+int ioring_enter();
+int ioring_reap(struct IoRingCompletion* completion);
+int ioring_run(uint32_t operation, uint32_t argument0, uint32_t argument1, int* result);
+void ioring_flush();
+
+struct IoRing* bimbleos_ioring_setup();
+int bimbleos_ioring_enter();
+
+#endif
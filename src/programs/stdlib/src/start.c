@@ -1,4 +1,5 @@
 #include "bimbleos.h"
+#include "stdio.h"
 
 
 extern int main(int argc, char** argv);
@@ -8,6 +9,7 @@ void c_start(){
     bimbleos_process_get_arguments(&arguments);
 
     int res  = main(arguments.argc,arguments.argv);
+    fflush(stdout);
     
     if(res == 0)
     {
@@ -1,20 +1,178 @@
 #include "bimbleos.h"
 #include "stdio.h"
 #include "stdlib.h"
+#include "ioring.h"
 #include <stdarg.h>
+#include <stdint.h>
 
-int putchar(int c)
+static char stdout_buffer[BUFSIZ];
+static FILE stdout_file = {
+    .buffer = stdout_buffer,
+    .size = sizeof(stdout_buffer),
+    .length = 0,
+    .mode = _IOLBF
+};
+
+FILE* stdout = &stdout_file;
+
+/**
+ * @brief Change the buffering of a stream. Flushes whatever is buffered first
+ * 
+ * @param stream 
+ * @param buffer Caller provided storage, 0 keeps the current buffer
+ * @param mode _IOFBF, _IOLBF or _IONBF
+ * @param size Size of 'buffer'
+ * @return int 0 on success
+ */
+int setvbuf(FILE* stream, char* buffer, int mode, size_t size)
+{
+    if (mode != _IOFBF && mode != _IOLBF && mode != _IONBF)
+    {
+        return EOF;
+    }
+
+    fflush(stream);
+    if (buffer && size)
+    {
+        stream->buffer = buffer;
+        stream->size = size;
+    }
+    stream->mode = mode;
+    return 0;
+}
+
+/**
+ * @brief Hand everything buffered to the kernel in a single write system call, or as one
+ *        write operation on the process's ring once it has set one up, so the output stays in
+ *        order with what it queued there
+ * 
+ * @param stream 
+ * @return int 0 on success
+ */
+int fflush(FILE* stream)
+{
+    if (stream->length == 0)
+    {
+        return 0;
+    }
+
+    // The kernel writes at most BIMBLEOS_MAX_FILE_WRITE characters at a time
+    int res = 0;
+    size_t written = 0;
+    while (written < stream->length)
+    {
+        char* buffer = stream->buffer + written;
+        size_t length = stream->length - written;
+        if (!ioring_active() || ioring_run(IORING_OP_WRITE, (uint32_t)buffer, length, &res) < 0)
+        {
+            res = bimbleos_write(buffer, length);
+        }
+
+        if (res <= 0)
+        {
+            break;
+        }
+        written += res;
+    }
+    stream->length = 0;
+    return res < 0 ? EOF : 0;
+}
+
+int fputc(int c, FILE* stream)
+{
+    if (stream->mode == _IONBF)
+    {
+        char ch = (char)c;
+        return bimbleos_write(&ch, 1) < 0 ? EOF : c;
+    }
+
+    if (stream->length == stream->size)
+    {
+        fflush(stream);
+    }
+
+    stream->buffer[stream->length++] = (char)c;
+    if (stream->mode == _IOLBF && c == '\n')
+    {
+        fflush(stream);
+    }
+
+    return c;
+}
+
+int fputs(const char* str, FILE* stream)
 {
-    bimbleos_putchar((char)c);
+    while (*str)
+    {
+        fputc(*str++, stream);
+    }
+
     return 0;
 }
 
+int putchar(int c)
+{
+    return fputc(c, stdout);
+}
+
+/**
+ * @brief Print 'digits' padded to 'width'
+ * 
+ * @param digits 
+ * @param length 
+ * @param width 
+ * @param pad ' ' or '0'
+ * @param negative Print a minus sign, which goes before zero padding
+ */
+static void printf_pad_number(const char* digits, int length, int width, char pad, bool negative)
+{
+    int total = length + (negative ? 1 : 0);
+    if (negative && pad == '0')
+    {
+        putchar('-');
+    }
+
+    for (int i = total; i < width; i++)
+    {
+        putchar(pad);
+    }
+
+    if (negative && pad != '0')
+    {
+        putchar('-');
+    }
+
+    for (int i = 0; i < length; i++)
+    {
+        putchar(digits[i]);
+    }
+}
+
+static void printf_unsigned(uint32_t value, uint32_t base, int width, char pad, bool negative)
+{
+    char digits[12];
+    int loc = sizeof(digits);
+    do
+    {
+        digits[--loc] = "0123456789abcdef"[value % base];
+        value /= base;
+    } while (value);
+
+    printf_pad_number(&digits[loc], sizeof(digits) - loc, width, pad, negative);
+}
+
+/**
+ * @brief Formatted output to stdout. Supports %d %i %u %x %c %s %p and %%, with an optional
+ *        field width and '0' padding flag, e.g. %08x
+ * 
+ * @param fmt 
+ * @param ... 
+ * @return int 
+ */
 int printf(char *fmt, ...)
 {
     va_list ap;
     const char *p;
-    char *sval;
-    int ival;
 
     va_start(ap, fmt);
 
@@ -26,17 +184,74 @@ int printf(char *fmt, ...)
             continue;
         }
 
-        switch (*++p)
+        p++;
+        char pad = ' ';
+        if (*p == '0')
+        {
+            pad = '0';
+            p++;
+        }
+
+        int width = 0;
+        while (*p >= '0' && *p <= '9')
+        {
+            width = width * 10 + (*p - '0');
+            p++;
+        }
+
+        switch (*p)
         {
+        case 'd':
         case 'i':
-            ival = va_arg(ap, int);
-            print(itoa(ival));
+        {
+            int ival = va_arg(ap, int);
+            uint32_t magnitude = ival < 0 ? -(uint32_t)ival : (uint32_t)ival;
+            printf_unsigned(magnitude, 10, width, pad, ival < 0);
+        }
+            break;
+
+        case 'u':
+            printf_unsigned(va_arg(ap, uint32_t), 10, width, pad, false);
+            break;
+
+        case 'x':
+            printf_unsigned(va_arg(ap, uint32_t), 16, width, pad, false);
+            break;
+
+        case 'p':
+            fputs("0x", stdout);
+            printf_unsigned((uint32_t)va_arg(ap, void *), 16, 8, '0', false);
+            break;
+
+        case 'c':
+            putchar((char)va_arg(ap, int));
             break;
 
         case 's':
-            sval = va_arg(ap, char *);
-            print(sval);
+        {
+            const char* sval = va_arg(ap, char *);
+            int length = 0;
+            while (sval[length])
+            {
+                length++;
+            }
+            for (int i = length; i < width; i++)
+            {
+                putchar(' ');
+            }
+            fputs(sval, stdout);
+        }
             break;
+
+        case '%':
+            putchar('%');
+            break;
+
+        case 0:
+            // Lone '%' at the end of the format
+            p--;
+            break;
+
         default:
             break;
         }
@@ -45,4 +260,4 @@ int printf(char *fmt, ...)
     va_end(ap);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -1,6 +1,31 @@
 #ifndef BIMBLEOS_STDIO_H
 #define BIMBLEOS_STDIO_H
 
-int printf(char *fmt, ...);
+#include <stddef.h>
+
+#define EOF (-1)
+#define BUFSIZ 1024
+
+// Buffering modes for setvbuf
+#define _IOFBF 0        // Flush when the buffer is full
+#define _IOLBF 1        // Flush at every newline
+#define _IONBF 2        // Write straight through
+
+typedef struct FILE
+{
+    char* buffer;
+    size_t size;
+    size_t length;
+    int mode;
+} FILE;
+
+extern FILE* stdout;
+
+int setvbuf(FILE* stream, char* buffer, int mode, size_t size);
+int fflush(FILE* stream);
+int fputc(int c, FILE* stream);
+int fputs(const char* str, FILE* stream);
 int putchar(int c);
-#endif
\ No newline at end of file
+int printf(char *fmt, ...);
+
+#endif
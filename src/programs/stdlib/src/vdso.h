@@ -0,0 +1,29 @@
+#ifndef BIMBLEOS_VDSO_H
+#define BIMBLEOS_VDSO_H
+
+#include <stdint.h>
+
+#define BIMBLEOS_VDSO_DATA_ADDRESS 0x3F9000
+#define BIMBLEOS_VDSO_PROCESS_ADDRESS 0x3FA000
+
+// Bits of VdsoData.features
+#define BIMBLEOS_VDSO_FEATURE_SYSENTER 0x1
+
+// Read only kernel data, must match the kernel's definition
+struct VdsoData
+{
+    volatile uint32_t sequence;
+    volatile uint32_t ticks;
+    volatile uint32_t ticks_per_second;
+    volatile uint32_t uptime_ms;
+    volatile uint32_t process_count;
+    uint32_t features;
+};
+
+struct VdsoProcessData
+{
+    uint32_t pid;
+    volatile uint32_t syscall_count;
+};
+
+#endif
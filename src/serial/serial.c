@@ -0,0 +1,288 @@
+#include "serial.h"
+#include "config.h"
+#include "io/io.h"
+#include "idt/idt.h"
+#include "apic/apic.h"
+#include "string/string.h"
+#include "memory/memory.h"
+#include "smp/spinlock.h"
+#include "keyboard/keyboard.h"
+
+static bool serial_is_present = false;
+static bool serial_interrupts_enabled = false;
+
+// Bytes waiting for the transmit FIFO, refilled from the COM1 interrupt
+static char serial_tx_buffer[BIMBLEOS_SERIAL_TX_BUFFER_SIZE];
+static uint32_t serial_tx_head = 0;
+static uint32_t serial_tx_tail = 0;
+
+// Guards the transmit buffer. A frame keeps it from begin to end so log text can not
+// end up inside
+static struct Spinlock serial_lock = SPINLOCK_INIT;
+
+// Running Adler-32 of the frame being written
+static uint32_t serial_frame_a = 1;
+static uint32_t serial_frame_b = 0;
+
+/**
+ * @brief Set up COM1 for 115200 baud 8N1 with FIFOs. A loopback test tells whether a UART is
+ *        there at all. Output is polled until serial_enable_interrupts.
+ * 
+ */
+void serial_init()
+{
+    outb(SERIAL_COM1_PORT + SERIAL_REGISTER_INTERRUPT_ENABLE, 0x00);
+    outb(SERIAL_COM1_PORT + SERIAL_REGISTER_LINE_CONTROL, SERIAL_LINE_CONTROL_DLAB);
+    outb(SERIAL_COM1_PORT + SERIAL_REGISTER_DATA, SERIAL_BAUD_DIVISOR_115200);
+    outb(SERIAL_COM1_PORT + SERIAL_REGISTER_INTERRUPT_ENABLE, 0x00);
+    outb(SERIAL_COM1_PORT + SERIAL_REGISTER_LINE_CONTROL, SERIAL_LINE_CONTROL_8N1);
+    outb(SERIAL_COM1_PORT + SERIAL_REGISTER_FIFO_CONTROL, 0xC7);    // Enable and clear, 14 byte threshold
+
+    // Loopback mode, what we send must come back
+    outb(SERIAL_COM1_PORT + SERIAL_REGISTER_MODEM_CONTROL, 0x1E);
+    outb(SERIAL_COM1_PORT + SERIAL_REGISTER_DATA, 0xAE);
+    if (insb(SERIAL_COM1_PORT + SERIAL_REGISTER_DATA) != 0xAE)
+    {
+        return;
+    }
+
+    // Normal operation, DTR, RTS and OUT2 set
+    outb(SERIAL_COM1_PORT + SERIAL_REGISTER_MODEM_CONTROL, 0x0F);
+    serial_is_present = true;
+}
+
+bool serial_present()
+{
+    return serial_is_present;
+}
+
+static bool serial_tx_empty()
+{
+    return serial_tx_head == serial_tx_tail;
+}
+
+static bool serial_tx_full()
+{
+    return (serial_tx_head + 1) % BIMBLEOS_SERIAL_TX_BUFFER_SIZE == serial_tx_tail;
+}
+
+/**
+ * @brief Move up to a FIFO worth of bytes into the UART once it has sent everything, and
+ *        ask for an interrupt when it is empty again while bytes are waiting. Caller must
+ *        hold serial_lock
+ * 
+ */
+static void serial_fill_fifo()
+{
+    if (!(insb(SERIAL_COM1_PORT + SERIAL_REGISTER_LINE_STATUS) & SERIAL_LINE_STATUS_TRANSMIT_EMPTY))
+    {
+        return;
+    }
+
+    for (int i = 0; i < SERIAL_FIFO_SIZE && !serial_tx_empty(); i++)
+    {
+        outb(SERIAL_COM1_PORT + SERIAL_REGISTER_DATA, serial_tx_buffer[serial_tx_tail]);
+        serial_tx_tail = (serial_tx_tail + 1) % BIMBLEOS_SERIAL_TX_BUFFER_SIZE;
+    }
+
+    if (serial_interrupts_enabled)
+    {
+        outb(SERIAL_COM1_PORT + SERIAL_REGISTER_INTERRUPT_ENABLE,
+             SERIAL_INTERRUPT_DATA_AVAILABLE | (serial_tx_empty() ? 0x00 : SERIAL_INTERRUPT_TRANSMIT_EMPTY));
+    }
+}
+
+/**
+ * @brief Queue one byte. Kernel code runs with interrupts disabled, so when the buffer is
+ *        full this cpu drains it by polling. Caller must hold serial_lock
+ * 
+ * @param c 
+ */
+static void serial_put(char c)
+{
+    while (serial_tx_full())
+    {
+        serial_fill_fifo();
+    }
+
+    serial_tx_buffer[serial_tx_head] = c;
+    serial_tx_head = (serial_tx_head + 1) % BIMBLEOS_SERIAL_TX_BUFFER_SIZE;
+}
+
+/**
+ * @brief Start the queued bytes moving. Without interrupts nothing else would send them, so
+ *        wait until all of them are in the UART. Caller must hold serial_lock
+ * 
+ */
+static void serial_flush()
+{
+    serial_fill_fifo();
+    while (!serial_interrupts_enabled && !serial_tx_empty())
+    {
+        serial_fill_fifo();
+    }
+}
+
+/**
+ * @brief Terminals send carriage return for enter and delete for backspace, line feeds
+ *        become carriage returns too so piped scripts work. The result goes to the
+ *        keyboard buffer of the foreground process like a key press
+ * 
+ * @param c 
+ */
+static void serial_receive(char c)
+{
+    if (c == '\n')
+    {
+        c = '\r';
+    }
+    else if (c == 0x7F)
+    {
+        c = 0x08;
+    }
+
+    keyboard_push(c);
+}
+
+static void serial_handle_interrupt()
+{
+    char received[SERIAL_FIFO_SIZE];
+    int total = 0;
+
+    spinlock_acquire(&serial_lock);
+    insb(SERIAL_COM1_PORT + SERIAL_REGISTER_INTERRUPT_IDENTIFICATION);
+    while (total < SERIAL_FIFO_SIZE && (insb(SERIAL_COM1_PORT + SERIAL_REGISTER_LINE_STATUS) & SERIAL_LINE_STATUS_DATA_READY))
+    {
+        received[total++] = insb(SERIAL_COM1_PORT + SERIAL_REGISTER_DATA);
+    }
+    serial_fill_fifo();
+    spinlock_release(&serial_lock);
+
+    // The keyboard has a lock of its own, keep it out of serial_lock
+    for (int i = 0; i < total; i++)
+    {
+        serial_receive(received[i]);
+    }
+}
+
+/**
+ * @brief Drain the transmit buffer and take input from the COM1 interrupt from now on, the
+ *        IDT and the interrupt controllers must be set up
+ * 
+ */
+void serial_enable_interrupts()
+{
+    if (!serial_is_present)
+    {
+        return;
+    }
+
+    idt_register_interrupt_callback(BIMBLEOS_IRQ_BASE_INTERRUPT + SERIAL_COM1_IRQ, serial_handle_interrupt);
+    apic_enable_irq(SERIAL_COM1_IRQ);
+
+    spinlock_acquire(&serial_lock);
+    serial_interrupts_enabled = true;
+    outb(SERIAL_COM1_PORT + SERIAL_REGISTER_INTERRUPT_ENABLE, SERIAL_INTERRUPT_DATA_AVAILABLE);
+    serial_fill_fifo();
+    spinlock_release(&serial_lock);
+}
+
+/**
+ * @brief Write raw bytes
+ * 
+ * @param buffer 
+ * @param length 
+ */
+void serial_write(const char *buffer, uint32_t length)
+{
+    if (!serial_is_present)
+    {
+        return;
+    }
+
+    spinlock_acquire(&serial_lock);
+    for (uint32_t i = 0; i < length; i++)
+    {
+        serial_put(buffer[i]);
+    }
+    serial_flush();
+    spinlock_release(&serial_lock);
+}
+
+void serial_print(const char *str)
+{
+    serial_write(str, strlen(str));
+}
+
+/**
+ * @brief Mirror of the screen, line feeds become carriage return and line feed for terminals
+ * 
+ * @param str 
+ * @param length 
+ */
+void serial_log(const char *str, uint32_t length)
+{
+    if (!serial_is_present)
+    {
+        return;
+    }
+
+    spinlock_acquire(&serial_lock);
+    for (uint32_t i = 0; i < length; i++)
+    {
+        if (str[i] == '\n')
+        {
+            serial_put('\r');
+        }
+        serial_put(str[i]);
+    }
+    serial_flush();
+    spinlock_release(&serial_lock);
+}
+
+/**
+ * @brief Start a binary frame of 'length' payload bytes on 'channel'. The port stays locked
+ *        until serial_frame_end, which must follow exactly 'length' bytes of
+ *        serial_frame_write
+ * 
+ * @param channel 
+ * @param length 
+ */
+void serial_frame_begin(uint16_t channel, uint32_t length)
+{
+    struct SerialFrameHeader header;
+    memcpy(header.magic, (void *)SERIAL_FRAME_MAGIC, sizeof(header.magic));
+    header.channel = channel;
+    header.reserved = 0;
+    header.length = length;
+
+    spinlock_acquire(&serial_lock);
+    serial_frame_a = 1;
+    serial_frame_b = 0;
+    for (int i = 0; i < sizeof(header); i++)
+    {
+        serial_put(((char *)&header)[i]);
+    }
+}
+
+void serial_frame_write(const void *data, uint32_t length)
+{
+    const uint8_t *bytes = data;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        serial_frame_a = (serial_frame_a + bytes[i]) % 65521;
+        serial_frame_b = (serial_frame_b + serial_frame_a) % 65521;
+        serial_put(bytes[i]);
+    }
+}
+
+void serial_frame_end()
+{
+    uint32_t checksum = (serial_frame_b << 16) | serial_frame_a;
+    for (int i = 0; i < sizeof(checksum); i++)
+    {
+        serial_put(((char *)&checksum)[i]);
+    }
+    serial_flush();
+    spinlock_release(&serial_lock);
+}
@@ -0,0 +1,57 @@
+#ifndef SERIAL_H
+#define SERIAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SERIAL_COM1_PORT 0x3F8
+#define SERIAL_COM1_IRQ 4
+
+// Register offsets from the port base
+#define SERIAL_REGISTER_DATA 0
+#define SERIAL_REGISTER_INTERRUPT_ENABLE 1
+#define SERIAL_REGISTER_INTERRUPT_IDENTIFICATION 2
+#define SERIAL_REGISTER_FIFO_CONTROL 2
+#define SERIAL_REGISTER_LINE_CONTROL 3
+#define SERIAL_REGISTER_MODEM_CONTROL 4
+#define SERIAL_REGISTER_LINE_STATUS 5
+
+#define SERIAL_INTERRUPT_DATA_AVAILABLE 0x01
+#define SERIAL_INTERRUPT_TRANSMIT_EMPTY 0x02
+#define SERIAL_LINE_CONTROL_DLAB 0x80
+#define SERIAL_LINE_CONTROL_8N1 0x03
+#define SERIAL_LINE_STATUS_DATA_READY 0x01
+#define SERIAL_LINE_STATUS_TRANSMIT_EMPTY 0x20
+#define SERIAL_MODEM_CONTROL_OUT2 0x08      // Connects the UART interrupt line
+#define SERIAL_BAUD_DIVISOR_115200 1
+#define SERIAL_FIFO_SIZE 16
+
+// Binary frames share the port with the text log, the host finds them by the magic and
+// checks them with the Adler-32 of the payload that follows it
+#define SERIAL_FRAME_MAGIC "BOSF"
+
+enum
+{
+    SERIAL_CHANNEL_PROFILE = 1,
+    SERIAL_CHANNEL_TRACE = 2
+};
+
+struct SerialFrameHeader
+{
+    char magic[4];
+    uint16_t channel;
+    uint16_t reserved;
+    uint32_t length;            // Payload bytes, the 32 bit Adler-32 checksum follows them
+} __attribute__((packed));
+
+void serial_init();
+void serial_enable_interrupts();
+bool serial_present();
+void serial_write(const char *buffer, uint32_t length);
+void serial_print(const char *str);
+void serial_log(const char *str, uint32_t length);
+void serial_frame_begin(uint16_t channel, uint32_t length);
+void serial_frame_write(const void *data, uint32_t length);
+void serial_frame_end();
+
+#endif
@@ -0,0 +1,165 @@
+#include "madt.h"
+#include "apic/lapic.h"
+#include "memory/memory.h"
+#include "status.h"
+
+static bool acpi_checksum_valid(void *table, uint32_t length)
+{
+    uint8_t sum = 0;
+    uint8_t *bytes = table;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        sum += bytes[i];
+    }
+
+    return sum == 0;
+}
+
+static struct AcpiRsdp *acpi_search_rsdp(uint32_t start, uint32_t end)
+{
+    // The RSDP is always on a 16 byte boundary
+    for (uint32_t address = start; address < end; address += 16)
+    {
+        struct AcpiRsdp *rsdp = (struct AcpiRsdp *)address;
+        if (memcmp(rsdp->signature, ACPI_RSDP_SIGNATURE, sizeof(rsdp->signature)) == 0 &&
+            acpi_checksum_valid(rsdp, sizeof(struct AcpiRsdp)))
+        {
+            return rsdp;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Find the Root System Description Pointer. It lives either in the first KB of the
+ *        extended BIOS data area or in the BIOS read only area 0xE0000 - 0xFFFFF
+ * 
+ * @return struct AcpiRsdp* 
+ */
+static struct AcpiRsdp *acpi_find_rsdp()
+{
+    uint32_t ebda = ((uint32_t)(*(uint16_t *)0x40E)) << 4;
+    struct AcpiRsdp *rsdp = 0;
+    if (ebda)
+    {
+        rsdp = acpi_search_rsdp(ebda, ebda + 1024);
+    }
+
+    if (!rsdp)
+    {
+        rsdp = acpi_search_rsdp(0xE0000, 0x100000);
+    }
+
+    return rsdp;
+}
+
+static struct AcpiMadt *acpi_find_madt(struct AcpiRsdp *rsdp)
+{
+    struct AcpiSdtHeader *rsdt = (struct AcpiSdtHeader *)rsdp->rsdt_address;
+    if (!acpi_checksum_valid(rsdt, rsdt->length))
+    {
+        return 0;
+    }
+
+    int total_tables = (rsdt->length - sizeof(struct AcpiSdtHeader)) / sizeof(uint32_t);
+    uint32_t *tables = (uint32_t *)(rsdt + 1);
+    for (int i = 0; i < total_tables; i++)
+    {
+        struct AcpiSdtHeader *header = (struct AcpiSdtHeader *)tables[i];
+        if (memcmp(header->signature, ACPI_MADT_SIGNATURE, sizeof(header->signature)) == 0 &&
+            acpi_checksum_valid(header, header->length))
+        {
+            return (struct AcpiMadt *)header;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Collect local APICs (one per cpu), the IO APIC and the ISA IRQ overrides from the
+ *        ACPI Multiple APIC Description Table
+ * 
+ * @param info 
+ * @return int 
+ */
+int madt_parse(struct MadtInfo *info)
+{
+    int res = 0;
+    memset(info, 0, sizeof(struct MadtInfo));
+    info->lapic_address = LAPIC_DEFAULT_ADDRESS;
+    for (int i = 0; i < MADT_TOTAL_ISA_IRQS; i++)
+    {
+        info->isa_irq_gsi[i] = i;
+    }
+
+    struct AcpiRsdp *rsdp = acpi_find_rsdp();
+    if (!rsdp)
+    {
+        res = -EIO;
+        goto out;
+    }
+
+    struct AcpiMadt *madt = acpi_find_madt(rsdp);
+    if (!madt)
+    {
+        res = -EIO;
+        goto out;
+    }
+
+    info->lapic_address = madt->lapic_address;
+
+    uint8_t *entry_ptr = (uint8_t *)(madt + 1);
+    uint8_t *end = (uint8_t *)madt + madt->header.length;
+    while (entry_ptr < end)
+    {
+        struct MadtEntryHeader *entry = (struct MadtEntryHeader *)entry_ptr;
+        if (entry->length == 0)
+        {
+            break;
+        }
+
+        switch (entry->type)
+        {
+        case MADT_ENTRY_LOCAL_APIC:
+        {
+            struct MadtLocalApic *lapic = (struct MadtLocalApic *)entry;
+            if ((lapic->flags & MADT_LOCAL_APIC_ENABLED) && info->total_cpus < BIMBLEOS_MAX_CPUS)
+            {
+                info->apic_ids[info->total_cpus++] = lapic->apic_id;
+            }
+        }
+        break;
+
+        case MADT_ENTRY_IO_APIC:
+        {
+            // Only the first IO APIC is used, it covers the ISA IRQs on all PC chipsets
+            struct MadtIoApic *ioapic = (struct MadtIoApic *)entry;
+            if (!info->ioapic_address)
+            {
+                info->ioapic_address = ioapic->ioapic_address;
+                info->ioapic_gsi_base = ioapic->gsi_base;
+            }
+        }
+        break;
+
+        case MADT_ENTRY_INTERRUPT_OVERRIDE:
+        {
+            struct MadtInterruptOverride *override = (struct MadtInterruptOverride *)entry;
+            if (override->source < MADT_TOTAL_ISA_IRQS)
+            {
+                info->isa_irq_gsi[override->source] = override->gsi;
+            }
+        }
+        break;
+        }
+
+        entry_ptr += entry->length;
+    }
+
+    info->found = true;
+
+out:
+    return res;
+}
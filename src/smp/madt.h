@@ -0,0 +1,97 @@
+#ifndef MADT_H
+#define MADT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#define ACPI_RSDP_SIGNATURE "RSD PTR "
+#define ACPI_MADT_SIGNATURE "APIC"
+
+#define MADT_ENTRY_LOCAL_APIC 0
+#define MADT_ENTRY_IO_APIC 1
+#define MADT_ENTRY_INTERRUPT_OVERRIDE 2
+
+#define MADT_LOCAL_APIC_ENABLED 0x01
+#define MADT_TOTAL_ISA_IRQS 16
+
+struct AcpiRsdp
+{
+    char signature[8];
+    uint8_t checksum;
+    char oem_id[6];
+    uint8_t revision;
+    uint32_t rsdt_address;
+} __attribute__((packed));
+
+struct AcpiSdtHeader
+{
+    char signature[4];
+    uint32_t length;
+    uint8_t revision;
+    uint8_t checksum;
+    char oem_id[6];
+    char oem_table_id[8];
+    uint32_t oem_revision;
+    uint32_t creator_id;
+    uint32_t creator_revision;
+} __attribute__((packed));
+
+struct AcpiMadt
+{
+    struct AcpiSdtHeader header;
+    uint32_t lapic_address;
+    uint32_t flags;
+} __attribute__((packed));
+
+struct MadtEntryHeader
+{
+    uint8_t type;
+    uint8_t length;
+} __attribute__((packed));
+
+struct MadtLocalApic
+{
+    struct MadtEntryHeader header;
+    uint8_t processor_id;
+    uint8_t apic_id;
+    uint32_t flags;
+} __attribute__((packed));
+
+struct MadtIoApic
+{
+    struct MadtEntryHeader header;
+    uint8_t ioapic_id;
+    uint8_t reserved;
+    uint32_t ioapic_address;
+    uint32_t gsi_base;
+} __attribute__((packed));
+
+struct MadtInterruptOverride
+{
+    struct MadtEntryHeader header;
+    uint8_t bus;
+    uint8_t source;     // ISA IRQ
+    uint32_t gsi;       // Global system interrupt it is wired to
+    uint16_t flags;
+} __attribute__((packed));
+
+// What the kernel needs to know from the MADT
+struct MadtInfo
+{
+    bool found;
+    uint32_t lapic_address;
+
+    int total_cpus;
+    uint8_t apic_ids[BIMBLEOS_MAX_CPUS];
+
+    uint32_t ioapic_address;
+    uint32_t ioapic_gsi_base;
+
+    // Global system interrupt of each ISA IRQ after applying the interrupt source overrides
+    uint32_t isa_irq_gsi[MADT_TOTAL_ISA_IRQS];
+};
+
+int madt_parse(struct MadtInfo *info);
+
+#endif
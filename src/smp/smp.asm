@@ -0,0 +1,77 @@
+[BITS 32]
+
+section .asm
+
+global smp_idle
+global smp_trampoline_start
+global smp_trampoline_data
+global smp_trampoline_end
+
+CODE_SEG equ 0x08
+DATA_SEG equ 0x10
+TRAMPOLINE_ADDRESS equ 0x1000       ; Must match BIMBLEOS_SMP_TRAMPOLINE_ADDRESS in config.h
+
+; Address of a trampoline label once the trampoline has been copied to TRAMPOLINE_ADDRESS
+%define TRAMPOLINE(label) (label - smp_trampoline_start + TRAMPOLINE_ADDRESS)
+
+
+; void smp_idle(uint32_t stack_top)
+; Drop whatever is on the current stack and halt with interrupts enabled until the scheduler
+; hands us a task
+smp_idle:
+    mov eax, [esp+4]
+    mov esp, eax
+    mov ebp, eax
+    sti
+.halt:
+    hlt
+    jmp .halt
+
+
+; Application processors start executing here in real mode after the startup IPI. smp_init
+; copies everything between smp_trampoline_start and smp_trampoline_end below 1MB, so every
+; memory reference must go through TRAMPOLINE()
+[BITS 16]
+smp_trampoline_start:
+    cli
+    cld
+    xor ax, ax
+    mov ds, ax
+
+    ; Load the kernel GDT directly, o32 so the full 32 bit base is used
+    o32 lgdt [TRAMPOLINE(smp_trampoline_data)]
+    mov eax, cr0
+    or eax, 0x1
+    mov cr0, eax
+    jmp dword CODE_SEG:TRAMPOLINE(smp_trampoline_protected)
+
+[BITS 32]
+smp_trampoline_protected:
+    mov ax, DATA_SEG
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax
+    mov ss, ax
+
+    ; Share the kernel page directory with the boot processor
+    mov eax, [TRAMPOLINE(smp_trampoline_data) + 6]
+    mov cr3, eax
+    mov eax, cr0
+    or eax, 0x80000000
+    mov cr0, eax
+
+    mov esp, [TRAMPOLINE(smp_trampoline_data) + 10]
+    mov ebp, esp
+    mov eax, [TRAMPOLINE(smp_trampoline_data) + 14]
+    call eax                ; smp_ap_main never returns
+    jmp $
+
+; Filled by smp_init before every startup IPI, layout of struct SmpTrampolineData
+smp_trampoline_data:
+    dw 0x00                 ; GDT limit
+    dd 0x00                 ; GDT base
+    dd 0x00                 ; Page directory
+    dd 0x00                 ; Kernel stack top
+    dd 0x00                 ; Entry point
+smp_trampoline_end:
@@ -0,0 +1,203 @@
+#include "smp.h"
+#include "madt.h"
+#include "kernel.h"
+#include "status.h"
+#include "apic/apic.h"
+#include "apic/lapic.h"
+#include "cpu/cpu.h"
+#include "cpu/fpu.h"
+#include "timer/pit.h"
+#include "gdt/gdt.h"
+#include "idt/idt.h"
+#include "memory/memory.h"
+#include "memory/heap/kheap.h"
+#include "memory/paging/paging.h"
+
+extern struct Gdt gdt_real[BIMBLEOS_TOTAL_GDT_SEGMENT];
+
+extern uint8_t smp_trampoline_start[];
+extern uint8_t smp_trampoline_data[];
+extern uint8_t smp_trampoline_end[];
+
+static struct Cpu cpus[BIMBLEOS_MAX_CPUS];
+static int total_cpus = 1;
+
+// Local APIC id to index in 'cpus'
+static uint8_t apic_id_to_cpu[256];
+
+// Until the local APIC is known every caller is the boot processor
+static bool smp_enabled = false;
+
+static struct MadtInfo madt_info;
+
+
+/**
+ * @brief Return the cpu executing this code
+ * 
+ * @return struct Cpu* 
+ */
+struct Cpu *cpu_current()
+{
+    if (!smp_enabled)
+    {
+        return &cpus[0];
+    }
+
+    return &cpus[apic_id_to_cpu[lapic_id()]];
+}
+
+struct Cpu *cpu_get(int id)
+{
+    if (id < 0 || id >= BIMBLEOS_MAX_CPUS)
+    {
+        return 0;
+    }
+
+    return &cpus[id];
+}
+
+int smp_total_cpus()
+{
+    return total_cpus;
+}
+
+/**
+ * @brief Setup and load the Task State Segment of a cpu, its descriptor lives at
+ *        BIMBLEOS_GDT_TSS_INDEX + cpu id in the GDT
+ * 
+ * @param cpu 
+ * @param kernel_stack_top 
+ */
+void cpu_load_tss(struct Cpu *cpu, uint32_t kernel_stack_top)
+{
+    memset(&cpu->tss, 0x00, sizeof(cpu->tss));
+    cpu->kernel_stack_top = kernel_stack_top;
+    cpu->tss.esp0 = kernel_stack_top;   // Processor will set the kernel stack to this address when switching from user land to kernel land
+    cpu->tss.ss0 = KERNAL_DATA_SELECTOR;
+    tss_load((BIMBLEOS_GDT_TSS_INDEX + cpu->id) * sizeof(struct Gdt));
+}
+
+/**
+ * @brief C entry of application processors, called by the trampoline on the cpu's kernel stack
+ * 
+ */
+static void smp_ap_main()
+{
+    struct Cpu *cpu = cpu_current();
+
+    idt_load_current();
+    cpu_load_tss(cpu, cpu->kernel_stack_top);
+    idt_sysenter_init(cpu->kernel_stack_top);
+    cpu_enable_global_pages();
+    fpu_enable();
+    lapic_init();
+    apic_timer_start();
+
+    cpu->online = true;
+
+    // Work arrives through task_next on the next timer tick
+    smp_idle(cpu->kernel_stack_top);
+}
+
+/**
+ * @brief Wake up an application processor with the INIT-SIPI-SIPI sequence and wait for it
+ * 
+ * @param cpu 
+ * @param kernel_directory 
+ * @return int 
+ */
+static int smp_start_ap(struct Cpu *cpu, struct PageDirectory_4GB *kernel_directory)
+{
+    int res = 0;
+    void *stack = kzalloc(BIMBLEOS_KERNEL_STACK_SIZE);
+    if (!stack)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    cpu->kernel_stack_top = (uint32_t)stack + BIMBLEOS_KERNEL_STACK_SIZE;
+
+    memcpy((void *)BIMBLEOS_SMP_TRAMPOLINE_ADDRESS, smp_trampoline_start, smp_trampoline_end - smp_trampoline_start);
+    struct SmpTrampolineData *data = (struct SmpTrampolineData *)(BIMBLEOS_SMP_TRAMPOLINE_ADDRESS + (smp_trampoline_data - smp_trampoline_start));
+    data->gdt_limit = sizeof(struct Gdt) * BIMBLEOS_TOTAL_GDT_SEGMENT - 1;
+    data->gdt_base = (uint32_t)gdt_real;
+    data->page_directory = (uint32_t)paging_get_directory(kernel_directory);
+    data->stack = cpu->kernel_stack_top;
+    data->entry = (uint32_t)smp_ap_main;
+
+    lapic_send_init(cpu->apic_id);
+    pit_delay_ms(10);
+
+    for (int i = 0; i < 2 && !cpu->online; i++)
+    {
+        lapic_send_startup(cpu->apic_id, BIMBLEOS_SMP_TRAMPOLINE_ADDRESS / PAGING_PAGE_SIZE);
+        pit_delay_us(200);
+    }
+
+    // Give it 100ms to show up
+    for (int i = 0; i < 100 && !cpu->online; i++)
+    {
+        pit_delay_ms(1);
+    }
+
+    if (!cpu->online)
+    {
+        res = -EIO;
+        kfree(stack);
+    }
+
+out:
+    return res;
+}
+
+/**
+ * @brief Discover the cpus from the ACPI MADT, move interrupt delivery to the APICs and bring
+ *        every application processor online. Without a MADT describing an IO APIC the kernel
+ *        keeps running uniprocessor on the 8259 PIC, with PIT channel 0 ticking at
+ *        BIMBLEOS_TIMER_HZ in place of the local APIC timer.
+ * 
+ * @param kernel_directory 
+ */
+void smp_init(struct PageDirectory_4GB *kernel_directory)
+{
+    cpus[0].online = true;
+
+    if (madt_parse(&madt_info) < 0 || madt_info.total_cpus == 0 || !madt_info.ioapic_address)
+    {
+        // Everything timed in ticks assumes BIMBLEOS_TIMER_HZ, not the BIOS rate
+        pit_start(BIMBLEOS_TIMER_HZ);
+        return;
+    }
+
+    apic_init(kernel_directory, &madt_info);
+
+    uint8_t bsp_apic_id = lapic_id();
+    cpus[0].apic_id = bsp_apic_id;
+    apic_id_to_cpu[bsp_apic_id] = 0;
+    smp_enabled = true;
+
+    for (int i = 0; i < madt_info.total_cpus; i++)
+    {
+        uint8_t apic_id = madt_info.apic_ids[i];
+        if (apic_id == bsp_apic_id)
+        {
+            continue;
+        }
+
+        struct Cpu *cpu = &cpus[total_cpus];
+        cpu->id = total_cpus;
+        cpu->apic_id = apic_id;
+        apic_id_to_cpu[apic_id] = cpu->id;
+
+        if (smp_start_ap(cpu, kernel_directory) < 0)
+        {
+            print("SMP: Application processor did not start\n");
+            // The next processor reuses its slot, unmapped ids read 0 like before
+            apic_id_to_cpu[apic_id] = 0;
+            continue;
+        }
+
+        total_cpus++;
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef SMP_H
+#define SMP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+#include "task/task.h"
+#include "task/tss.h"
+
+struct PageDirectory_4GB;
+
+// Everything the kernel keeps per processor
+struct Cpu
+{
+    // Index in the cpu table, cpu 0 is the boot processor
+    int id;
+    uint8_t apic_id;
+    volatile bool online;
+
+    // The task this cpu is running, 0 while idle
+    struct Task *current_task;
+
+    // Tasks ready to run on this cpu
+    struct RunQueue run_queue;
+
+    // Page directory in CR3, 0 until this cpu switches for the first time
+    struct PageDirectory_4GB *page_directory;
+
+    // The task whose state is in this cpu's FPU registers, it is always the running task
+    struct Task *fpu_owner;
+
+    // Set while the interrupt being serviced is timed, see idt/stats.c
+    bool interrupt_timed;
+    int interrupt;
+    uint64_t interrupt_start;
+
+    struct Tss tss;
+
+    // Loaded into tss.esp0, an idle cpu also halts on this stack
+    uint32_t kernel_stack_top;
+};
+
+// Layout of smp_trampoline_data in smp.asm
+struct SmpTrampolineData
+{
+    uint16_t gdt_limit;
+    uint32_t gdt_base;
+    uint32_t page_directory;
+    uint32_t stack;
+    uint32_t entry;
+} __attribute__((packed));
+
+struct Cpu *cpu_current();
+struct Cpu *cpu_get(int id);
+void cpu_load_tss(struct Cpu *cpu, uint32_t kernel_stack_top);
+int smp_total_cpus();
+void smp_init(struct PageDirectory_4GB *kernel_directory);
+void smp_idle(uint32_t stack_top);     // Never returns
+
+#endif
@@ -0,0 +1,39 @@
+[BITS 32]
+
+section .asm
+
+global spinlock_acquire
+global spinlock_release
+global spinlock_try_acquire
+
+; void spinlock_acquire(struct Spinlock* lock)
+spinlock_acquire:
+    mov edx, [esp+4]
+.try:
+    mov eax, 1
+    xchg eax, [edx]         ; Atomically take the lock
+    test eax, eax
+    jz .done
+
+.spin:
+    pause                   ; Somebody else owns it, wait without hammering the bus
+    cmp dword [edx], 0
+    jne .spin
+    jmp .try
+
+.done:
+    ret
+
+; void spinlock_release(struct Spinlock* lock)
+spinlock_release:
+    mov edx, [esp+4]
+    mov dword [edx], 0
+    ret
+
+; int spinlock_try_acquire(struct Spinlock* lock)
+spinlock_try_acquire:
+    mov edx, [esp+4]
+    mov eax, 1
+    xchg eax, [edx]
+    xor eax, 1              ; Old value 0 means we own the lock now
+    ret
@@ -0,0 +1,19 @@
+#ifndef SPINLOCK_H
+#define SPINLOCK_H
+
+#include <stdint.h>
+
+// Kernel code always runs with interrupts disabled (all gates are interrupt gates), so a plain
+// busy-waiting lock is enough to serialize cpus.
+struct Spinlock
+{
+    volatile uint32_t locked;
+};
+
+#define SPINLOCK_INIT {.locked = 0}
+
+void spinlock_acquire(struct Spinlock *lock);
+void spinlock_release(struct Spinlock *lock);
+int spinlock_try_acquire(struct Spinlock *lock);    // Returns 1 if the lock was taken
+
+#endif
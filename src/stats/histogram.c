@@ -0,0 +1,81 @@
+#include "histogram.h"
+
+void histogram_add(struct Histogram *histogram, uint32_t value)
+{
+    int bucket = value ? 31 - __builtin_clz(value) : 0;
+
+    spinlock_acquire(&histogram->lock);
+    histogram->samples++;
+    histogram->total += value;
+    if (value > histogram->max)
+    {
+        histogram->max = value;
+    }
+    histogram->buckets[bucket]++;
+    spinlock_release(&histogram->lock);
+}
+
+/**
+ * @brief 64 by 32 bit division. The kernel is not linked against libgcc, so this is plain long
+ *        division. Saturates at 0xFFFFFFFF
+ * 
+ * @param dividend 
+ * @param divisor 
+ * @return uint32_t 
+ */
+uint32_t histogram_divide(uint64_t dividend, uint32_t divisor)
+{
+    if (!divisor)
+    {
+        return 0;
+    }
+
+    uint64_t quotient = 0;
+    uint64_t remainder = 0;
+    for (int i = 63; i >= 0; i--)
+    {
+        remainder = (remainder << 1) | ((dividend >> i) & 1);
+        if (remainder >= divisor)
+        {
+            remainder -= divisor;
+            quotient |= (uint64_t)1 << i;
+        }
+    }
+
+    return quotient > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)quotient;
+}
+
+uint32_t histogram_mean(struct Histogram *histogram)
+{
+    return histogram_divide(histogram->total, histogram->samples);
+}
+
+/**
+ * @brief Upper bound of the bucket holding the given percentile, never above the largest sample
+ * 
+ * @param histogram 
+ * @param percent 1 to 100
+ * @return uint32_t 
+ */
+uint32_t histogram_percentile(struct Histogram *histogram, int percent)
+{
+    if (!histogram->samples)
+    {
+        return 0;
+    }
+
+    // Rank of the sample we are after, rounded up
+    uint32_t rank = histogram_divide((uint64_t)histogram->samples * percent + 99, 100);
+    uint32_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_TOTAL_BUCKETS; i++)
+    {
+        seen += histogram->buckets[i];
+        if (seen >= rank)
+        {
+            uint32_t bound = i == 31 ? 0xFFFFFFFF : ((uint32_t)2 << i) - 1;
+            return bound < histogram->max ? bound : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
@@ -0,0 +1,24 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include "smp/spinlock.h"
+
+#define HISTOGRAM_TOTAL_BUCKETS 32
+
+// Cycle counts bucketed by power of two, bucket i holds samples in [2^i, 2^(i+1))
+struct Histogram
+{
+    struct Spinlock lock;
+    uint32_t samples;
+    uint64_t total;
+    uint32_t max;
+    uint32_t buckets[HISTOGRAM_TOTAL_BUCKETS];
+};
+
+void histogram_add(struct Histogram *histogram, uint32_t value);
+uint32_t histogram_mean(struct Histogram *histogram);
+uint32_t histogram_percentile(struct Histogram *histogram, int percent);
+uint32_t histogram_divide(uint64_t dividend, uint32_t divisor);
+
+#endif
@@ -11,4 +11,5 @@
 #define EUNIMP 7
 #define EISTKN 8
 #define EINFORMAT 9
+#define EBUSY 10
 #endif
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "ioring.h"
+#include "process.h"
+#include "task.h"
+#include "kernel.h"
+#include "status.h"
+#include "keyboard/keyboard.h"
+
+/**
+ * @brief Map a ring into the process, or return the one it already has. The ring is a process
+ *        allocation, so it is released with the process.
+ * 
+ * @param process 
+ * @return struct IoRing* The ring, at the same address for the process and the kernel
+ */
+struct IoRing* io_ring_setup(struct Process* process)
+{
+    if (!process->io_ring)
+    {
+        process->io_ring = process_malloc(process, sizeof(struct IoRing));
+    }
+
+    return process->io_ring;
+}
+
+static int io_ring_execute(struct Process* process, struct IoRingSubmission* submission)
+{
+    int res = 0;
+    switch (submission->operation)
+    {
+        case IORING_OP_PUTCHAR:
+            terminal_writechar((char)submission->argument0, 15);
+        break;
+
+        case IORING_OP_PRINT:
+        {
+            char buf[1024];
+            res = strncpy_from_user(process->task, buf, (const char*)submission->argument0, sizeof(buf));
+            if (res >= 0)
+            {
+                terminal_print(buf, res);
+            }
+        }
+        break;
+
+        case IORING_OP_WRITE:
+            res = terminal_print_from_user(process->task, (const char*)submission->argument0, submission->argument1);
+        break;
+
+        case IORING_OP_GETKEY:
+            res = keyboard_pop();
+        break;
+
+        default:
+            res = -EINVARG;
+    }
+
+    return res;
+}
+
+/**
+ * @brief Run every queued submission of the process that has room in the completion queue.
+ *        The ring is only touched on behalf of its own running task, so no lock is needed.
+ * 
+ * @param process 
+ * @return int Number of submissions consumed
+ */
+int io_ring_enter(struct Process* process)
+{
+    struct IoRing* ring = process->io_ring;
+    if (!ring)
+    {
+        return -EINVARG;
+    }
+
+    int total = 0;
+    while (total < IORING_MAX_ENTER_BATCH && ring->submission_head != ring->submission_tail)
+    {
+        // Completions still unread by user land
+        if (ring->completion_tail - ring->completion_head >= IORING_TOTAL_ENTRIES)
+        {
+            break;
+        }
+
+        // Take a copy, user land may rewrite the entry at any time
+        struct IoRingSubmission submission = ring->submissions[ring->submission_head % IORING_TOTAL_ENTRIES];
+        ring->submission_head++;
+
+        struct IoRingCompletion* completion = &ring->completions[ring->completion_tail % IORING_TOTAL_ENTRIES];
+        completion->user_data = submission.user_data;
+        completion->result = io_ring_execute(process, &submission);
+        ring->completion_tail++;
+
+        total++;
+    }
+
+    return total;
+}
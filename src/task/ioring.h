@@ -0,0 +1,50 @@
+#ifndef IORING_H
+#define IORING_H
+
+#include <stdint.h>
+
+#define IORING_TOTAL_ENTRIES 64             // Power of two, head and tail run freely and wrap
+#define IORING_MAX_ENTER_BATCH IORING_TOTAL_ENTRIES
+
+enum IoRingOperation
+{
+    IORING_OP_PUTCHAR,                      // argument0: character
+    IORING_OP_PRINT,                        // argument0: user pointer to a null terminated string
+    IORING_OP_WRITE,                        // argument0: user pointer, argument1: length, result: characters written, at most BIMBLEOS_MAX_USER_FILE_WRITE
+    IORING_OP_GETKEY                        // result: key or 0 when none is waiting
+};
+
+// One queued operation, written by user land
+struct IoRingSubmission
+{
+    uint32_t operation;
+    uint32_t argument0;
+    uint32_t argument1;
+    uint32_t user_data;                     // Copied to the completion untouched
+};
+
+// Result of one operation, written by the kernel
+struct IoRingCompletion
+{
+    uint32_t user_data;
+    int32_t result;
+};
+
+// Shared between a process and the kernel. Must match the definition in the stdlib
+struct IoRing
+{
+    volatile uint32_t submission_head;      // Advanced by the kernel
+    volatile uint32_t submission_tail;      // Advanced by user land
+    volatile uint32_t completion_head;      // Advanced by user land
+    volatile uint32_t completion_tail;      // Advanced by the kernel
+
+    struct IoRingSubmission submissions[IORING_TOTAL_ENTRIES];
+    struct IoRingCompletion completions[IORING_TOTAL_ENTRIES];
+};
+
+struct Process;
+
+struct IoRing* io_ring_setup(struct Process* process);
+int io_ring_enter(struct Process* process);
+
+#endif
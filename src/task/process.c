@@ -8,13 +8,22 @@
 #include "memory/paging/paging.h"
 #include "memory/heap/kheap.h"
 #include "loader/format/elfloader.h"
+#include "smp/spinlock.h"
+#include "vdso.h"
 
 
-// The current process that is running
+// The foreground process, it receives keyboard input. Each cpu's running task is kept per cpu
 struct Process* current_process = 0;
 
 static struct Process* processes[BIMBLEOS_MAX_PROCESSES] = {};
 
+// Protects 'processes' and 'current_process'
+static struct Spinlock process_lock = SPINLOCK_INIT;
+
+// Program last loaded into each process slot, kept after the process ends for the profiler
+// and trace tools that map process ids of old samples to programs
+static char process_names[BIMBLEOS_MAX_PROCESSES][BIMBLEOS_MAX_PATH];
+
 static void process_init(struct Process* process)
 {
     memset(process, 0, sizeof(struct Process));
@@ -41,6 +50,41 @@ struct Process* process_get(int process_id)
     return processes[process_id];
 }
 
+/**
+ * @brief Number of loaded processes. Reads without the lock, the result may be stale
+ * 
+ * @return int 
+ */
+int process_total()
+{
+    int total = 0;
+    for (int i = 0; i < BIMBLEOS_MAX_PROCESSES; i++)
+    {
+        if (processes[i])
+        {
+            total++;
+        }
+    }
+
+    return total;
+}
+
+/**
+ * @brief Program last loaded with the given process id, empty if there never was one
+ * 
+ * @param process_id 
+ * @return const char* 
+ */
+const char* process_name(int process_id)
+{
+    if (process_id < 0 || process_id >= BIMBLEOS_MAX_PROCESSES)
+    {
+        return "";
+    }
+
+    return process_names[process_id];
+}
+
 int process_switch(struct Process* process)
 {
     current_process = process;
@@ -51,7 +95,7 @@ static int process_load_binary(const char* filename, struct Process* process)
 {
     int res = 0;
     int fd = fopen(filename, "r");
-    if (!fd)
+    if (fd <= 0)
     {
         res = -EIO;
         goto out;
@@ -202,6 +246,8 @@ int process_map_memory(struct Process* process)
                  (void*)BIMBLEOS_PROGRAM_VIRTUAL_STACK_ADDRESS_END, process->stack,
                  paging_align_address(process->stack+BIMBLEOS_USER_PROGRAM_STACK_SIZE),
                  PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL | PAGING_IS_WRITEABLE);
+
+    res = vdso_process_map(process);
 out:
     return res;
 }
@@ -244,6 +290,12 @@ int process_load_for_slot(const char* filename, struct Process** process, int pr
     _process->stack = program_stack_ptr;
     _process->id = process_slot;
 
+    res = vdso_process_init(_process);
+    if (res < 0)
+    {
+        goto out;
+    }
+
     // Create a task
     task = task_new(_process);
     if (ERROR_I(task) == 0)
@@ -264,6 +316,7 @@ int process_load_for_slot(const char* filename, struct Process** process, int pr
 
     // Add the process to the array
     processes[process_slot] = _process;
+    strncpy(process_names[process_slot], filename, BIMBLEOS_MAX_PATH);
 
 out:
     if (ISERR(res))
@@ -281,6 +334,7 @@ out:
 int process_load(const char* filename, struct Process** process)
 {
     int res = 0;
+    spinlock_acquire(&process_lock);
     int process_slot = process_get_free_slot();
     if (process_slot < 0)
     {
@@ -290,6 +344,7 @@ int process_load(const char* filename, struct Process** process)
 
     res = process_load_for_slot(filename, process, process_slot);
 out:
+    spinlock_release(&process_lock);
     return res;
 }
 
@@ -433,12 +488,93 @@ void process_switch_to_any()
 
 static void process_unlink(struct Process* process)
 {
+    spinlock_acquire(&process_lock);
     processes[process->id] = 0x00;
 
     if (current_process == process)
     {
         process_switch_to_any();
     }
+    spinlock_release(&process_lock);
+}
+
+/**
+ * @brief Open a file on behalf of the process
+ * 
+ * @param process 
+ * @param filename 
+ * @param mode 
+ * @return int The file descriptor, negative on failure
+ */
+int process_fopen(struct Process* process, const char* filename, const char* mode)
+{
+    int slot = -1;
+    for (int i = 0; i < BIMBLEOS_MAX_PROCESS_FILES; i++)
+    {
+        if (process->files[i] == 0)
+        {
+            slot = i;
+            break;
+        }
+    }
+
+    if (slot < 0)
+    {
+        return -ENOMEM;
+    }
+
+    int fd = fopen(filename, mode);
+    if (fd < 0)
+    {
+        return fd;
+    }
+
+    if (fd == 0)
+    {
+        return -EIO;
+    }
+
+    process->files[slot] = fd;
+    return fd;
+}
+
+bool process_owns_file(struct Process* process, int fd)
+{
+    for (int i = 0; i < BIMBLEOS_MAX_PROCESS_FILES; i++)
+    {
+        if (fd > 0 && process->files[i] == fd)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int process_fclose(struct Process* process, int fd)
+{
+    for (int i = 0; i < BIMBLEOS_MAX_PROCESS_FILES; i++)
+    {
+        if (fd > 0 && process->files[i] == fd)
+        {
+            process->files[i] = 0;
+            return fclose(fd);
+        }
+    }
+
+    return -EINVARG;
+}
+
+static void process_close_files(struct Process* process)
+{
+    for (int i = 0; i < BIMBLEOS_MAX_PROCESS_FILES; i++)
+    {
+        if (process->files[i])
+        {
+            fclose(process->files[i]);
+            process->files[i] = 0;
+        }
+    }
 }
 
 int process_terminate(struct Process* process)
@@ -457,8 +593,11 @@ int process_terminate(struct Process* process)
         goto out;
     }
 
+    process_close_files(process);
+
     // Free the process stack memory.
     kfree(process->stack);
+    vdso_process_free(process);
     // Free the task
     task_free(process->task);
     // Unlink the process from the process array.
@@ -538,7 +677,8 @@ void process_free(struct Process* process, void* ptr)
         return;
     }
 
-    int res = paging_map_to(process->task->page_directory, allocation->ptr, allocation->ptr, paging_align_address(allocation->ptr+allocation->size), 0x00);
+    // Hand the pages back to the kernel, it keeps running on this directory and may reuse the memory
+    int res = paging_map_to(process->task->page_directory, allocation->ptr, allocation->ptr, paging_align_address(allocation->ptr+allocation->size), PAGING_IS_PRESENT | PAGING_IS_WRITEABLE);
     if (res < 0)
     {
         return;
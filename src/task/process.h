@@ -12,6 +12,8 @@
 
 typedef unsigned char PROCESS_FILETYPE;
 
+struct IoRing;
+
 
 struct CommandArgument
 {
@@ -70,16 +72,33 @@ struct Process
 
      // The arguments of the process.
     struct ProcessArguments arguments;
+
+    // Batched system call ring shared with user land, 0 until the process sets one up
+    struct IoRing* io_ring;
+
+    // Kernel page holding the read only data of this process, see vdso.h
+    void* vdso_page;
+
+    // System calls made by the process, mirrored into its vdso page
+    uint32_t syscall_count;
+
+    // File descriptors the process opened, 0 for a free slot. Closed when it terminates
+    int files[BIMBLEOS_MAX_PROCESS_FILES];
 };
 
 
 int process_load_switch(const char* filename, struct Process** process);
 struct Process* process_current();
 struct Process* process_get(int process_id); 
+int process_total();
+const char* process_name(int process_id);
 void* process_malloc(struct Process* process, size_t size);
 void process_free(struct Process* process, void* ptr);
 void process_get_arguments(struct Process* process, int* argc, char*** argv);
 int process_inject_arguments(struct Process* process, struct CommandArgument* root_argument); 
 int process_terminate(struct Process* process);
+int process_fopen(struct Process* process, const char* filename, const char* mode);
+int process_fclose(struct Process* process, int fd);
+bool process_owns_file(struct Process* process, int fd);
 
 #endif
\ No newline at end of file
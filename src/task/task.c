@@ -6,88 +6,361 @@
 #include "string/string.h"
 #include "memory/paging/paging.h"
 #include "memory/heap/kheap.h"
+#include "memory/memory.h"
 #include "idt/idt.h"
+#include "smp/smp.h"
+#include "trace/trace.h"
 
-// The current task that is running
-struct Task *current_task = 0;
 
-// Task linked list
-struct Task *task_tail = 0;
-struct Task *task_head = 0;
+/**
+ * @brief Append a task to the tail of a run queue. Caller must hold the queue lock
+ * 
+ * @param queue 
+ * @param task 
+ */
+static void task_run_queue_push(struct RunQueue *queue, struct Task *task)
+{
+    task->run_queue = queue;
+    task->next = 0;
+    task->prev = queue->tail;
+
+    if (queue->tail)
+    {
+        queue->tail->next = task;
+    }
+    else
+    {
+        queue->head = task;
+    }
+
+    queue->tail = task;
+    queue->total++;
+}
+
+/**
+ * @brief Unlink a task from the run queue holding it. Caller must hold the queue lock
+ * 
+ * @param queue 
+ * @param task 
+ */
+static void task_run_queue_remove(struct RunQueue *queue, struct Task *task)
+{
+    if (task->prev)
+    {
+        task->prev->next = task->next;
+    }
 
+    if (task->next)
+    {
+        task->next->prev = task->prev;
+    }
+
+    if (task == queue->head)
+    {
+        queue->head = task->next;
+    }
+
+    if (task == queue->tail)
+    {
+        queue->tail = task->prev;
+    }
+
+    task->run_queue = 0;
+    task->next = 0;
+    task->prev = 0;
+    queue->total--;
+}
+
+static void task_run_queue_push_locked(struct RunQueue *queue, struct Task *task)
+{
+    spinlock_acquire(&queue->lock);
+    task_run_queue_push(queue, task);
+    spinlock_release(&queue->lock);
+}
+
+/**
+ * @brief Take a task from another cpu. The victim is the cpu with the most ready tasks and we
+ *        steal from its tail, which is the task it would have run last.
+ * 
+ * @param self 
+ * @return struct Task* 
+ */
+static struct Task *task_steal(struct Cpu *self)
+{
+    struct Cpu *victim = 0;
+    for (int i = 0; i < smp_total_cpus(); i++)
+    {
+        struct Cpu *cpu = cpu_get(i);
+        if (cpu == self || !cpu->online)
+        {
+            continue;
+        }
+
+        if (cpu->run_queue.total > 0 && (!victim || cpu->run_queue.total > victim->run_queue.total))
+        {
+            victim = cpu;
+        }
+    }
 
+    if (!victim)
+    {
+        return 0;
+    }
+
+    struct Task *task = 0;
+    spinlock_acquire(&victim->run_queue.lock);
+    // The queue may have been drained since we looked at it
+    if (victim->run_queue.tail)
+    {
+        task = victim->run_queue.tail;
+        task_run_queue_remove(&victim->run_queue, task);
+    }
+    spinlock_release(&victim->run_queue.lock);
+
+    return task;
+}
+
+/**
+ * @brief Pop the next ready task of the calling cpu, stealing one if our queue is empty
+ * 
+ * @return struct Task* 0 if there is nothing to run anywhere
+ */
 struct Task *task_get_next()
 {
-    if (!current_task->next)
+    struct Cpu *cpu = cpu_current();
+    struct Task *task = 0;
+
+    spinlock_acquire(&cpu->run_queue.lock);
+    if (cpu->run_queue.head)
+    {
+        task = cpu->run_queue.head;
+        task_run_queue_remove(&cpu->run_queue, task);
+    }
+    spinlock_release(&cpu->run_queue.lock);
+
+    if (!task)
     {
-        return task_head;
+        task = task_steal(cpu);
     }
 
-    return current_task->next;
+    return task;
+}
+
+/**
+ * @brief Make a task runnable, it is queued on the least loaded cpu
+ * 
+ * @param task 
+ */
+void task_ready(struct Task *task)
+{
+    struct Cpu *target = cpu_current();
+    for (int i = 0; i < smp_total_cpus(); i++)
+    {
+        struct Cpu *cpu = cpu_get(i);
+        if (cpu->online && cpu->run_queue.total < target->run_queue.total)
+        {
+            target = cpu;
+        }
+    }
+
+    task_run_queue_push_locked(&target->run_queue, task);
 }
 
 static void task_list_remove(struct Task *task)
 {
-    if (task->prev)
+    struct RunQueue *queue = task->run_queue;
+    if (queue)
     {
-        task->prev->next = task->next;
+        spinlock_acquire(&queue->lock);
+        // Recheck under the lock, the task may have been stolen in between
+        if (task->run_queue == queue)
+        {
+            task_run_queue_remove(queue, task);
+        }
+        spinlock_release(&queue->lock);
     }
 
-    if (task == task_head)
+    struct Cpu *cpu = cpu_current();
+    if (task == cpu->current_task)
     {
-        task_head = task->next;
+        cpu->current_task = 0;
     }
+}
 
-    if (task == task_tail)
+/**
+ * @brief Find the kernel address of a user land byte of 'task' by walking its page tables.
+ *        Physical memory is identity mapped for the kernel, so no page directory switch is needed.
+ * 
+ * @param task 
+ * @param virtual 
+ * @param write The access writes to user memory
+ * @return void* 0 if user land of the task may not access the page
+ */
+static void* task_user_to_kernel(struct Task* task, uint32_t virtual, bool write)
+{
+    uint32_t entry = paging_get(task->page_directory->directoryEntry, paging_align_to_lower_page((void*)virtual));
+    if (!(entry & PAGING_IS_PRESENT) || !(entry & PAGING_ACCESS_FROM_ALL))
     {
-        task_tail = task->prev;
+        return 0;
     }
 
-    if (task == current_task)
+    if (write && !(entry & PAGING_IS_WRITEABLE))
     {
-        current_task = task_get_next();
+        return 0;
     }
+
+    return (void*)((entry & 0xfffff000) + (virtual % PAGING_PAGE_SIZE));
 }
 
-int copy_string_from_task(struct Task* task, void* virtual, void* phys, int max)
+/**
+ * @brief Copy between kernel memory and user memory of 'task' one page at a time
+ * 
+ * @param task 
+ * @param kernel 
+ * @param user 
+ * @param size 
+ * @param to_user Copy direction
+ * @return int 
+ */
+static int task_copy_user(struct Task* task, void* kernel, uint32_t user, uint32_t size, bool to_user)
 {
-    if (max >= PAGING_PAGE_SIZE)
+    int res = 0;
+    if (user + size < user)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    while (size)
     {
-        return -EINVARG;
+        void* user_kernel = task_user_to_kernel(task, user, to_user);
+        if (!user_kernel)
+        {
+            res = -EINVARG;
+            goto out;
+        }
+
+        uint32_t chunk = PAGING_PAGE_SIZE - (user % PAGING_PAGE_SIZE);
+        if (chunk > size)
+        {
+            chunk = size;
+        }
+
+        if (to_user)
+        {
+            memcpy(user_kernel, kernel, chunk);
+        }
+        else
+        {
+            memcpy(kernel, user_kernel, chunk);
+        }
+
+        kernel += chunk;
+        user += chunk;
+        size -= chunk;
     }
 
+out:
+    return res;
+}
+
+/**
+ * @brief Copy 'size' bytes from a user land pointer of 'task' into kernel memory. Fails if any
+ *        page of the range is not accessible to the task, the kernel buffer may then be partially
+ *        written.
+ * 
+ * @param task 
+ * @param kernel 
+ * @param user 
+ * @param size 
+ * @return int 
+ */
+int copy_from_user(struct Task* task, void* kernel, const void* user, uint32_t size)
+{
+    return task_copy_user(task, kernel, (uint32_t)user, size, false);
+}
+
+/**
+ * @brief Copy 'size' bytes of kernel memory to a user land pointer of 'task'. Every page of the
+ *        range must be writeable by the task.
+ * 
+ * @param task 
+ * @param user 
+ * @param kernel 
+ * @param size 
+ * @return int 
+ */
+int copy_to_user(struct Task* task, void* user, const void* kernel, uint32_t size)
+{
+    return task_copy_user(task, (void*)kernel, (uint32_t)user, size, true);
+}
+
+/**
+ * @brief Copy a null terminated string from user land of 'task'. At most max - 1 characters
+ *        are copied, 'kernel' is always terminated.
+ * 
+ * @param task 
+ * @param kernel 
+ * @param user 
+ * @param max Size of the kernel buffer
+ * @return int Length of the copied string
+ */
+int strncpy_from_user(struct Task* task, char* kernel, const char* user, int max)
+{
     int res = 0;
-    char* tmp = kzalloc(max);
-    if (!tmp)
+    if (max <= 0)
     {
-        res = -ENOMEM;
+        res = -EINVARG;
         goto out;
     }
 
-    uint32_t* task_directory = task->page_directory->directoryEntry;
-    uint32_t old_entry = paging_get(task_directory, tmp);
-    paging_map(task->page_directory, tmp, tmp, PAGING_IS_WRITEABLE | PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL);
-    paging_switch(task->page_directory);
-    strncpy(tmp, virtual, max);
-    kernel_page();
-
-    res = paging_set(task_directory, tmp, old_entry);
-    if (res < 0)
+    uint32_t virtual = (uint32_t)user;
+    int i = 0;
+    while (i < max - 1)
     {
-        res = -EIO;
-        goto out_free;
+        char* page = task_user_to_kernel(task, virtual, false);
+        if (!page)
+        {
+            res = -EINVARG;
+            goto out;
+        }
+
+        // Copy up to the end of this page
+        int chunk = PAGING_PAGE_SIZE - (virtual % PAGING_PAGE_SIZE);
+        for (int j = 0; j < chunk && i < max - 1; j++)
+        {
+            kernel[i] = page[j];
+            if (kernel[i] == 0x00)
+            {
+                res = i;
+                goto out;
+            }
+            i++;
+        }
+
+        virtual += chunk;
     }
 
-    strncpy(phys, tmp, max);
+    kernel[i] = 0x00;
+    res = i;
 
-out_free:
-    kfree(tmp);
 out:
+    if (res < 0)
+    {
+        kernel[0] = 0x00;
+    }
     return res;
 }
 
 int task_free(struct Task *task)
 {
+    // Never free the directory this cpu is running on
+    if (paging_current() == task->page_directory)
+    {
+        kernel_page();
+    }
+
+    fpu_task_free(task);
     paging_free(task->page_directory);
     task_list_remove(task);
 
@@ -100,8 +373,9 @@ int task_init(struct Task *task,struct Process* process)
 {
     memset(task, 0, sizeof(struct Task));
 
-    // Map the entire 4GB address space to its self
-    task->page_directory = paging_new(PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL);
+    // Map the entire 4GB address space to its self, supervisor only. The kernel keeps running on
+    // this directory during interrupts and system calls, user pages are mapped by the process
+    task->page_directory = paging_new(PAGING_IS_PRESENT | PAGING_IS_WRITEABLE);
     if (!task->page_directory)
     {
         return -EIO;
@@ -120,26 +394,39 @@ int task_init(struct Task *task,struct Process* process)
     return 0;
 }
 
+/**
+ * @brief Give the calling cpu its first task, application processors pick theirs up from
+ *        their timer interrupt
+ * 
+ */
 void task_run_first_ever_task()
 {
-    if (!current_task)
+    struct Task *task = task_get_next();
+    if (!task)
     {
         panic("task_run_first_ever_task(): No current task exists!\n");
     }
 
-    task_switch(task_head);
-    task_return(&task_head->registers);
+    task_switch(task);
+    task_return(&task->registers);
 }
 
 /**
- * @brief Switch back to page directory of current running task
+ * @brief Switch back to segments and page directory of current running task
  * 
  * @return int 
  */
 int task_page()
 {
+    struct Task *task = task_current();
+    if (!task)
+    {
+        // Idle cpu, stay on the kernel page directory
+        return 0;
+    }
+
     user_registers();
-    task_switch(current_task);
+    task_switch(task);
     return 0;
 }
 
@@ -151,21 +438,63 @@ int task_page_task(struct Task* task)
 }
 
  
+/**
+ * @brief Put the running task back on this cpu's run queue and run the next ready one. Never
+ *        returns, with nothing to run the cpu idles until its next timer interrupt.
+ * 
+ */
 void task_next()
 {
+    struct Cpu *cpu = cpu_current();
+    if (cpu->current_task)
+    {
+        fpu_task_switch_out(cpu->current_task);
+        // Once queued another cpu may steal the task, end it and free its page directory, so
+        // this cpu must not be running on it anymore
+        kernel_page();
+        task_run_queue_push_locked(&cpu->run_queue, cpu->current_task);
+        cpu->current_task = 0;
+    }
+
     struct Task* next_task = task_get_next();
     if (!next_task)
     {
-        panic("No more tasks!\n");
+        trace_task_switch(TRACE_IDLE_PID);
+        kernel_page();
+        smp_idle(cpu->kernel_stack_top);
     }
 
     task_switch(next_task);
     task_return(&next_task->registers);
 }
 
+/**
+ * @brief Run 'task' on this cpu right away, the current task stays ready on our run queue
+ * 
+ * @param task 
+ */
+void task_yield_to(struct Task *task)
+{
+    struct Cpu *cpu = cpu_current();
+    struct Task *outgoing = cpu->current_task;
+    if (outgoing)
+    {
+        fpu_task_switch_out(outgoing);
+    }
+
+    // Leave the outgoing task's page directory before queueing it, see task_next
+    task_switch(task);
+    if (outgoing)
+    {
+        task_run_queue_push_locked(&cpu->run_queue, outgoing);
+    }
+    task_return(&task->registers);
+}
+
 int task_switch(struct Task *task)
 {
-    current_task = task;
+    trace_task_switch(task->process->id);
+    cpu_current()->current_task = task;
     paging_switch(task->page_directory);
     return 0;
 }
@@ -186,18 +515,6 @@ struct Task *task_new(struct Process* process)
         goto out;
     }
 
-    if (task_head == 0)
-    {
-        task_head = task;
-        task_tail = task;
-        current_task = task;
-        goto out;
-    }
-
-    task_tail->next = task;
-    task->prev = task_tail;
-    task_tail = task;
-
 out:
     if (ISERR(res))
     {
@@ -210,7 +527,7 @@ out:
 
 struct Task *task_current()
 {
-    return current_task;
+    return cpu_current()->current_task;
 }
 
 /**
@@ -234,23 +551,6 @@ void task_save_state(struct Task *task, struct InterruptFrame *frame)
     task->registers.esi = frame->esi;
 }
 
-void* task_get_stack_item(struct Task* task, int index)
-{
-    void* result = 0;
-
-    uint32_t* sp_ptr = (uint32_t*) task->registers.esp;
-
-    // Switch to the given tasks page
-    task_page_task(task);
-
-    result = (void*) sp_ptr[index];
-
-    // Switch back to the kernel page
-    kernel_page();
-
-    return result;
-}
-
 /**
  * @brief Save current task state
  * 
@@ -267,8 +567,3 @@ void task_current_save_state(struct InterruptFrame *frame)
     task_save_state(task, frame);
 }
 
-void* task_virtual_address_to_physical(struct Task* task, void* virtual_address)
-{
-    return paging_get_physical_address(task->page_directory->directoryEntry, virtual_address);
-}
-
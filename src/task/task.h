@@ -3,6 +3,8 @@
 
 #include "config.h"
 #include "memory/paging/paging.h"
+#include "smp/spinlock.h"
+#include "cpu/fpu.h"
 
 
 
@@ -35,17 +37,38 @@ struct Task
     // The registers of the task when the task is not running
     struct Registers registers;
 
-    // The next task in the linked list
+    // The run queue holding this task, 0 while the task is running or not ready
+    struct RunQueue *run_queue;
+
+    // The next task in the run queue
     struct Task *next;
 
-    // Previous task in the linked list
+    // Previous task in the run queue
     struct Task *prev;
+
+    // Set once the task executed its first FPU or SSE instruction
+    bool fpu_used;
+
+    // FPU and SSE registers while the task does not own the FPU of a cpu
+    struct FpuState fpu_state;
+};
+
+// Tasks ready to run on one cpu
+struct RunQueue
+{
+    struct Spinlock lock;
+    struct Task *head;
+    struct Task *tail;
+    int total;
 };
 
+struct Process;
 struct Task *task_get_next();
 int task_free(struct Task *);
-struct Task *task_new();
+struct Task *task_new(struct Process *);
 struct Task *task_current();
+void task_ready(struct Task *);
+void task_yield_to(struct Task *);
 void restore_general_purpose_registers(struct Registers *);
 void task_return(struct Registers *); // Drops us on userland
 int task_page();
@@ -55,9 +78,9 @@ void task_run_first_ever_task();
 void user_registers();
 void task_save_state(struct Task *, struct InterruptFrame *);
 void task_current_save_state(struct InterruptFrame *);
-int copy_string_from_task(struct Task* task, void* virtual, void* phys, int max);
-void* task_get_stack_item(struct Task* task, int index);
-void* task_virtual_address_to_physical(struct Task* task, void* virtual_address);
+int copy_from_user(struct Task* task, void* kernel, const void* user, uint32_t size);
+int copy_to_user(struct Task* task, void* user, const void* kernel, uint32_t size);
+int strncpy_from_user(struct Task* task, char* kernel, const char* user, int max);
 void task_next();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "vdso.h"
+#include "process.h"
+#include "config.h"
+#include "status.h"
+#include "memory/heap/kheap.h"
+#include "memory/paging/paging.h"
+#include "cpu/cpu.h"
+
+// Shared by every process, written only by the boot cpu's timer tick. The tick runs at
+// BIMBLEOS_TIMER_HZ on the local APIC timer and on the PIT fallback alike
+static struct VdsoData *vdso_data = 0;
+
+int vdso_init()
+{
+    vdso_data = kzalloc(PAGING_PAGE_SIZE);
+    if (!vdso_data)
+    {
+        return -ENOMEM;
+    }
+
+    vdso_data->ticks_per_second = BIMBLEOS_TIMER_HZ;
+
+    // The same check idt_sysenter_init makes before setting up the MSRs
+    if (cpu_supports_features(CPUID_FEATURE_EDX_SEP))
+    {
+        vdso_data->features |= VDSO_FEATURE_SYSENTER;
+    }
+    return 0;
+}
+
+/**
+ * @brief Advance the clock, called once per timer tick of the boot cpu. Readers retry while
+ *        the sequence is odd or changed under them.
+ * 
+ */
+void vdso_tick()
+{
+    vdso_data->sequence++;
+    vdso_data->ticks++;
+    vdso_data->uptime_ms += 1000 / BIMBLEOS_TIMER_HZ;
+    vdso_data->process_count = process_total();
+    vdso_data->sequence++;
+}
+
+/**
+ * @brief Allocate the per process data page, must run once the process id is known
+ * 
+ * @param process 
+ * @return int 
+ */
+int vdso_process_init(struct Process *process)
+{
+    struct VdsoProcessData *data = kzalloc(PAGING_PAGE_SIZE);
+    if (!data)
+    {
+        return -ENOMEM;
+    }
+
+    data->pid = process->id;
+    process->vdso_page = data;
+    return 0;
+}
+
+/**
+ * @brief Map both data pages read only into the process
+ * 
+ * @param process 
+ * @return int 
+ */
+int vdso_process_map(struct Process *process)
+{
+    int res = paging_map(process->task->page_directory, (void *)BIMBLEOS_VDSO_DATA_VIRTUAL_ADDRESS, vdso_data, PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    res = paging_map(process->task->page_directory, (void *)BIMBLEOS_VDSO_PROCESS_VIRTUAL_ADDRESS, process->vdso_page, PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL);
+
+out:
+    return res;
+}
+
+/**
+ * @brief Count a system call of the process. Only the process's own task makes system calls,
+ *        so no lock is needed
+ * 
+ * @param process 
+ */
+void vdso_process_syscall(struct Process *process)
+{
+    process->syscall_count++;
+    if (process->vdso_page)
+    {
+        ((struct VdsoProcessData *)process->vdso_page)->syscall_count = process->syscall_count;
+    }
+}
+
+void vdso_process_free(struct Process *process)
+{
+    if (process->vdso_page)
+    {
+        kfree(process->vdso_page);
+        process->vdso_page = 0;
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef VDSO_H
+#define VDSO_H
+
+#include <stdint.h>
+
+// Bits of VdsoData.features
+#define VDSO_FEATURE_SYSENTER 0x1           // The bimbleos_fast_* calls work, see idt_sysenter_init
+
+// Kernel data every process can read without a system call, mapped read only at
+// BIMBLEOS_VDSO_DATA_VIRTUAL_ADDRESS. Must match the definition in the stdlib
+struct VdsoData
+{
+    volatile uint32_t sequence;             // Odd while the kernel is updating the page
+    volatile uint32_t ticks;                // Timer ticks since boot
+    volatile uint32_t ticks_per_second;
+    volatile uint32_t uptime_ms;            // Monotonic time since boot
+    volatile uint32_t process_count;
+    uint32_t features;                      // VDSO_FEATURE_*, fixed at boot
+};
+
+// Data of one process, mapped read only at BIMBLEOS_VDSO_PROCESS_VIRTUAL_ADDRESS
+struct VdsoProcessData
+{
+    uint32_t pid;
+    volatile uint32_t syscall_count;
+};
+
+struct Process;
+
+int vdso_init();
+void vdso_tick();
+int vdso_process_init(struct Process *process);
+int vdso_process_map(struct Process *process);
+void vdso_process_syscall(struct Process *process);
+void vdso_process_free(struct Process *process);
+
+#endif
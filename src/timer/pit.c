@@ -0,0 +1,72 @@
+#include "pit.h"
+#include "io/io.h"
+
+/**
+ * @brief Busy wait using PIT channel 2 in one shot mode. Channel 2 is not wired to an IRQ
+ *        so this works before interrupts are set up and on any cpu.
+ * 
+ * @param ticks PIT ticks to wait, at most 0xFFFF
+ */
+static void pit_wait_ticks(uint16_t ticks)
+{
+    // Gate off, speaker off
+    uint8_t gate = insb(PIT_CHANNEL2_GATE_PORT) & ~(PIT_CHANNEL2_GATE | PIT_CHANNEL2_SPEAKER);
+    outb(PIT_CHANNEL2_GATE_PORT, gate);
+
+    outb(PIT_COMMAND_PORT, 0xB0);       // Channel 2, lobyte/hibyte, mode 0 (interrupt on terminal count)
+    outb(PIT_CHANNEL2_DATA_PORT, ticks & 0xFF);
+    outb(PIT_CHANNEL2_DATA_PORT, ticks >> 8);
+
+    // Rising edge on the gate starts the count
+    outb(PIT_CHANNEL2_GATE_PORT, gate | PIT_CHANNEL2_GATE);
+    while (!(insb(PIT_CHANNEL2_GATE_PORT) & PIT_CHANNEL2_OUTPUT))
+    {
+    }
+
+    outb(PIT_CHANNEL2_GATE_PORT, gate);
+}
+
+/**
+ * @brief Make PIT channel 0, IRQ 0, fire 'frequency' times a second. Until this runs it keeps
+ *        the BIOS rate of about 18.2 Hz
+ * 
+ * @param frequency At least 19 Hz, slower rates do not fit the 16 bit divisor
+ */
+void pit_start(uint32_t frequency)
+{
+    uint32_t divisor = PIT_FREQUENCY / frequency;
+    if (divisor > 0xFFFF)
+    {
+        divisor = 0xFFFF;
+    }
+
+    outb(PIT_COMMAND_PORT, 0x34);       // Channel 0, lobyte/hibyte, mode 2 (rate generator)
+    outb(PIT_CHANNEL0_DATA_PORT, divisor & 0xFF);
+    outb(PIT_CHANNEL0_DATA_PORT, divisor >> 8);
+}
+
+void pit_delay_us(uint32_t microseconds)
+{
+    // Kept in 32 bits, the kernel is not linked against libgcc for 64 bit division
+    uint32_t ticks = (microseconds / 1000) * (PIT_FREQUENCY / 1000) + ((microseconds % 1000) * (PIT_FREQUENCY / 1000)) / 1000;
+    if (ticks == 0)
+    {
+        ticks = 1;
+    }
+
+    while (ticks > 0xFFFF)
+    {
+        pit_wait_ticks(0xFFFF);
+        ticks -= 0xFFFF;
+    }
+
+    pit_wait_ticks(ticks);
+}
+
+void pit_delay_ms(uint32_t milliseconds)
+{
+    while (milliseconds--)
+    {
+        pit_delay_us(1000);
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef PIT_H
+#define PIT_H
+
+#include <stdint.h>
+
+#define PIT_FREQUENCY 1193182       // Input clock of the 8253/8254 in Hz
+#define PIT_CHANNEL0_DATA_PORT 0x40
+#define PIT_CHANNEL2_DATA_PORT 0x42
+#define PIT_COMMAND_PORT 0x43
+#define PIT_CHANNEL2_GATE_PORT 0x61
+
+#define PIT_CHANNEL2_GATE 0x01
+#define PIT_CHANNEL2_SPEAKER 0x02
+#define PIT_CHANNEL2_OUTPUT 0x20
+
+void pit_start(uint32_t frequency);
+void pit_delay_us(uint32_t microseconds);
+void pit_delay_ms(uint32_t milliseconds);
+
+#endif
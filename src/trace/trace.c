@@ -0,0 +1,133 @@
+#include "trace.h"
+#include "status.h"
+#include "smp/smp.h"
+#include "cpu/cpu.h"
+#include "apic/apic.h"
+#include "task/process.h"
+#include "serial/serial.h"
+#include "string/string.h"
+#include "memory/heap/kheap.h"
+
+volatile uint32_t trace_enabled = 0;
+
+// One ring per cpu, allocated when tracing starts for the first time
+static struct TraceRing *trace_rings = 0;
+
+#define TRACE_EVENT_DESCRIPTION(id, name, arg0, arg1, arg2) name " " arg0 " " arg1 " " arg2,
+static const char *trace_event_descriptions[TRACE_TOTAL_EVENTS] =
+{
+    TRACE_EVENTS(TRACE_EVENT_DESCRIPTION)
+};
+#undef TRACE_EVENT_DESCRIPTION
+
+void trace_record(int event, uint32_t arg0, uint32_t arg1, uint32_t arg2)
+{
+    struct Cpu *cpu = cpu_current();
+    struct TraceRing *ring = &trace_rings[cpu->id];
+    struct TraceEntry *entry = &ring->entries[ring->head];
+
+    entry->tsc = cpu_rdtsc();
+    entry->event = event;
+    entry->cpu = cpu->id;
+    entry->args[0] = arg0;
+    entry->args[1] = arg1;
+    entry->args[2] = arg2;
+    ring->head = (ring->head + 1) % BIMBLEOS_TRACE_ENTRIES;
+    ring->total++;
+}
+
+/**
+ * @brief Clear the rings and enable the given tracepoints
+ * 
+ * @param events Bit per event id
+ * @return int 
+ */
+int trace_start(uint32_t events)
+{
+    trace_enabled = 0;
+    if (!trace_rings)
+    {
+        trace_rings = kzalloc(sizeof(struct TraceRing) * BIMBLEOS_MAX_CPUS);
+        if (!trace_rings)
+        {
+            return -ENOMEM;
+        }
+    }
+
+    for (int i = 0; i < BIMBLEOS_MAX_CPUS; i++)
+    {
+        trace_rings[i].head = 0;
+        trace_rings[i].total = 0;
+    }
+
+    trace_enabled = events & ((1 << TRACE_TOTAL_EVENTS) - 1);
+    return 0;
+}
+
+void trace_stop()
+{
+    trace_enabled = 0;
+}
+
+static void trace_write_record(uint32_t type, uint32_t value, const void *data, uint32_t length)
+{
+    serial_frame_begin(SERIAL_CHANNEL_TRACE, sizeof(type) + sizeof(value) + length);
+    serial_frame_write(&type, sizeof(type));
+    serial_frame_write(&value, sizeof(value));
+    serial_frame_write(data, length);
+    serial_frame_end();
+}
+
+/**
+ * @brief Send the event names, the process table and every entry to COM1 as binary frames
+ *        for tools/trace2chrome.py. Tracing stops first so the rings hold still.
+ * 
+ * @return int 
+ */
+int trace_dump()
+{
+    if (!trace_rings || !serial_present())
+    {
+        return -EIO;
+    }
+
+    trace_stop();
+    trace_write_record(TRACE_RECORD_BEGIN, apic_tsc_per_ms(), 0, 0);
+    for (int i = 0; i < TRACE_TOTAL_EVENTS; i++)
+    {
+        trace_write_record(TRACE_RECORD_EVENT, i, trace_event_descriptions[i], strlen(trace_event_descriptions[i]));
+    }
+
+    for (int i = 0; i < BIMBLEOS_MAX_PROCESSES; i++)
+    {
+        const char *name = process_name(i);
+        if (name[0])
+        {
+            trace_write_record(TRACE_RECORD_PROCESS, i, name, strlen(name));
+        }
+    }
+
+    for (int cpu = 0; cpu < BIMBLEOS_MAX_CPUS; cpu++)
+    {
+        struct TraceRing *ring = &trace_rings[cpu];
+        if (ring->total == 0)
+        {
+            continue;
+        }
+
+        // Oldest entry first, the ring has wrapped once it is full
+        uint32_t type = TRACE_RECORD_EVENTS;
+        uint32_t value = cpu;
+        uint32_t first = ring->total < BIMBLEOS_TRACE_ENTRIES ? 0 : ring->head;
+        uint32_t total = ring->total < BIMBLEOS_TRACE_ENTRIES ? ring->total : BIMBLEOS_TRACE_ENTRIES;
+        serial_frame_begin(SERIAL_CHANNEL_TRACE, sizeof(type) + sizeof(value) + total * sizeof(struct TraceEntry));
+        serial_frame_write(&type, sizeof(type));
+        serial_frame_write(&value, sizeof(value));
+        serial_frame_write(&ring->entries[first], (total - first) * sizeof(struct TraceEntry));
+        serial_frame_write(ring->entries, first * sizeof(struct TraceEntry));
+        serial_frame_end();
+    }
+
+    trace_write_record(TRACE_RECORD_END, 0, 0, 0);
+    return 0;
+}
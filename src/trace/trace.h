@@ -0,0 +1,126 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+// Every tracepoint: id, name and the names of its three arguments, "" for an unused one.
+// The names go out with each dump so the host decoder needs no copy of this list
+#define TRACE_EVENTS(EVENT)                                                 \
+    EVENT(TASK_SWITCH, "task_switch", "pid", "", "")                        \
+    EVENT(SYSCALL_ENTER, "syscall_enter", "pid", "command", "")             \
+    EVENT(SYSCALL_EXIT, "syscall_exit", "pid", "command", "result")         \
+    EVENT(DISK_SUBMIT, "disk_submit", "lba", "sectors", "")                 \
+    EVENT(DISK_COMPLETE, "disk_complete", "lba", "sectors", "result")       \
+    EVENT(PAGE_FAULT, "page_fault", "address", "eip", "pid")                \
+    EVENT(KHEAP_ALLOC, "kheap_alloc", "address", "size", "caller")          \
+    EVENT(KHEAP_FREE, "kheap_free", "address", "caller", "")
+
+#define TRACE_EVENT_ID(id, name, arg0, arg1, arg2) TRACE_EVENT_##id,
+enum
+{
+    TRACE_EVENTS(TRACE_EVENT_ID)
+    TRACE_TOTAL_EVENTS
+};
+#undef TRACE_EVENT_ID
+
+// Process id of a cpu without a task
+#define TRACE_IDLE_PID 0xFFFF
+
+enum
+{
+    TRACE_START,
+    TRACE_STOP,
+    TRACE_DUMP
+};
+
+// Records of a trace dump, each a frame on SERIAL_CHANNEL_TRACE starting with the type
+enum
+{
+    TRACE_RECORD_BEGIN,         // Time stamp counter cycles per millisecond, 0 if unknown
+    TRACE_RECORD_EVENT,         // Event id, "name arg0 arg1 arg2"
+    TRACE_RECORD_PROCESS,       // Process id, program name
+    TRACE_RECORD_EVENTS,        // Cpu, struct TraceEntry oldest first
+    TRACE_RECORD_END
+};
+
+struct TraceEntry
+{
+    uint64_t tsc;
+    uint16_t event;
+    uint16_t cpu;
+    uint32_t args[3];
+} __attribute__((packed));
+
+// Each cpu writes only its own ring and only with interrupts disabled, so recording takes
+// no lock. The oldest entries are overwritten
+struct TraceRing
+{
+    uint32_t head;
+    uint32_t total;
+    struct TraceEntry entries[BIMBLEOS_TRACE_ENTRIES];
+};
+
+// Bit per event id, tracepoints cost a load and a branch while their bit is clear
+extern volatile uint32_t trace_enabled;
+
+void trace_record(int event, uint32_t arg0, uint32_t arg1, uint32_t arg2);
+int trace_start(uint32_t events);
+void trace_stop();
+int trace_dump();
+
+#if BIMBLEOS_TRACE
+#define TRACE(event, arg0, arg1, arg2)                                      \
+    do                                                                      \
+    {                                                                       \
+        if (__builtin_expect(trace_enabled & (1 << (event)), 0))            \
+        {                                                                   \
+            trace_record(event, arg0, arg1, arg2);                          \
+        }                                                                   \
+    } while (0)
+#else
+#define TRACE(event, arg0, arg1, arg2) do {} while (0)
+#endif
+
+static inline void trace_task_switch(uint16_t pid)
+{
+    TRACE(TRACE_EVENT_TASK_SWITCH, pid, 0, 0);
+}
+
+static inline void trace_syscall_enter(uint16_t pid, int command)
+{
+    TRACE(TRACE_EVENT_SYSCALL_ENTER, pid, command, 0);
+}
+
+static inline void trace_syscall_exit(uint16_t pid, int command, void *result)
+{
+    TRACE(TRACE_EVENT_SYSCALL_EXIT, pid, command, (uint32_t)result);
+}
+
+static inline void trace_disk_submit(uint32_t lba, int sectors)
+{
+    TRACE(TRACE_EVENT_DISK_SUBMIT, lba, sectors, 0);
+}
+
+static inline void trace_disk_complete(uint32_t lba, int sectors, int result)
+{
+    TRACE(TRACE_EVENT_DISK_COMPLETE, lba, sectors, result);
+}
+
+static inline void trace_page_fault(uint32_t address, uint32_t eip, uint16_t pid)
+{
+    TRACE(TRACE_EVENT_PAGE_FAULT, address, eip, pid);
+}
+
+static inline void trace_kheap_alloc(void *address, uint32_t size, void *caller)
+{
+    TRACE(TRACE_EVENT_KHEAP_ALLOC, (uint32_t)address, size, (uint32_t)caller);
+}
+
+static inline void trace_kheap_free(void *address, void *caller)
+{
+    TRACE(TRACE_EVENT_KHEAP_FREE, (uint32_t)address, (uint32_t)caller, 0);
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+// Not <stdio.h>, its fopen, fread and SEEK_SET clash with fs/file.h of the kernel
+int printf(const char *format, ...);
+int snprintf(char *buffer, size_t size, const char *format, ...);
+
+// Shared by the bench_*.c programs, results are "<name> <value> <unit>" lines
+
+static inline uint64_t bench_now_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static inline void bench_report(const char *name, double value, const char *unit)
+{
+    printf("%-40s %14.1f %s\n", name, value, unit);
+}
+
+// xorshift32, the same sequence on every run
+static inline uint32_t bench_random(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+#endif
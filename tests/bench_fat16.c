@@ -0,0 +1,157 @@
+#include "bench.h"
+#include "fs/fat/fat16.h"
+#include "fs/pparser.h"
+#include "disk/disk.h"
+#include "fs/dcache.h"
+#include "shim.h"
+#include "fat16_image.h"
+#include <stdlib.h>
+
+#define BENCH_IMAGE_SECTORS 32768           // 16 MiB, the size of the os.bin data area
+#define BENCH_SECTORS_PER_CLUSTER 4
+#define BENCH_FILE_SIZE (4 * 1024 * 1024)
+#define BENCH_ROUNDS 5
+#define BENCH_OPENS 100000
+
+static const uint32_t bench_chunks[] = {512, 4096, 65536};
+
+/**
+ * @brief Read the whole file in 'chunk' sized reads, return 0 on failure
+ *
+ * @param disk
+ * @param path
+ * @param chunk
+ * @param buffer
+ * @return uint32_t Bytes read
+ */
+static uint32_t bench_read_file(struct Disk *disk, const char *path, uint32_t chunk, char *buffer)
+{
+    struct PathRoot *root = pathparser_parse(path, 0);
+    if (!root)
+    {
+        return 0;
+    }
+
+    uint32_t total = 0;
+    void *descriptor = fat16_open(disk, root->first, FILE_MODE_READ);
+    pathparser_free(root);
+    if ((long)descriptor <= 0)
+    {
+        return 0;
+    }
+
+    struct FileStat stat;
+    if (fat16_stat(disk, descriptor, &stat) < 0)
+    {
+        goto out;
+    }
+
+    while (total < stat.filesize)
+    {
+        uint32_t size = stat.filesize - total < chunk ? stat.filesize - total : chunk;
+        if (fat16_read(disk, descriptor, size, 1, buffer) != 1)
+        {
+            total = 0;
+            goto out;
+        }
+        total += size;
+    }
+
+out:
+    fat16_close(descriptor);
+    return total;
+}
+
+/**
+ * @brief Usage: bench_fat16 [image path [open path]], e.g. bench_fat16 ../bin/os.bin 0:/bench.dat.
+ *        Without arguments a 4 MiB file on a generated image is read and a file two
+ *        directories down is opened
+ *
+ */
+int main(int argc, char **argv)
+{
+    struct Fat16Image image;
+    struct Disk *disk;
+    const char *path = "0:/bench.dat";
+    const char *open_path = "0:/bin/tools/bench.elf";
+    static char buffer[65536];
+
+    if (argc > 1)
+    {
+        disk = shim_disk_load(argv[1]);
+        path = argc > 2 ? argv[2] : path;
+        open_path = argc > 3 ? argv[3] : path;
+    }
+    else
+    {
+        char *data = calloc(1, BENCH_FILE_SIZE);
+        if (!data || fat16_image_create(&image, BENCH_IMAGE_SECTORS, BENCH_SECTORS_PER_CLUSTER) < 0 ||
+            fat16_image_add_file(&image, FAT16_IMAGE_ROOT, "bench.dat", data, BENCH_FILE_SIZE) < 0 ||
+            fat16_image_add_file(&image, fat16_image_add_directory(&image, fat16_image_add_directory(&image, FAT16_IMAGE_ROOT, "bin"), "tools"), "bench.elf", data, 4096) < 0)
+        {
+            printf("Failed to build the image\n");
+            return 1;
+        }
+        free(data);
+        disk = shim_disk_attach(image.data, image.size);
+    }
+
+    fat16_init();
+    if (!disk || fat16_resolve(disk) < 0)
+    {
+        printf("No FAT16 disk\n");
+        return 1;
+    }
+
+    for (int c = 0; c < sizeof(bench_chunks) / sizeof(bench_chunks[0]); c++)
+    {
+        uint32_t reads = shim_disk_reads();
+        uint64_t best = 0;
+        uint32_t bytes = 0;
+        for (int round = 0; round < BENCH_ROUNDS; round++)
+        {
+            uint64_t start = bench_now_ns();
+            bytes = bench_read_file(disk, path, bench_chunks[c], buffer);
+            uint64_t elapsed = bench_now_ns() - start;
+            if (!bytes)
+            {
+                printf("Failed to read %s\n", path);
+                return 1;
+            }
+
+            best = !best || elapsed < best ? elapsed : best;
+        }
+
+        // Disk reads per MiB show how much the filesystem asks of the driver
+        char name[64];
+        snprintf(name, sizeof(name), "fat16_read_%u_byte_chunks", bench_chunks[c]);
+        bench_report(name, bytes / 1048576.0 / (best / 1e9), "MiB/s");
+        snprintf(name, sizeof(name), "fat16_read_%u_byte_chunks_disk_reads", bench_chunks[c]);
+        bench_report(name, (shim_disk_reads() - reads) / (double)BENCH_ROUNDS / (bytes / 1048576.0), "reads/MiB");
+    }
+
+    // Path resolution alone, repeated opens are answered by the dentry cache
+    struct PathRoot *root = pathparser_parse(open_path, 0);
+    struct DentryCacheStats before, after;
+    dcache_get_stats(&before);
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_OPENS && root; i++)
+    {
+        void *descriptor = fat16_open(disk, root->first, FILE_MODE_READ);
+        if ((long)descriptor <= 0)
+        {
+            printf("Failed to open %s\n", open_path);
+            return 1;
+        }
+        fat16_close(descriptor);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    dcache_get_stats(&after);
+    pathparser_free(root);
+
+    uint32_t lookups = after.hits + after.negative_hits + after.misses - before.hits - before.negative_hits - before.misses;
+    bench_report("fat16_open_close", elapsed / (double)BENCH_OPENS, "ns/op");
+    bench_report("fat16_open_close_dcache_hit_rate", lookups ? (after.hits - before.hits) * 100.0 / lookups : 0, "%");
+
+    return 0;
+}
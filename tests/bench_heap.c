@@ -0,0 +1,123 @@
+#include "bench.h"
+#include "memory/heap/heap.h"
+#include <stdlib.h>
+
+// Same geometry as the kernel heap, 100 MB of 4096 byte blocks
+#define BENCH_HEAP_BLOCKS (BIMBLEOS_HEAP_SIZE_BYTES / BIMBLEOS_HEAP_BLOCK_SIZE)
+#define BENCH_LIVE_ALLOCATIONS 512
+#define BENCH_OPERATIONS 200000
+
+static struct heap heap;
+static struct heap_table table;
+static void *memory = 0;
+
+static int bench_heap_setup()
+{
+    table.total_entries = BENCH_HEAP_BLOCKS;
+    return heap_create(&heap, memory, memory + BENCH_HEAP_BLOCKS * BIMBLEOS_HEAP_BLOCK_SIZE, &table);
+}
+
+/**
+ * @brief Allocate a batch of single blocks, then free them all, like a burst of small
+ *        kzalloc calls
+ *
+ */
+static void bench_alloc_free_batch()
+{
+    static void *pointers[BENCH_LIVE_ALLOCATIONS];
+    bench_heap_setup();
+
+    uint64_t start = bench_now_ns();
+    for (int round = 0; round < BENCH_OPERATIONS / BENCH_LIVE_ALLOCATIONS; round++)
+    {
+        for (int i = 0; i < BENCH_LIVE_ALLOCATIONS; i++)
+        {
+            pointers[i] = heap_malloc(&heap, 64);
+        }
+        for (int i = 0; i < BENCH_LIVE_ALLOCATIONS; i++)
+        {
+            heap_free(&heap, pointers[i]);
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    bench_report("heap_batch_alloc_free", (double)elapsed / (2 * BENCH_OPERATIONS), "ns/op");
+}
+
+/**
+ * @brief Replace random live allocations of 1 to 16 blocks, the table fragments over time
+ *        and first fit has to search further
+ *
+ */
+static void bench_random_churn()
+{
+    static void *pointers[BENCH_LIVE_ALLOCATIONS];
+    uint32_t seed = 12345;
+    uint32_t failed = 0;
+    bench_heap_setup();
+
+    for (int i = 0; i < BENCH_LIVE_ALLOCATIONS; i++)
+    {
+        pointers[i] = heap_malloc(&heap, (bench_random(&seed) % 16 + 1) * BIMBLEOS_HEAP_BLOCK_SIZE);
+    }
+
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_OPERATIONS; i++)
+    {
+        int slot = bench_random(&seed) % BENCH_LIVE_ALLOCATIONS;
+        heap_free(&heap, pointers[slot]);
+        pointers[slot] = heap_malloc(&heap, (bench_random(&seed) % 16 + 1) * BIMBLEOS_HEAP_BLOCK_SIZE);
+        failed += !pointers[slot];
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    struct HeapStats stats;
+    heap_get_stats(&heap, &stats);
+    bench_report("heap_churn_free_alloc", (double)elapsed / BENCH_OPERATIONS, "ns/op");
+    bench_report("heap_churn_largest_free_run", stats.largest_free_run, "blocks");
+    bench_report("heap_churn_failed", failed, "allocations");
+}
+
+/**
+ * @brief One large allocation behind many small ones, the search walks the whole table
+ *
+ */
+static void bench_large_after_small()
+{
+    bench_heap_setup();
+    for (int i = 0; i < BENCH_HEAP_BLOCKS / 2; i++)
+    {
+        heap_malloc(&heap, 1);
+    }
+    for (int i = 0; i < BENCH_HEAP_BLOCKS / 2; i += 2)
+    {
+        heap_free(&heap, heap_block_to_address(&heap, i));
+    }
+
+    const int rounds = 1000;
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < rounds; i++)
+    {
+        heap_free(&heap, heap_malloc(&heap, 64 * BIMBLEOS_HEAP_BLOCK_SIZE));
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    bench_report("heap_large_behind_holes", (double)elapsed / rounds, "ns/op");
+}
+
+int main()
+{
+    // The allocator never touches the blocks, the memory only has to be reserved
+    memory = aligned_alloc(BIMBLEOS_HEAP_BLOCK_SIZE, (size_t)BENCH_HEAP_BLOCKS * BIMBLEOS_HEAP_BLOCK_SIZE);
+    table.entries = malloc(BENCH_HEAP_BLOCKS);
+    if (!memory || !table.entries)
+    {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    bench_alloc_free_batch();
+    bench_random_churn();
+    bench_large_after_small();
+    return 0;
+}
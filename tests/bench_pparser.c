@@ -0,0 +1,31 @@
+#include "bench.h"
+#include "fs/pparser.h"
+
+#define BENCH_ROUNDS 200000
+
+static const char *bench_paths[] =
+{
+    "0:/shell.elf",
+    "0:/bin/tools/bench.elf",
+    "9:/interrupts",
+    "0:/a/b/c/d/e/f/g/h/data.txt",
+};
+
+int main()
+{
+    for (int p = 0; p < sizeof(bench_paths) / sizeof(bench_paths[0]); p++)
+    {
+        uint64_t start = bench_now_ns();
+        for (int i = 0; i < BENCH_ROUNDS; i++)
+        {
+            pathparser_free(pathparser_parse(bench_paths[p], 0));
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+
+        char name[64];
+        snprintf(name, sizeof(name), "pparser_parse_free %s", bench_paths[p]);
+        bench_report(name, (double)elapsed / BENCH_ROUNDS, "ns/op");
+    }
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include "disk/disk.h"
+#include "disk/bcache.h"
+#include "fs/dcache.h"
+#include "config.h"
+#include "status.h"
+#include "memory/memory.h"
+#include "shim.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static struct Disk shim_disk;
+static char *shim_disk_data = 0;
+static size_t shim_disk_size = 0;
+static int shim_disk_owned = 0;
+
+// Calls of disk_read_block and disk_write_block and the sectors they moved
+static uint32_t shim_disk_total_reads = 0;
+static uint32_t shim_disk_total_sectors = 0;
+static uint32_t shim_disk_total_writes = 0;
+static uint32_t shim_disk_total_sectors_written = 0;
+
+/**
+ * @brief Make 'data' disk 0. No filesystem is resolved, call fat16_resolve for that
+ *
+ * @param data
+ * @param size
+ * @return struct Disk*
+ */
+struct Disk *shim_disk_attach(void *data, size_t size)
+{
+    static int caches_ready = 0;
+    if (!caches_ready)
+    {
+        bcache_init();
+        dcache_init();
+        caches_ready = 1;
+    }
+
+    shim_disk_detach();
+    shim_disk_data = data;
+    shim_disk_size = size;
+
+    memset(&shim_disk, 0, sizeof(shim_disk));
+    shim_disk.type = BIMBLEOS_DISK_TYPE_REAL;
+    shim_disk.id = 0;
+    shim_disk.sector_size = BIMBLEOS_SECTOR_SIZE;
+    return &shim_disk;
+}
+
+/**
+ * @brief Read a whole image file, e.g. bin/os.bin, into memory and make it disk 0
+ *
+ * @param filename
+ * @return struct Disk* 0 when the file can not be read
+ */
+struct Disk *shim_disk_load(const char *filename)
+{
+    struct Disk *disk = 0;
+    char *data = 0;
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+    {
+        goto out;
+    }
+
+    if (fseek(file, 0, SEEK_END) != 0)
+    {
+        goto out;
+    }
+
+    long size = ftell(file);
+    if (size <= 0 || fseek(file, 0, SEEK_SET) != 0)
+    {
+        goto out;
+    }
+
+    data = malloc(size);
+    if (!data || fread(data, 1, size, file) != (size_t)size)
+    {
+        goto out;
+    }
+
+    disk = shim_disk_attach(data, size);
+    shim_disk_owned = 1;
+    data = 0;
+
+out:
+    free(data);
+    if (file)
+    {
+        fclose(file);
+    }
+    return disk;
+}
+
+void shim_disk_detach()
+{
+    // Sectors of the old image must not be served for the next one
+    bcache_invalidate(&shim_disk);
+    if (shim_disk_owned)
+    {
+        free(shim_disk_data);
+    }
+
+    shim_disk_data = 0;
+    shim_disk_size = 0;
+    shim_disk_owned = 0;
+    shim_disk_total_reads = 0;
+    shim_disk_total_sectors = 0;
+    shim_disk_total_writes = 0;
+    shim_disk_total_sectors_written = 0;
+}
+
+uint32_t shim_disk_reads()
+{
+    return shim_disk_total_reads;
+}
+
+uint32_t shim_disk_sectors_read()
+{
+    return shim_disk_total_sectors;
+}
+
+uint32_t shim_disk_writes()
+{
+    return shim_disk_total_writes;
+}
+
+uint32_t shim_disk_sectors_written()
+{
+    return shim_disk_total_sectors_written;
+}
+
+struct Disk *disk_get(int index)
+{
+    return index == 0 && shim_disk_data ? &shim_disk : 0;
+}
+
+int disk_read_block(struct Disk *idisk, int lba, int total, void *buff)
+{
+    if (idisk != &shim_disk || lba < 0 || total < 0)
+    {
+        return -EIO;
+    }
+
+    size_t start = (size_t)lba * BIMBLEOS_SECTOR_SIZE;
+    size_t length = (size_t)total * BIMBLEOS_SECTOR_SIZE;
+    if (start + length > shim_disk_size)
+    {
+        return -EIO;
+    }
+
+    shim_disk_total_reads++;
+    shim_disk_total_sectors += total;
+    memcpy(buff, shim_disk_data + start, length);
+    return 0;
+}
+
+int disk_write_block(struct Disk *idisk, int lba, int total, const void *buff)
+{
+    if (idisk != &shim_disk || lba < 0 || total < 0)
+    {
+        return -EIO;
+    }
+
+    size_t start = (size_t)lba * BIMBLEOS_SECTOR_SIZE;
+    size_t length = (size_t)total * BIMBLEOS_SECTOR_SIZE;
+    if (start + length > shim_disk_size)
+    {
+        return -EIO;
+    }
+
+    shim_disk_total_writes++;
+    shim_disk_total_sectors_written += total;
+    memcpy(shim_disk_data + start, (void *)buff, length);
+    return 0;
+}
+
+int disk_flush(struct Disk *idisk)
+{
+    return 0;
+}
@@ -0,0 +1,278 @@
+#include "fat16_image.h"
+#include "fs/fat/fat16.h"
+#include "config.h"
+#include "status.h"
+#include "memory/memory.h"
+#include <stdlib.h>
+
+#define FAT16_IMAGE_RESERVED_SECTORS 4
+#define FAT16_IMAGE_ROOT_DIR_ENTRIES 512
+#define FAT16_IMAGE_FAT_COPIES 2
+#define FAT16_IMAGE_END_OF_CHAIN 0xFFFF
+
+static uint32_t fat16_image_root_sector(struct Fat16Image *image)
+{
+    return image->reserved_sectors + FAT16_IMAGE_FAT_COPIES * image->sectors_per_fat;
+}
+
+static uint32_t fat16_image_first_data_sector(struct Fat16Image *image)
+{
+    uint32_t root_sectors = image->root_dir_entries * sizeof(struct FAT_DirectoryItem) / BIMBLEOS_SECTOR_SIZE;
+    return fat16_image_root_sector(image) + root_sectors;
+}
+
+static uint8_t *fat16_image_cluster(struct Fat16Image *image, uint32_t cluster)
+{
+    uint32_t sector = fat16_image_first_data_sector(image) + (cluster - 2) * image->sectors_per_cluster;
+    return image->data + (size_t)sector * BIMBLEOS_SECTOR_SIZE;
+}
+
+uint32_t fat16_image_cluster_bytes(struct Fat16Image *image)
+{
+    return image->sectors_per_cluster * BIMBLEOS_SECTOR_SIZE;
+}
+
+static void fat16_image_set_fat(struct Fat16Image *image, uint32_t cluster, uint16_t value)
+{
+    for (int i = 0; i < FAT16_IMAGE_FAT_COPIES; i++)
+    {
+        uint32_t fat_sector = image->reserved_sectors + i * image->sectors_per_fat;
+        uint8_t *entry = image->data + (size_t)fat_sector * BIMBLEOS_SECTOR_SIZE + cluster * BIMBLEOS_FAT16_FAT_ENTRY_SIZE;
+        entry[0] = value & 0xFF;
+        entry[1] = value >> 8;
+    }
+}
+
+/**
+ * @brief Format a zeroed image of 'total_sectors' sectors
+ *
+ * @param image
+ * @param total_sectors
+ * @param sectors_per_cluster
+ * @return int
+ */
+int fat16_image_create(struct Fat16Image *image, uint32_t total_sectors, uint8_t sectors_per_cluster)
+{
+    memset(image, 0, sizeof(struct Fat16Image));
+    image->size = (size_t)total_sectors * BIMBLEOS_SECTOR_SIZE;
+    image->data = calloc(1, image->size);
+    if (!image->data)
+    {
+        return -ENOMEM;
+    }
+
+    image->reserved_sectors = FAT16_IMAGE_RESERVED_SECTORS;
+    image->root_dir_entries = FAT16_IMAGE_ROOT_DIR_ENTRIES;
+    image->sectors_per_cluster = sectors_per_cluster;
+
+    // Sized for every sector being a cluster, a little more FAT than needed
+    uint32_t entries = total_sectors / sectors_per_cluster + 2;
+    image->sectors_per_fat = (entries * BIMBLEOS_FAT16_FAT_ENTRY_SIZE + BIMBLEOS_SECTOR_SIZE - 1) / BIMBLEOS_SECTOR_SIZE;
+
+    uint32_t first_data_sector = fat16_image_first_data_sector(image);
+    if (first_data_sector >= total_sectors)
+    {
+        fat16_image_free(image);
+        return -EINVARG;
+    }
+
+    image->total_clusters = (total_sectors - first_data_sector) / sectors_per_cluster;
+    image->next_cluster = 2;
+    image->cluster_stride = 1;
+
+    struct FAT_H *header = (struct FAT_H *)image->data;
+    struct FAT_Header *primary = &header->primary_header;
+    primary->short_jmp_ins[0] = 0xEB;
+    primary->short_jmp_ins[1] = 0x3C;
+    primary->short_jmp_ins[2] = 0x90;
+    memcpy(primary->oem_identifier, (void *)"BIMBLEOS", sizeof(primary->oem_identifier));
+    primary->bytes_per_sector = BIMBLEOS_SECTOR_SIZE;
+    primary->sectors_per_cluster = sectors_per_cluster;
+    primary->reserved_sectors = image->reserved_sectors;
+    primary->fat_copies = FAT16_IMAGE_FAT_COPIES;
+    primary->root_dir_entries = image->root_dir_entries;
+    primary->number_of_sectors = total_sectors < 0x10000 ? total_sectors : 0;
+    primary->media_type = 0xF8;
+    primary->sectors_per_fat = image->sectors_per_fat;
+    primary->sectors_big = total_sectors < 0x10000 ? 0 : total_sectors;
+
+    struct FAT_HeaderExtended *extended = &header->shared.extended_header;
+    extended->drive_number = 0x80;
+    extended->signature = BIMBLEOS_FAT16_SIGNATURE;
+    memcpy(extended->volume_id_string, (void *)"TESTS      ", sizeof(extended->volume_id_string));
+    memcpy(extended->system_id_string, (void *)"FAT16   ", sizeof(extended->system_id_string));
+    image->data[510] = 0x55;
+    image->data[511] = 0xAA;
+
+    // Media descriptor and the end of chain marker in the two reserved entries
+    fat16_image_set_fat(image, 0, 0xFFF8);
+    fat16_image_set_fat(image, 1, FAT16_IMAGE_END_OF_CHAIN);
+    return 0;
+}
+
+void fat16_image_free(struct Fat16Image *image)
+{
+    free(image->data);
+    image->data = 0;
+}
+
+static int fat16_image_alloc_cluster(struct Fat16Image *image)
+{
+    uint32_t cluster = image->next_cluster;
+    if (cluster >= image->total_clusters + 2)
+    {
+        return -ENOMEM;
+    }
+
+    image->next_cluster += image->cluster_stride;
+    fat16_image_set_fat(image, cluster, FAT16_IMAGE_END_OF_CHAIN);
+    return cluster;
+}
+
+/**
+ * @brief Space padded upper case 8.3 name, "data.txt" becomes "DATA    TXT"
+ *
+ * @param item
+ * @param name
+ */
+static void fat16_image_set_name(struct FAT_DirectoryItem *item, const char *name)
+{
+    memset(item->filename, ' ', sizeof(item->filename));
+    memset(item->ext, ' ', sizeof(item->ext));
+
+    uint8_t *out = item->filename;
+    int max = sizeof(item->filename);
+    for (int i = 0; *name; name++)
+    {
+        if (*name == '.' && out == item->filename)
+        {
+            out = item->ext;
+            max = sizeof(item->ext);
+            i = 0;
+            continue;
+        }
+
+        if (i < max)
+        {
+            out[i++] = (*name >= 'a' && *name <= 'z') ? *name - 32 : *name;
+        }
+    }
+}
+
+static struct FAT_DirectoryItem *fat16_image_new_entry(struct Fat16Image *image, uint32_t directory)
+{
+    struct FAT_DirectoryItem *items;
+    uint32_t total;
+    if (directory == FAT16_IMAGE_ROOT)
+    {
+        items = (struct FAT_DirectoryItem *)(image->data + (size_t)fat16_image_root_sector(image) * BIMBLEOS_SECTOR_SIZE);
+        total = image->root_dir_entries;
+    }
+    else
+    {
+        items = (struct FAT_DirectoryItem *)fat16_image_cluster(image, directory);
+        total = fat16_image_cluster_bytes(image) / sizeof(struct FAT_DirectoryItem);
+    }
+
+    // Keep the last entry free, the end of a directory is an entry starting with zero
+    for (uint32_t i = 0; i + 1 < total; i++)
+    {
+        if (items[i].filename[0] == 0x00)
+        {
+            return &items[i];
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Add a file to the root directory or the directory starting at cluster 'directory'
+ *
+ * @param image
+ * @param directory
+ * @param name
+ * @param data
+ * @param size
+ * @return int The first cluster of the file, negative on failure
+ */
+int fat16_image_add_file(struct Fat16Image *image, uint32_t directory, const char *name, const void *data, uint32_t size)
+{
+    struct FAT_DirectoryItem *item = fat16_image_new_entry(image, directory);
+    if (!item)
+    {
+        return -ENOMEM;
+    }
+
+    uint32_t cluster_bytes = fat16_image_cluster_bytes(image);
+    const uint8_t *bytes = data;
+    int first_cluster = 0;
+    int last_cluster = 0;
+    for (uint32_t offset = 0; offset < size; offset += cluster_bytes)
+    {
+        int cluster = fat16_image_alloc_cluster(image);
+        if (cluster < 0)
+        {
+            return cluster;
+        }
+
+        if (last_cluster)
+        {
+            fat16_image_set_fat(image, last_cluster, cluster);
+        }
+        else
+        {
+            first_cluster = cluster;
+        }
+
+        uint32_t chunk = size - offset < cluster_bytes ? size - offset : cluster_bytes;
+        memcpy(fat16_image_cluster(image, cluster), (void *)(bytes + offset), chunk);
+        last_cluster = cluster;
+    }
+
+    fat16_image_set_name(item, name);
+    item->attribute = FAT_FILE_ARCHIVED;
+    item->low_16_bits_first_cluster = first_cluster;
+    item->filesize = size;
+    return first_cluster;
+}
+
+/**
+ * @brief Add an empty directory of one cluster
+ *
+ * @param image
+ * @param directory Parent directory
+ * @param name
+ * @return int The cluster of the new directory, negative on failure
+ */
+int fat16_image_add_directory(struct Fat16Image *image, uint32_t directory, const char *name)
+{
+    struct FAT_DirectoryItem *item = fat16_image_new_entry(image, directory);
+    if (!item)
+    {
+        return -ENOMEM;
+    }
+
+    int cluster = fat16_image_alloc_cluster(image);
+    if (cluster < 0)
+    {
+        return cluster;
+    }
+
+    fat16_image_set_name(item, name);
+    item->attribute = FAT_FILE_SUBDIRECTORY;
+    item->low_16_bits_first_cluster = cluster;
+
+    struct FAT_DirectoryItem *items = (struct FAT_DirectoryItem *)fat16_image_cluster(image, cluster);
+    memset(&items[0], ' ', sizeof(items[0].filename) + sizeof(items[0].ext));
+    items[0].filename[0] = '.';
+    items[0].attribute = FAT_FILE_SUBDIRECTORY;
+    items[0].low_16_bits_first_cluster = cluster;
+
+    memset(&items[1], ' ', sizeof(items[1].filename) + sizeof(items[1].ext));
+    items[1].filename[0] = '.';
+    items[1].filename[1] = '.';
+    items[1].attribute = FAT_FILE_SUBDIRECTORY;
+    items[1].low_16_bits_first_cluster = directory;
+    return cluster;
+}
@@ -0,0 +1,34 @@
+#ifndef FAT16_IMAGE_H
+#define FAT16_IMAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Builds FAT16 images in memory for the filesystem tests and benchmarks, laid out the way
+// fat16_resolve expects: boot sector, reserved sectors, two FAT copies, the root directory
+// and the data clusters
+
+#define FAT16_IMAGE_ROOT 0      // Directory argument meaning the root directory
+
+struct Fat16Image
+{
+    uint8_t *data;
+    size_t size;
+
+    uint16_t reserved_sectors;
+    uint16_t sectors_per_fat;
+    uint16_t root_dir_entries;
+    uint8_t sectors_per_cluster;
+    uint32_t total_clusters;
+
+    uint32_t next_cluster;
+    uint32_t cluster_stride;    // Distance between the clusters of a file, above 1 fragments it
+};
+
+int fat16_image_create(struct Fat16Image *image, uint32_t total_sectors, uint8_t sectors_per_cluster);
+void fat16_image_free(struct Fat16Image *image);
+uint32_t fat16_image_cluster_bytes(struct Fat16Image *image);
+int fat16_image_add_file(struct Fat16Image *image, uint32_t directory, const char *name, const void *data, uint32_t size);
+int fat16_image_add_directory(struct Fat16Image *image, uint32_t directory, const char *name);
+
+#endif
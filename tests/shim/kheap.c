@@ -0,0 +1,49 @@
+#include "memory/heap/kheap.h"
+#include "shim.h"
+#include <stdlib.h>
+
+// Allocations made through kmalloc and kzalloc that were not freed yet
+static int shim_kheap_live = 0;
+
+void kheap_init()
+{
+}
+
+void *kmalloc(size_t size)
+{
+    void *ptr = malloc(size);
+    if (ptr)
+    {
+        shim_kheap_live++;
+    }
+    return ptr;
+}
+
+void *kzalloc(size_t size)
+{
+    void *ptr = calloc(1, size);
+    if (ptr)
+    {
+        shim_kheap_live++;
+    }
+    return ptr;
+}
+
+void kfree(void *ptr)
+{
+    if (ptr)
+    {
+        shim_kheap_live--;
+    }
+    free(ptr);
+}
+
+/**
+ * @brief Allocations still held, tests compare it before and after to find leaks
+ *
+ * @return int
+ */
+int shim_kheap_outstanding()
+{
+    return shim_kheap_live;
+}
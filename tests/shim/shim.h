@@ -0,0 +1,23 @@
+#ifndef SHIM_H
+#define SHIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Host replacements for the kernel services the tested modules call. kmalloc and friends
+// use the host allocator, disk 0 is a RAM disk over a buffer or an image file and the tests
+// run on one thread, so spinlocks never wait
+
+struct Disk;
+
+int shim_kheap_outstanding();
+
+struct Disk *shim_disk_attach(void *data, size_t size);
+struct Disk *shim_disk_load(const char *filename);
+void shim_disk_detach();
+uint32_t shim_disk_reads();
+uint32_t shim_disk_sectors_read();
+uint32_t shim_disk_writes();
+uint32_t shim_disk_sectors_written();
+
+#endif
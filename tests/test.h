@@ -0,0 +1,65 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stddef.h>
+
+// Not <stdio.h>, its fopen, fread and SEEK_SET clash with fs/file.h of the kernel
+int printf(const char *format, ...);
+int snprintf(char *buffer, size_t size, const char *format, ...);
+
+// Minimal test runner shared by the test_*.c programs, each of them is one translation unit
+static int test_failures = 0;
+static int test_total = 0;
+static int test_current_failed = 0;
+
+#define TEST_ASSERT(condition)                                                          \
+    do                                                                                  \
+    {                                                                                   \
+        if (!(condition))                                                               \
+        {                                                                               \
+            printf("  %s:%d: assertion failed: %s\n", __FILE__, __LINE__, #condition);  \
+            test_current_failed = 1;                                                    \
+            return;                                                                     \
+        }                                                                               \
+    } while (0)
+
+#define TEST_ASSERT_EQUAL(expected, actual)                                             \
+    do                                                                                  \
+    {                                                                                   \
+        long long test_expected = (long long)(expected);                                \
+        long long test_actual = (long long)(actual);                                    \
+        if (test_expected != test_actual)                                               \
+        {                                                                               \
+            printf("  %s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual,  \
+                   test_actual, test_expected);                                         \
+            test_current_failed = 1;                                                    \
+            return;                                                                     \
+        }                                                                               \
+    } while (0)
+
+// Kernel style error pointer, the same test ISERR of kernel.h makes
+#define TEST_ISERR(value) ((long)(value) < 0)
+
+#define TEST_RUN(test)                                                                  \
+    do                                                                                  \
+    {                                                                                   \
+        test_current_failed = 0;                                                        \
+        test_total++;                                                                   \
+        test();                                                                         \
+        printf("%s %s\n", test_current_failed ? "FAIL" : "ok  ", #test);                 \
+        test_failures += test_current_failed;                                           \
+    } while (0)
+
+/**
+ * @brief Print the summary, the result is the exit status of the test program
+ *
+ * @param name
+ * @return int
+ */
+static inline int test_finish(const char *name)
+{
+    printf("%s: %d of %d tests passed\n", name, test_total - test_failures, test_total);
+    return test_failures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,240 @@
+#include "test.h"
+#include "disk/bcache.h"
+#include "disk/disk.h"
+#include "disk/streamer.h"
+#include "config.h"
+#include "status.h"
+#include "shim.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_DISK_SECTORS 1024
+
+static char *disk_data = 0;
+static struct Disk *disk = 0;
+
+/**
+ * @brief A fresh disk whose sector n is filled with the byte n
+ *
+ */
+static void test_setup()
+{
+    if (!disk_data)
+    {
+        disk_data = malloc(TEST_DISK_SECTORS * BIMBLEOS_SECTOR_SIZE);
+    }
+
+    for (int i = 0; i < TEST_DISK_SECTORS; i++)
+    {
+        memset(disk_data + i * BIMBLEOS_SECTOR_SIZE, i & 0xFF, BIMBLEOS_SECTOR_SIZE);
+    }
+    disk = shim_disk_attach(disk_data, TEST_DISK_SECTORS * BIMBLEOS_SECTOR_SIZE);
+}
+
+static void test_read_hits()
+{
+    struct BufferCacheStats before, after;
+    char buffer[16];
+    test_setup();
+    bcache_get_stats(&before);
+
+    TEST_ASSERT_EQUAL(0, bcache_read(disk, 7, 100, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(7, buffer[0]);
+    TEST_ASSERT_EQUAL(0, bcache_read(disk, 7, 0, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(1, shim_disk_reads());
+
+    bcache_get_stats(&after);
+    TEST_ASSERT_EQUAL(1, after.misses - before.misses);
+    TEST_ASSERT_EQUAL(1, after.hits - before.hits);
+}
+
+static void test_read_bounds()
+{
+    char buffer[16];
+    test_setup();
+    TEST_ASSERT_EQUAL(-EINVARG, bcache_read(disk, 0, BIMBLEOS_SECTOR_SIZE - 8, buffer, sizeof(buffer)));
+    TEST_ASSERT(bcache_read(disk, TEST_DISK_SECTORS, 0, buffer, sizeof(buffer)) < 0);
+}
+
+static void test_write_back_on_flush()
+{
+    char sector[BIMBLEOS_SECTOR_SIZE];
+    char buffer[4];
+    test_setup();
+
+    // A whole sector is not read first, a partial one is
+    memset(sector, 0xAA, sizeof(sector));
+    TEST_ASSERT_EQUAL(0, bcache_write(disk, 10, 0, sector, sizeof(sector)));
+    TEST_ASSERT_EQUAL(0, shim_disk_reads());
+    TEST_ASSERT_EQUAL(0, bcache_write(disk, 20, 4, "abcd", 4));
+    TEST_ASSERT_EQUAL(1, shim_disk_reads());
+
+    // Readers see the cached data, the disk does not until the flush
+    TEST_ASSERT_EQUAL(0, bcache_read(disk, 20, 4, buffer, 4));
+    TEST_ASSERT(memcmp(buffer, "abcd", 4) == 0);
+    TEST_ASSERT_EQUAL(10, disk_data[10 * BIMBLEOS_SECTOR_SIZE]);
+    TEST_ASSERT_EQUAL(0, shim_disk_writes());
+
+    TEST_ASSERT_EQUAL(0, bcache_flush(disk));
+    TEST_ASSERT_EQUAL(2, shim_disk_writes());
+    TEST_ASSERT_EQUAL((char)0xAA, disk_data[10 * BIMBLEOS_SECTOR_SIZE]);
+    TEST_ASSERT(memcmp(&disk_data[20 * BIMBLEOS_SECTOR_SIZE + 4], "abcd", 4) == 0);
+    TEST_ASSERT_EQUAL(20, disk_data[20 * BIMBLEOS_SECTOR_SIZE]);
+
+    // Nothing is dirty any more
+    TEST_ASSERT_EQUAL(0, bcache_flush(disk));
+    TEST_ASSERT_EQUAL(2, shim_disk_writes());
+}
+
+static void test_flush_coalesces()
+{
+    char sector[BIMBLEOS_SECTOR_SIZE];
+    test_setup();
+
+    // Written out of order, two runs of adjacent sectors
+    memset(sector, 0x55, sizeof(sector));
+    const int lbas[] = {103, 100, 102, 101, 200, 201};
+    for (int i = 0; i < sizeof(lbas) / sizeof(lbas[0]); i++)
+    {
+        TEST_ASSERT_EQUAL(0, bcache_write(disk, lbas[i], 0, sector, sizeof(sector)));
+    }
+
+    TEST_ASSERT_EQUAL(0, bcache_flush(disk));
+    TEST_ASSERT_EQUAL(2, shim_disk_writes());
+    TEST_ASSERT_EQUAL(6, shim_disk_sectors_written());
+    TEST_ASSERT_EQUAL(0x55, disk_data[101 * BIMBLEOS_SECTOR_SIZE]);
+    TEST_ASSERT_EQUAL(0x55, disk_data[201 * BIMBLEOS_SECTOR_SIZE + 511]);
+}
+
+static void test_tick_writes_one_run()
+{
+    char sector[BIMBLEOS_SECTOR_SIZE];
+    struct BufferCacheStats stats;
+    test_setup();
+
+    memset(sector, 0x66, sizeof(sector));
+    for (int lba = 300; lba < 400; lba++)
+    {
+        TEST_ASSERT_EQUAL(0, bcache_write(disk, lba, 0, sector, sizeof(sector)));
+    }
+    TEST_ASSERT_EQUAL(0, bcache_write(disk, 500, 0, sector, sizeof(sector)));
+
+    // The tick that starts the write back takes one run only
+    for (int i = 0; i < BIMBLEOS_BCACHE_FLUSH_TICKS && !shim_disk_writes(); i++)
+    {
+        bcache_tick();
+    }
+    TEST_ASSERT_EQUAL(1, shim_disk_writes());
+    TEST_ASSERT_EQUAL(BIMBLEOS_BCACHE_FLUSH_RUN, shim_disk_sectors_written());
+
+    // The following ticks carry on with the rest
+    bcache_tick();
+    TEST_ASSERT_EQUAL(100, shim_disk_sectors_written());
+    bcache_tick();
+    TEST_ASSERT_EQUAL(3, shim_disk_writes());
+    TEST_ASSERT_EQUAL(0x66, disk_data[500 * BIMBLEOS_SECTOR_SIZE]);
+
+    bcache_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.dirty);
+    bcache_tick();
+    TEST_ASSERT_EQUAL(3, shim_disk_writes());
+}
+
+static void test_eviction_writes_back()
+{
+    char byte = 0x77;
+    char buffer[1];
+    test_setup();
+
+    TEST_ASSERT_EQUAL(0, bcache_write(disk, 5, 0, &byte, 1));
+
+    // Reading a cache full of other sectors pushes the dirty one out
+    for (int i = 0; i < BIMBLEOS_BCACHE_BUFFERS; i++)
+    {
+        TEST_ASSERT_EQUAL(0, bcache_read(disk, 300 + i, 0, buffer, 1));
+    }
+
+    TEST_ASSERT_EQUAL(0x77, disk_data[5 * BIMBLEOS_SECTOR_SIZE]);
+
+    // Sector 5 comes back from the disk
+    uint32_t reads = shim_disk_reads();
+    TEST_ASSERT_EQUAL(0, bcache_read(disk, 5, 0, buffer, 1));
+    TEST_ASSERT_EQUAL(0x77, buffer[0]);
+    TEST_ASSERT_EQUAL(reads + 1, shim_disk_reads());
+}
+
+static void test_lru_keeps_recent()
+{
+    char buffer[1];
+    test_setup();
+
+    TEST_ASSERT_EQUAL(0, bcache_read(disk, 0, 0, buffer, 1));
+    for (int i = 1; i < BIMBLEOS_BCACHE_BUFFERS + 16; i++)
+    {
+        // Sector 0 stays the most recently used
+        TEST_ASSERT_EQUAL(0, bcache_read(disk, i, 0, buffer, 1));
+        TEST_ASSERT_EQUAL(0, bcache_read(disk, 0, 0, buffer, 1));
+    }
+
+    TEST_ASSERT_EQUAL(BIMBLEOS_BCACHE_BUFFERS + 16, shim_disk_reads());
+}
+
+static void test_invalidate()
+{
+    char byte = 0x11;
+    char buffer[1];
+    test_setup();
+
+    TEST_ASSERT_EQUAL(0, bcache_write(disk, 9, 0, &byte, 1));
+    bcache_invalidate(disk);
+    TEST_ASSERT_EQUAL(0, bcache_flush(disk));
+    TEST_ASSERT_EQUAL(0, shim_disk_writes());
+    TEST_ASSERT_EQUAL(0, bcache_read(disk, 9, 0, buffer, 1));
+    TEST_ASSERT_EQUAL(9, buffer[0]);
+}
+
+static void test_streamer_across_sectors()
+{
+    char data[1300];
+    char check[1300];
+    test_setup();
+
+    for (int i = 0; i < sizeof(data); i++)
+    {
+        data[i] = i * 7;
+    }
+
+    struct DiskStream *stream = diskstreamer_new(0);
+    TEST_ASSERT(stream != 0);
+    diskstreamer_seek(stream, 3 * BIMBLEOS_SECTOR_SIZE + 300);
+    TEST_ASSERT_EQUAL(0, diskstreamer_write(stream, data, sizeof(data)));
+    TEST_ASSERT_EQUAL(0, bcache_flush(disk));
+
+    diskstreamer_seek(stream, 3 * BIMBLEOS_SECTOR_SIZE + 300);
+    TEST_ASSERT_EQUAL(0, diskstreamer_read(stream, check, sizeof(check)));
+    diskstreamer_close(stream);
+
+    TEST_ASSERT(memcmp(data, check, sizeof(data)) == 0);
+    TEST_ASSERT(memcmp(data, &disk_data[3 * BIMBLEOS_SECTOR_SIZE + 300], sizeof(data)) == 0);
+
+    // The bytes around the write are untouched
+    TEST_ASSERT_EQUAL(3, disk_data[3 * BIMBLEOS_SECTOR_SIZE + 299]);
+    TEST_ASSERT_EQUAL(6, disk_data[3 * BIMBLEOS_SECTOR_SIZE + 300 + sizeof(data)]);
+}
+
+int main()
+{
+    TEST_RUN(test_read_hits);
+    TEST_RUN(test_read_bounds);
+    TEST_RUN(test_write_back_on_flush);
+    TEST_RUN(test_flush_coalesces);
+    TEST_RUN(test_tick_writes_one_run);
+    TEST_RUN(test_eviction_writes_back);
+    TEST_RUN(test_lru_keeps_recent);
+    TEST_RUN(test_invalidate);
+    TEST_RUN(test_streamer_across_sectors);
+
+    shim_disk_detach();
+    free(disk_data);
+    return test_finish("bcache");
+}
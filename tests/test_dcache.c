@@ -0,0 +1,129 @@
+#include "test.h"
+#include "fs/dcache.h"
+#include "disk/disk.h"
+#include "config.h"
+#include "shim.h"
+#include <string.h>
+
+static char disk_data[4096];
+static struct Disk *disk = 0;
+static char entry[BIMBLEOS_DCACHE_DATA_SIZE];
+static char found[BIMBLEOS_DCACHE_DATA_SIZE];
+
+/**
+ * @brief A fresh disk, nothing about it cached
+ *
+ */
+static void test_setup()
+{
+    disk = shim_disk_attach(disk_data, sizeof(disk_data));
+    dcache_invalidate(disk);
+    memset(entry, 0x42, sizeof(entry));
+}
+
+static void test_hit_and_miss()
+{
+    uint32_t position = 0;
+    struct DentryCacheStats before, after;
+    test_setup();
+    dcache_get_stats(&before);
+
+    TEST_ASSERT_EQUAL(DCACHE_MISS, dcache_lookup(disk, 0, "data.txt", found, &position));
+    dcache_insert(disk, 0, "data.txt", entry, 1234);
+    TEST_ASSERT_EQUAL(DCACHE_HIT, dcache_lookup(disk, 0, "data.txt", found, &position));
+    TEST_ASSERT_EQUAL(1234, position);
+    TEST_ASSERT(memcmp(found, entry, sizeof(entry)) == 0);
+
+    // Names compare without case, the parent is part of the key
+    TEST_ASSERT_EQUAL(DCACHE_HIT, dcache_lookup(disk, 0, "DATA.TXT", found, &position));
+    TEST_ASSERT_EQUAL(DCACHE_MISS, dcache_lookup(disk, 5, "data.txt", found, &position));
+
+    dcache_get_stats(&after);
+    TEST_ASSERT_EQUAL(2, after.hits - before.hits);
+    TEST_ASSERT_EQUAL(2, after.misses - before.misses);
+}
+
+static void test_negative()
+{
+    uint32_t position = 0;
+    test_setup();
+
+    dcache_insert(disk, 7, "missing.txt", 0, 0);
+    TEST_ASSERT_EQUAL(DCACHE_NEGATIVE, dcache_lookup(disk, 7, "missing.txt", found, &position));
+
+    // Creating the name replaces what was known about it
+    dcache_insert(disk, 7, "missing.txt", entry, 99);
+    TEST_ASSERT_EQUAL(DCACHE_HIT, dcache_lookup(disk, 7, "missing.txt", found, &position));
+    TEST_ASSERT_EQUAL(99, position);
+}
+
+static void test_update()
+{
+    uint32_t position = 0;
+    char changed[BIMBLEOS_DCACHE_DATA_SIZE];
+    test_setup();
+
+    memset(changed, 0x17, sizeof(changed));
+    dcache_insert(disk, 0, "a.txt", entry, 64);
+    dcache_update(disk, 64, changed);
+    TEST_ASSERT_EQUAL(DCACHE_HIT, dcache_lookup(disk, 0, "a.txt", found, &position));
+    TEST_ASSERT(memcmp(found, changed, sizeof(changed)) == 0);
+
+    // Deleting the entry forgets the name
+    dcache_update(disk, 64, 0);
+    TEST_ASSERT_EQUAL(DCACHE_MISS, dcache_lookup(disk, 0, "a.txt", found, &position));
+}
+
+static void test_lru_keeps_recent()
+{
+    char name[16];
+    uint32_t position = 0;
+    test_setup();
+
+    dcache_insert(disk, 0, "keep", entry, 1);
+    for (int i = 0; i < BIMBLEOS_DCACHE_ENTRIES + 16; i++)
+    {
+        // "keep" stays the most recently used
+        snprintf(name, sizeof(name), "f%d", i);
+        dcache_insert(disk, 0, name, entry, i + 2);
+        TEST_ASSERT_EQUAL(DCACHE_HIT, dcache_lookup(disk, 0, "keep", found, &position));
+    }
+
+    TEST_ASSERT_EQUAL(DCACHE_MISS, dcache_lookup(disk, 0, "f0", found, &position));
+    snprintf(name, sizeof(name), "f%d", BIMBLEOS_DCACHE_ENTRIES + 15);
+    TEST_ASSERT_EQUAL(DCACHE_HIT, dcache_lookup(disk, 0, name, found, &position));
+}
+
+static void test_long_names_not_cached()
+{
+    uint32_t position = 0;
+    test_setup();
+
+    dcache_insert(disk, 0, "a_name_longer_than_16.txt", entry, 1);
+    TEST_ASSERT_EQUAL(DCACHE_MISS, dcache_lookup(disk, 0, "a_name_longer_than_16.txt", found, &position));
+}
+
+static void test_invalidate()
+{
+    uint32_t position = 0;
+    test_setup();
+
+    dcache_insert(disk, 0, "a.txt", entry, 1);
+    dcache_insert(disk, 3, "b.txt", 0, 0);
+    dcache_invalidate(disk);
+    TEST_ASSERT_EQUAL(DCACHE_MISS, dcache_lookup(disk, 0, "a.txt", found, &position));
+    TEST_ASSERT_EQUAL(DCACHE_MISS, dcache_lookup(disk, 3, "b.txt", found, &position));
+}
+
+int main()
+{
+    TEST_RUN(test_hit_and_miss);
+    TEST_RUN(test_negative);
+    TEST_RUN(test_update);
+    TEST_RUN(test_lru_keeps_recent);
+    TEST_RUN(test_long_names_not_cached);
+    TEST_RUN(test_invalidate);
+
+    shim_disk_detach();
+    return test_finish("dcache");
+}
@@ -0,0 +1,542 @@
+#include "test.h"
+#include "fs/fat/fat16.h"
+#include "fs/pparser.h"
+#include "disk/disk.h"
+#include "disk/bcache.h"
+#include "fs/dcache.h"
+#include "kernel.h"
+#include "status.h"
+#include "shim.h"
+#include "fat16_image.h"
+
+#define TEST_IMAGE_SECTORS 8192     // 4 MiB
+#define TEST_SECTORS_PER_CLUSTER 4
+#define TEST_BIG_FILE_SIZE (10 * TEST_SECTORS_PER_CLUSTER * 512 + 123)
+
+static struct Fat16Image image;
+static struct Disk *disk = 0;
+static char big_file[TEST_BIG_FILE_SIZE];
+static const char small_file[] = "Hello from the FAT16 tests\n";
+
+/**
+ * @brief Root holds data.txt and a big file spread over every third cluster, sub holds
+ *        inner.txt. Returns the disk with FAT16 resolved on it
+ *
+ */
+static struct Disk *test_fat16_setup()
+{
+    if (fat16_image_create(&image, TEST_IMAGE_SECTORS, TEST_SECTORS_PER_CLUSTER) < 0)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < sizeof(big_file); i++)
+    {
+        big_file[i] = (char)(i * 31 + (i >> 9));
+    }
+
+    fat16_image_add_file(&image, FAT16_IMAGE_ROOT, "data.txt", small_file, sizeof(small_file) - 1);
+    image.cluster_stride = 3;
+    fat16_image_add_file(&image, FAT16_IMAGE_ROOT, "big.bin", big_file, sizeof(big_file));
+    image.cluster_stride = 1;
+    int sub = fat16_image_add_directory(&image, FAT16_IMAGE_ROOT, "sub");
+    fat16_image_add_file(&image, sub, "inner.txt", small_file, 5);
+
+    struct Disk *disk = shim_disk_attach(image.data, image.size);
+    if (fat16_resolve(disk) < 0)
+    {
+        return 0;
+    }
+    return disk;
+}
+
+static int test_bytes_equal(const char *a, const char *b, int length)
+{
+    for (int i = 0; i < length; i++)
+    {
+        if (a[i] != b[i])
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void *test_open_mode(const char *path, FILE_MODE mode)
+{
+    struct PathRoot *root = pathparser_parse(path, 0);
+    if (!root)
+    {
+        return ERROR(-EBADPATH);
+    }
+
+    void *descriptor = fat16_open(disk, root->first, mode);
+    pathparser_free(root);
+    return descriptor;
+}
+
+static void *test_open(const char *path)
+{
+    return test_open_mode(path, FILE_MODE_READ);
+}
+
+static int test_unlink(const char *path)
+{
+    struct PathRoot *root = pathparser_parse(path, 0);
+    if (!root)
+    {
+        return -EBADPATH;
+    }
+
+    int res = fat16_unlink(disk, root->first);
+    pathparser_free(root);
+    return res;
+}
+
+static uint32_t test_free_clusters()
+{
+    return ((struct FAT_Private *)disk->fs_private)->free_clusters;
+}
+
+/**
+ * @brief Write 'data' to 'path' in chunks of 'chunk' bytes, creating or emptying it
+ *
+ */
+static int test_write_file(const char *path, const char *data, int size, int chunk)
+{
+    void *descriptor = test_open_mode(path, FILE_MODE_WRITE);
+    if (TEST_ISERR(descriptor))
+    {
+        return (long)descriptor;
+    }
+
+    int res = 0;
+    for (int done = 0; done < size; done += chunk)
+    {
+        int length = size - done < chunk ? size - done : chunk;
+        res = fat16_write(disk, descriptor, length, 1, &data[done]);
+        if (res != 1)
+        {
+            break;
+        }
+        res = 0;
+    }
+
+    fat16_close(descriptor);
+    return res < 0 ? res : fat16_flush(disk);
+}
+
+/**
+ * @brief Whether 'path' holds exactly 'size' bytes of 'data'
+ *
+ */
+static int test_file_equals(const char *path, const char *data, int size)
+{
+    static char buffer[TEST_BIG_FILE_SIZE];
+    struct FileStat stat;
+    void *descriptor = test_open(path);
+    if (TEST_ISERR(descriptor))
+    {
+        return 0;
+    }
+
+    int res = fat16_stat(disk, descriptor, &stat) == 0 && stat.filesize == size;
+    if (res && size)
+    {
+        res = fat16_read(disk, descriptor, size, 1, buffer) == 1 && test_bytes_equal(buffer, data, size);
+    }
+    fat16_close(descriptor);
+    return res;
+}
+
+static void test_resolve()
+{
+    TEST_ASSERT(disk != 0);
+    TEST_ASSERT(disk->fs_private != 0);
+}
+
+/**
+ * @brief Replaces disk 0, must run last
+ *
+ */
+static void test_resolve_rejects_other_disks()
+{
+    static char zeros[4096];
+    struct Disk *other = shim_disk_attach(zeros, sizeof(zeros));
+    TEST_ASSERT_EQUAL(-EFSNOTUS, fat16_resolve(other));
+}
+
+static void test_read_small()
+{
+    void *descriptor = test_open("0:/data.txt");
+    TEST_ASSERT(descriptor != 0);
+    TEST_ASSERT(!TEST_ISERR(descriptor));
+
+    struct FileStat stat;
+    TEST_ASSERT_EQUAL(0, fat16_stat(disk, descriptor, &stat));
+    TEST_ASSERT_EQUAL(sizeof(small_file) - 1, stat.filesize);
+
+    char buffer[sizeof(small_file)] = {0};
+    TEST_ASSERT_EQUAL(1, fat16_read(disk, descriptor, stat.filesize, 1, buffer));
+    TEST_ASSERT(test_bytes_equal(buffer, small_file, stat.filesize));
+    TEST_ASSERT_EQUAL(0, fat16_close(descriptor));
+}
+
+static void test_case_insensitive()
+{
+    void *descriptor = test_open("0:/DATA.TXT");
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+    fat16_close(descriptor);
+}
+
+static void test_read_fragmented()
+{
+    static char buffer[TEST_BIG_FILE_SIZE];
+    void *descriptor = test_open("0:/big.bin");
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+    TEST_ASSERT_EQUAL(1, fat16_read(disk, descriptor, sizeof(buffer), 1, buffer));
+    TEST_ASSERT(test_bytes_equal(buffer, big_file, sizeof(buffer)));
+    fat16_close(descriptor);
+}
+
+static void test_read_chunks_across_clusters()
+{
+    // An odd chunk size makes most reads straddle a cluster boundary
+    static char buffer[TEST_BIG_FILE_SIZE];
+    const int chunk = 700;
+    void *descriptor = test_open("0:/big.bin");
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+
+    int total = 0;
+    while (total + chunk <= sizeof(buffer))
+    {
+        TEST_ASSERT_EQUAL(1, fat16_read(disk, descriptor, chunk, 1, &buffer[total]));
+        total += chunk;
+    }
+    TEST_ASSERT(test_bytes_equal(buffer, big_file, total));
+    fat16_close(descriptor);
+}
+
+static void test_seek()
+{
+    char buffer[64];
+    void *descriptor = test_open("0:/big.bin");
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+
+    const int offset = 5 * TEST_SECTORS_PER_CLUSTER * 512 - 10;
+    TEST_ASSERT_EQUAL(0, fat16_seek(descriptor, offset, SEEK_SET));
+    TEST_ASSERT_EQUAL(1, fat16_read(disk, descriptor, sizeof(buffer), 1, buffer));
+    TEST_ASSERT(test_bytes_equal(buffer, &big_file[offset], sizeof(buffer)));
+
+    TEST_ASSERT_EQUAL(-EIO, fat16_seek(descriptor, TEST_BIG_FILE_SIZE, SEEK_SET));
+    fat16_close(descriptor);
+}
+
+static void test_read_past_chain_end()
+{
+    // The last byte is read into it before the chain runs out
+    static char buffer[TEST_SECTORS_PER_CLUSTER * 512];
+    void *descriptor = test_open("0:/big.bin");
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+
+    // The chain ends with the cluster holding the last byte
+    TEST_ASSERT_EQUAL(0, fat16_seek(descriptor, TEST_BIG_FILE_SIZE - 1, SEEK_SET));
+    TEST_ASSERT_EQUAL(1, fat16_read(disk, descriptor, 1, 1, buffer));
+    TEST_ASSERT(ISERR(fat16_read(disk, descriptor, TEST_SECTORS_PER_CLUSTER * 512, 1, buffer)));
+    fat16_close(descriptor);
+}
+
+static void test_subdirectory()
+{
+    char buffer[8] = {0};
+    void *descriptor = test_open("0:/sub/inner.txt");
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+    TEST_ASSERT_EQUAL(1, fat16_read(disk, descriptor, 5, 1, buffer));
+    TEST_ASSERT(test_bytes_equal(buffer, small_file, 5));
+    fat16_close(descriptor);
+}
+
+static void test_open_errors()
+{
+    int outstanding = shim_kheap_outstanding();
+    TEST_ASSERT_EQUAL(-EIO, (long)test_open("0:/missing.txt"));
+    TEST_ASSERT_EQUAL(-EIO, (long)test_open("0:/data.txt/inner.txt"));
+    TEST_ASSERT_EQUAL(outstanding, shim_kheap_outstanding());
+
+    // Names that do not fit 8.3, a missing parent, a directory
+    TEST_ASSERT_EQUAL(-EINVARG, (long)test_open_mode("0:/toolongname.txt", FILE_MODE_WRITE));
+    TEST_ASSERT_EQUAL(-EINVARG, (long)test_open_mode("0:/a.b.c", FILE_MODE_WRITE));
+    TEST_ASSERT_EQUAL(-EIO, (long)test_open_mode("0:/nodir/a.txt", FILE_MODE_WRITE));
+    TEST_ASSERT_EQUAL(-EINVARG, (long)test_open_mode("0:/sub", FILE_MODE_APPEND));
+    TEST_ASSERT_EQUAL(outstanding, shim_kheap_outstanding());
+
+    // Descriptors opened for reading do not write
+    char byte = 0;
+    void *descriptor = test_open("0:/data.txt");
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+    TEST_ASSERT_EQUAL(-ERDONLY, fat16_write(disk, descriptor, 1, 1, &byte));
+    fat16_close(descriptor);
+}
+
+static void test_write_new_file()
+{
+    uint32_t free_clusters = test_free_clusters();
+    TEST_ASSERT_EQUAL(0, test_write_file("0:/new.txt", small_file, sizeof(small_file) - 1, 1000));
+    TEST_ASSERT(test_file_equals("0:/NEW.TXT", small_file, sizeof(small_file) - 1));
+    TEST_ASSERT_EQUAL(free_clusters - 1, test_free_clusters());
+
+    // The other files are where they were
+    TEST_ASSERT(test_file_equals("0:/data.txt", small_file, sizeof(small_file) - 1));
+}
+
+static void test_write_across_clusters()
+{
+    // Odd chunks in a subdirectory, most writes straddle a cluster boundary
+    const int clusters = (TEST_BIG_FILE_SIZE + TEST_SECTORS_PER_CLUSTER * 512 - 1) / (TEST_SECTORS_PER_CLUSTER * 512);
+    uint32_t free_clusters = test_free_clusters();
+    TEST_ASSERT_EQUAL(0, test_write_file("0:/sub/out.bin", big_file, sizeof(big_file), 700));
+    TEST_ASSERT(test_file_equals("0:/sub/out.bin", big_file, sizeof(big_file)));
+    TEST_ASSERT_EQUAL(free_clusters - clusters, test_free_clusters());
+}
+
+static void test_write_truncates()
+{
+    uint32_t free_clusters = test_free_clusters();
+    TEST_ASSERT_EQUAL(0, test_write_file("0:/trunc.bin", big_file, sizeof(big_file), sizeof(big_file)));
+    TEST_ASSERT_EQUAL(0, test_write_file("0:/trunc.bin", small_file, 3, 3));
+    TEST_ASSERT(test_file_equals("0:/trunc.bin", small_file, 3));
+    TEST_ASSERT_EQUAL(free_clusters - 1, test_free_clusters());
+}
+
+static void test_append()
+{
+    TEST_ASSERT_EQUAL(0, test_write_file("0:/log.txt", small_file, 10, 10));
+
+    void *descriptor = test_open_mode("0:/log.txt", FILE_MODE_APPEND);
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+    TEST_ASSERT_EQUAL(1, fat16_write(disk, descriptor, sizeof(small_file) - 11, 1, &small_file[10]));
+    fat16_close(descriptor);
+    TEST_ASSERT(test_file_equals("0:/log.txt", small_file, sizeof(small_file) - 1));
+}
+
+static void test_unlink_reuses_space()
+{
+    struct FAT_Directory *root = &((struct FAT_Private *)disk->fs_private)->root_directory;
+    uint32_t free_clusters = test_free_clusters();
+    TEST_ASSERT_EQUAL(0, test_write_file("0:/gone.bin", big_file, sizeof(big_file), 4096));
+    int total = root->total;
+
+    TEST_ASSERT_EQUAL(0, test_unlink("0:/gone.bin"));
+    TEST_ASSERT_EQUAL(free_clusters, test_free_clusters());
+    TEST_ASSERT_EQUAL(-EIO, (long)test_open("0:/gone.bin"));
+    TEST_ASSERT_EQUAL(-EIO, test_unlink("0:/gone.bin"));
+    TEST_ASSERT_EQUAL(-EINVARG, test_unlink("0:/sub"));
+
+    // The deleted entry is taken again rather than a new one
+    TEST_ASSERT_EQUAL(0, test_write_file("0:/back.txt", small_file, 5, 5));
+    TEST_ASSERT_EQUAL(total, root->total);
+    TEST_ASSERT(test_file_equals("0:/back.txt", small_file, 5));
+}
+
+static void test_unlink_open_file()
+{
+    uint32_t free_clusters = test_free_clusters();
+    TEST_ASSERT_EQUAL(0, test_write_file("0:/busy.txt", small_file, 10, 10));
+
+    // The descriptor's entry would bring the file back over freed clusters
+    void *descriptor = test_open_mode("0:/busy.txt", FILE_MODE_APPEND);
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+    TEST_ASSERT_EQUAL(-EBUSY, test_unlink("0:/busy.txt"));
+    TEST_ASSERT_EQUAL(1, fat16_write(disk, descriptor, 5, 1, &small_file[10]));
+    fat16_close(descriptor);
+    TEST_ASSERT(test_file_equals("0:/busy.txt", small_file, 15));
+
+    // Readers hold the file too
+    descriptor = test_open("0:/busy.txt");
+    TEST_ASSERT_EQUAL(-EBUSY, test_unlink("0:/busy.txt"));
+    fat16_close(descriptor);
+
+    TEST_ASSERT_EQUAL(0, test_unlink("0:/busy.txt"));
+    TEST_ASSERT_EQUAL(free_clusters, test_free_clusters());
+}
+
+static void test_writer_is_exclusive()
+{
+    TEST_ASSERT_EQUAL(0, test_write_file("0:/one.txt", small_file, 10, 10));
+
+    void *writer = test_open_mode("0:/one.txt", FILE_MODE_APPEND);
+    TEST_ASSERT(writer != 0 && !TEST_ISERR(writer));
+    TEST_ASSERT_EQUAL(-EBUSY, (long)test_open_mode("0:/one.txt", FILE_MODE_WRITE));
+    TEST_ASSERT_EQUAL(-EBUSY, (long)test_open_mode("0:/ONE.TXT", FILE_MODE_APPEND));
+    TEST_ASSERT_EQUAL(-EBUSY, (long)test_open("0:/one.txt"));
+    fat16_close(writer);
+
+    // Any number of readers, but no writer next to them
+    void *first = test_open("0:/one.txt");
+    void *second = test_open("0:/one.txt");
+    TEST_ASSERT(!TEST_ISERR(first) && !TEST_ISERR(second));
+    TEST_ASSERT_EQUAL(-EBUSY, (long)test_open_mode("0:/one.txt", FILE_MODE_WRITE));
+    fat16_close(first);
+    fat16_close(second);
+    TEST_ASSERT(test_file_equals("0:/one.txt", small_file, 10));
+}
+
+static void test_directory_grows()
+{
+    // A cluster of the subdirectory holds 64 entries, three are taken
+    char path[32];
+    for (int i = 0; i < 70; i++)
+    {
+        snprintf(path, sizeof(path), "0:/sub/f%d.txt", i);
+        TEST_ASSERT_EQUAL(0, test_write_file(path, small_file, i % 7 + 1, 4));
+    }
+
+    for (int i = 0; i < 70; i++)
+    {
+        snprintf(path, sizeof(path), "0:/sub/f%d.txt", i);
+        TEST_ASSERT(test_file_equals(path, small_file, i % 7 + 1));
+    }
+    TEST_ASSERT(test_file_equals("0:/sub/inner.txt", small_file, 5));
+}
+
+static void test_flush_updates_both_fats()
+{
+    // Until the flush the FAT changes are only in memory
+    const uint8_t *fat = image.data + image.reserved_sectors * 512;
+    TEST_ASSERT_EQUAL(0, bcache_flush(disk));
+    void *descriptor = test_open_mode("0:/batch.bin", FILE_MODE_WRITE);
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+    TEST_ASSERT_EQUAL(1, fat16_write(disk, descriptor, sizeof(big_file), 1, big_file));
+    fat16_close(descriptor);
+    TEST_ASSERT_EQUAL(0, bcache_flush(disk));
+    TEST_ASSERT(test_bytes_equal((const char *)fat, (const char *)fat + image.sectors_per_fat * 512, image.sectors_per_fat * 512));
+
+    struct FAT_Private *private = disk->fs_private;
+    TEST_ASSERT(private->fat_dirty_sectors > 0);
+    TEST_ASSERT(!test_bytes_equal((const char *)fat, (const char *)private->fat, image.sectors_per_fat * 512));
+
+    TEST_ASSERT_EQUAL(0, fat16_flush(disk));
+    TEST_ASSERT_EQUAL(0, bcache_flush(disk));
+    TEST_ASSERT_EQUAL(0, private->fat_dirty_sectors);
+    TEST_ASSERT(test_bytes_equal((const char *)fat, (const char *)private->fat, image.sectors_per_fat * 512));
+    TEST_ASSERT(test_bytes_equal((const char *)fat, (const char *)fat + image.sectors_per_fat * 512, image.sectors_per_fat * 512));
+
+    // A fresh mount of the image sees the file
+    bcache_invalidate(disk);
+    fat16_resolve(disk);
+    TEST_ASSERT(test_file_equals("0:/batch.bin", big_file, sizeof(big_file)));
+}
+
+static void test_disk_full()
+{
+    void *descriptor = test_open_mode("0:/full.bin", FILE_MODE_WRITE);
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+
+    // Nothing is taken when the write can not fit
+    uint32_t free_clusters = test_free_clusters();
+    static char huge[TEST_IMAGE_SECTORS * 512];
+    TEST_ASSERT_EQUAL(-ENOMEM, fat16_write(disk, descriptor, sizeof(huge), 1, huge));
+    TEST_ASSERT_EQUAL(free_clusters, test_free_clusters());
+    fat16_close(descriptor);
+    TEST_ASSERT_EQUAL(0, test_unlink("0:/full.bin"));
+}
+
+static void test_dcache_repeated_open()
+{
+    struct DentryCacheStats before, after;
+    void *descriptor = test_open("0:/sub/inner.txt");
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+    fat16_close(descriptor);
+
+    // Both names come from the cache, no directory is loaded and no sector read
+    int outstanding = shim_kheap_outstanding();
+    uint32_t reads = shim_disk_reads();
+    dcache_get_stats(&before);
+    descriptor = test_open("0:/SUB/inner.txt");
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+    dcache_get_stats(&after);
+    TEST_ASSERT_EQUAL(2, after.hits - before.hits);
+    TEST_ASSERT_EQUAL(0, after.misses - before.misses);
+    TEST_ASSERT_EQUAL(reads, shim_disk_reads());
+    // The descriptor, its item and the copy of the entry, no directory
+    TEST_ASSERT_EQUAL(outstanding + 3, shim_kheap_outstanding());
+    fat16_close(descriptor);
+
+    // Missing names are remembered as well
+    TEST_ASSERT_EQUAL(-EIO, (long)test_open("0:/sub/nothere.txt"));
+    dcache_get_stats(&before);
+    TEST_ASSERT_EQUAL(-EIO, (long)test_open("0:/sub/nothere.txt"));
+    dcache_get_stats(&after);
+    TEST_ASSERT_EQUAL(1, after.negative_hits - before.negative_hits);
+    TEST_ASSERT_EQUAL(0, after.misses - before.misses);
+}
+
+static void test_dcache_follows_changes()
+{
+    // Created after a failed lookup, grown, then deleted
+    TEST_ASSERT_EQUAL(-EIO, (long)test_open("0:/sub/later.txt"));
+    TEST_ASSERT_EQUAL(0, test_write_file("0:/sub/later.txt", small_file, 5, 5));
+    TEST_ASSERT(test_file_equals("0:/sub/later.txt", small_file, 5));
+
+    void *descriptor = test_open_mode("0:/sub/later.txt", FILE_MODE_APPEND);
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+    TEST_ASSERT_EQUAL(1, fat16_write(disk, descriptor, 10, 1, &small_file[5]));
+    fat16_close(descriptor);
+    TEST_ASSERT(test_file_equals("0:/sub/later.txt", small_file, 15));
+
+    TEST_ASSERT_EQUAL(0, test_unlink("0:/sub/later.txt"));
+    TEST_ASSERT_EQUAL(-EIO, (long)test_open("0:/sub/later.txt"));
+}
+
+static void test_write_no_leaks()
+{
+    int outstanding = shim_kheap_outstanding();
+    TEST_ASSERT_EQUAL(0, test_write_file("0:/sub/leak.txt", small_file, 5, 5));
+    TEST_ASSERT_EQUAL(0, test_unlink("0:/sub/leak.txt"));
+    TEST_ASSERT_EQUAL(outstanding, shim_kheap_outstanding());
+}
+
+static void test_no_leaks()
+{
+    int outstanding = shim_kheap_outstanding();
+    char buffer[16];
+    void *descriptor = test_open("0:/sub/inner.txt");
+    TEST_ASSERT(descriptor != 0 && !TEST_ISERR(descriptor));
+    fat16_read(disk, descriptor, 5, 1, buffer);
+    fat16_close(descriptor);
+    TEST_ASSERT_EQUAL(outstanding, shim_kheap_outstanding());
+}
+
+int main()
+{
+    fat16_init();
+    disk = test_fat16_setup();
+
+    TEST_RUN(test_resolve);
+    TEST_RUN(test_read_small);
+    TEST_RUN(test_case_insensitive);
+    TEST_RUN(test_read_fragmented);
+    TEST_RUN(test_read_chunks_across_clusters);
+    TEST_RUN(test_seek);
+    TEST_RUN(test_read_past_chain_end);
+    TEST_RUN(test_subdirectory);
+    TEST_RUN(test_open_errors);
+    TEST_RUN(test_no_leaks);
+    TEST_RUN(test_write_new_file);
+    TEST_RUN(test_write_across_clusters);
+    TEST_RUN(test_write_truncates);
+    TEST_RUN(test_append);
+    TEST_RUN(test_unlink_reuses_space);
+    TEST_RUN(test_unlink_open_file);
+    TEST_RUN(test_writer_is_exclusive);
+    TEST_RUN(test_directory_grows);
+    TEST_RUN(test_disk_full);
+    TEST_RUN(test_dcache_repeated_open);
+    TEST_RUN(test_dcache_follows_changes);
+    TEST_RUN(test_write_no_leaks);
+    TEST_RUN(test_flush_updates_both_fats);
+    TEST_RUN(test_resolve_rejects_other_disks);
+
+    fat16_image_free(&image);
+    return test_finish("fat16");
+}
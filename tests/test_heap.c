@@ -0,0 +1,150 @@
+#include "test.h"
+#include "memory/heap/heap.h"
+#include "status.h"
+#include <stdlib.h>
+
+#define TEST_HEAP_BLOCKS 64
+
+static struct heap heap;
+static struct heap_table table;
+static HEAP_BLOCK_TABLE_ENTRY entries[TEST_HEAP_BLOCKS];
+static void *memory = 0;
+
+/**
+ * @brief A fresh heap of TEST_HEAP_BLOCKS blocks. Nothing is written to the blocks, the
+ *        allocator only hands out addresses
+ *
+ */
+static int test_heap_setup()
+{
+    if (!memory)
+    {
+        memory = aligned_alloc(BIMBLEOS_HEAP_BLOCK_SIZE, TEST_HEAP_BLOCKS * BIMBLEOS_HEAP_BLOCK_SIZE);
+    }
+
+    table.entries = entries;
+    table.total_entries = TEST_HEAP_BLOCKS;
+    return heap_create(&heap, memory, memory + TEST_HEAP_BLOCKS * BIMBLEOS_HEAP_BLOCK_SIZE, &table);
+}
+
+static void test_create_validates()
+{
+    TEST_ASSERT_EQUAL(0, test_heap_setup());
+
+    // Misaligned start
+    TEST_ASSERT_EQUAL(-EINVARG, heap_create(&heap, memory + 1, memory + TEST_HEAP_BLOCKS * BIMBLEOS_HEAP_BLOCK_SIZE, &table));
+
+    // Table size does not match the memory
+    TEST_ASSERT_EQUAL(-EINVARG, heap_create(&heap, memory, memory + (TEST_HEAP_BLOCKS - 1) * BIMBLEOS_HEAP_BLOCK_SIZE, &table));
+}
+
+static void test_malloc_rounds_to_blocks()
+{
+    TEST_ASSERT_EQUAL(0, test_heap_setup());
+
+    void *a = heap_malloc(&heap, 1);
+    void *b = heap_malloc(&heap, BIMBLEOS_HEAP_BLOCK_SIZE);
+    void *c = heap_malloc(&heap, BIMBLEOS_HEAP_BLOCK_SIZE + 1);
+    void *d = heap_malloc(&heap, 1);
+    TEST_ASSERT(a == memory);
+    TEST_ASSERT(b == a + BIMBLEOS_HEAP_BLOCK_SIZE);
+    TEST_ASSERT(c == b + BIMBLEOS_HEAP_BLOCK_SIZE);
+    TEST_ASSERT(d == c + 2 * BIMBLEOS_HEAP_BLOCK_SIZE);
+    TEST_ASSERT_EQUAL(5, heap.used_blocks);
+}
+
+static void test_malloc_zero()
+{
+    TEST_ASSERT_EQUAL(0, test_heap_setup());
+    TEST_ASSERT(heap_malloc(&heap, 0) == 0);
+    TEST_ASSERT_EQUAL(0, heap.used_blocks);
+}
+
+static void test_free_reuses_blocks()
+{
+    TEST_ASSERT_EQUAL(0, test_heap_setup());
+
+    void *a = heap_malloc(&heap, 3 * BIMBLEOS_HEAP_BLOCK_SIZE);
+    void *b = heap_malloc(&heap, 1);
+    TEST_ASSERT_EQUAL(3, heap_free(&heap, a));
+
+    // Fits in the hole
+    void *c = heap_malloc(&heap, 2 * BIMBLEOS_HEAP_BLOCK_SIZE);
+    TEST_ASSERT(c == a);
+
+    // Does not fit in what is left of the hole
+    void *d = heap_malloc(&heap, 2 * BIMBLEOS_HEAP_BLOCK_SIZE);
+    TEST_ASSERT(d == b + BIMBLEOS_HEAP_BLOCK_SIZE);
+
+    TEST_ASSERT_EQUAL(1, heap_free(&heap, b));
+    TEST_ASSERT_EQUAL(2, heap_free(&heap, c));
+    TEST_ASSERT_EQUAL(2, heap_free(&heap, d));
+    TEST_ASSERT_EQUAL(0, heap.used_blocks);
+}
+
+static void test_free_stops_at_allocation_end()
+{
+    TEST_ASSERT_EQUAL(0, test_heap_setup());
+
+    void *a = heap_malloc(&heap, 2 * BIMBLEOS_HEAP_BLOCK_SIZE);
+    void *b = heap_malloc(&heap, 2 * BIMBLEOS_HEAP_BLOCK_SIZE);
+    TEST_ASSERT_EQUAL(2, heap_free(&heap, a));
+
+    // b is untouched, a second free of a does nothing
+    TEST_ASSERT_EQUAL(0, heap_free(&heap, a));
+    TEST_ASSERT(heap_malloc(&heap, 3 * BIMBLEOS_HEAP_BLOCK_SIZE) == b + 2 * BIMBLEOS_HEAP_BLOCK_SIZE);
+}
+
+static void test_exhaustion()
+{
+    TEST_ASSERT_EQUAL(0, test_heap_setup());
+
+    TEST_ASSERT(heap_malloc(&heap, TEST_HEAP_BLOCKS * BIMBLEOS_HEAP_BLOCK_SIZE) == memory);
+    TEST_ASSERT(heap_malloc(&heap, 1) == 0);
+    TEST_ASSERT_EQUAL(1, heap.failed_allocations);
+}
+
+static void test_short_run_at_end()
+{
+    TEST_ASSERT_EQUAL(0, test_heap_setup());
+
+    // Leave two free blocks at the end of the table, three must not fit there
+    TEST_ASSERT(heap_malloc(&heap, (TEST_HEAP_BLOCKS - 2) * BIMBLEOS_HEAP_BLOCK_SIZE) == memory);
+    TEST_ASSERT(heap_malloc(&heap, 3 * BIMBLEOS_HEAP_BLOCK_SIZE) == 0);
+    TEST_ASSERT(heap_malloc(&heap, 2 * BIMBLEOS_HEAP_BLOCK_SIZE) != 0);
+}
+
+static void test_stats()
+{
+    TEST_ASSERT_EQUAL(0, test_heap_setup());
+
+    void *a = heap_malloc(&heap, 4 * BIMBLEOS_HEAP_BLOCK_SIZE);
+    void *b = heap_malloc(&heap, 1);
+    heap_malloc(&heap, 2 * BIMBLEOS_HEAP_BLOCK_SIZE);
+    heap_free(&heap, a);
+    heap_free(&heap, b);
+
+    struct HeapStats stats;
+    heap_get_stats(&heap, &stats);
+    TEST_ASSERT_EQUAL(TEST_HEAP_BLOCKS, stats.total_blocks);
+    TEST_ASSERT_EQUAL(2, stats.used_blocks);
+    TEST_ASSERT_EQUAL(TEST_HEAP_BLOCKS - 2, stats.free_blocks);
+    TEST_ASSERT_EQUAL(TEST_HEAP_BLOCKS - 7, stats.largest_free_run);
+    TEST_ASSERT_EQUAL(7, stats.peak_used_blocks);
+    TEST_ASSERT_EQUAL(3, stats.allocations);
+    TEST_ASSERT_EQUAL(2, stats.frees);
+    TEST_ASSERT_EQUAL(0, stats.failed_allocations);
+}
+
+int main()
+{
+    TEST_RUN(test_create_validates);
+    TEST_RUN(test_malloc_rounds_to_blocks);
+    TEST_RUN(test_malloc_zero);
+    TEST_RUN(test_free_reuses_blocks);
+    TEST_RUN(test_free_stops_at_allocation_end);
+    TEST_RUN(test_exhaustion);
+    TEST_RUN(test_short_run_at_end);
+    TEST_RUN(test_stats);
+    return test_finish("heap");
+}
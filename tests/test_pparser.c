@@ -0,0 +1,80 @@
+#include "test.h"
+#include "fs/pparser.h"
+#include "config.h"
+#include "string/string.h"
+#include "shim.h"
+
+static void test_parse_parts()
+{
+    int outstanding = shim_kheap_outstanding();
+    struct PathRoot *root = pathparser_parse("0:/bin/tools/shell.elf", 0);
+    TEST_ASSERT(root != 0);
+    TEST_ASSERT_EQUAL(0, root->drive_no);
+
+    struct PathPart *part = root->first;
+    TEST_ASSERT(part != 0);
+    TEST_ASSERT_EQUAL(0, strncmp(part->part, "bin", BIMBLEOS_MAX_PATH));
+    part = part->next;
+    TEST_ASSERT(part != 0);
+    TEST_ASSERT_EQUAL(0, strncmp(part->part, "tools", BIMBLEOS_MAX_PATH));
+    part = part->next;
+    TEST_ASSERT(part != 0);
+    TEST_ASSERT_EQUAL(0, strncmp(part->part, "shell.elf", BIMBLEOS_MAX_PATH));
+    TEST_ASSERT(part->next == 0);
+
+    pathparser_free(root);
+    TEST_ASSERT_EQUAL(outstanding, shim_kheap_outstanding());
+}
+
+static void test_drive_number()
+{
+    struct PathRoot *root = pathparser_parse("9:/interrupts", 0);
+    TEST_ASSERT(root != 0);
+    TEST_ASSERT_EQUAL(9, root->drive_no);
+    TEST_ASSERT_EQUAL(0, strncmp(root->first->part, "interrupts", BIMBLEOS_MAX_PATH));
+    TEST_ASSERT(root->first->next == 0);
+    pathparser_free(root);
+}
+
+static void test_trailing_slash()
+{
+    struct PathRoot *root = pathparser_parse("0:/sub/", 0);
+    TEST_ASSERT(root != 0);
+    TEST_ASSERT_EQUAL(0, strncmp(root->first->part, "sub", BIMBLEOS_MAX_PATH));
+    TEST_ASSERT(root->first->next == 0);
+    pathparser_free(root);
+}
+
+static void test_bad_format()
+{
+    int outstanding = shim_kheap_outstanding();
+    TEST_ASSERT(pathparser_parse("shell.elf", 0) == 0);
+    TEST_ASSERT(pathparser_parse("a:/shell.elf", 0) == 0);
+    TEST_ASSERT(pathparser_parse("0:shell.elf", 0) == 0);
+    TEST_ASSERT(pathparser_parse("0:", 0) == 0);
+    TEST_ASSERT(pathparser_parse("", 0) == 0);
+    TEST_ASSERT_EQUAL(outstanding, shim_kheap_outstanding());
+}
+
+static void test_too_long()
+{
+    char path[BIMBLEOS_MAX_PATH + 8];
+    strcpy(path, "0:/");
+    for (int i = 3; i < sizeof(path) - 1; i++)
+    {
+        path[i] = 'a';
+    }
+    path[sizeof(path) - 1] = 0;
+
+    TEST_ASSERT(pathparser_parse(path, 0) == 0);
+}
+
+int main()
+{
+    TEST_RUN(test_parse_parts);
+    TEST_RUN(test_drive_number);
+    TEST_RUN(test_trailing_slash);
+    TEST_RUN(test_bad_format);
+    TEST_RUN(test_too_long);
+    return test_finish("pparser");
+}
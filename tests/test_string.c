@@ -0,0 +1,81 @@
+#include "test.h"
+#include "string/string.h"
+
+static void test_strlen()
+{
+    TEST_ASSERT_EQUAL(0, strlen(""));
+    TEST_ASSERT_EQUAL(9, strlen("shell.elf"));
+}
+
+static void test_strnlen()
+{
+    TEST_ASSERT_EQUAL(9, strnlen("shell.elf", 108));
+    TEST_ASSERT_EQUAL(5, strnlen("shell.elf", 5));
+    TEST_ASSERT_EQUAL(0, strnlen("", 5));
+}
+
+static void test_strnlen_terminator()
+{
+    TEST_ASSERT_EQUAL(3, strnlen_terminator("bin/shell.elf", 108, '/'));
+    TEST_ASSERT_EQUAL(4, strnlen_terminator("blank", 4, '/'));
+    TEST_ASSERT_EQUAL(5, strnlen_terminator("blank", 108, '/'));
+}
+
+static void test_digits()
+{
+    TEST_ASSERT(is_digit('0'));
+    TEST_ASSERT(is_digit('9'));
+    TEST_ASSERT(!is_digit(':'));
+    TEST_ASSERT(!is_digit('a'));
+    TEST_ASSERT_EQUAL(7, to_numeric_digit('7'));
+}
+
+static void test_strcpy()
+{
+    char buffer[16] = "xxxxxxxxxxxxxxx";
+    TEST_ASSERT(strcpy(buffer, "0:/data") == buffer);
+    TEST_ASSERT_EQUAL(0, strncmp(buffer, "0:/data", sizeof(buffer)));
+    TEST_ASSERT_EQUAL(0, buffer[7]);
+}
+
+static void test_strncpy_terminates()
+{
+    char buffer[8];
+    strncpy(buffer, "0:/very/long/path", sizeof(buffer));
+    TEST_ASSERT_EQUAL(7, strlen(buffer));
+    TEST_ASSERT_EQUAL(0, strncmp(buffer, "0:/very", sizeof(buffer)));
+
+    strncpy(buffer, "ab", sizeof(buffer));
+    TEST_ASSERT_EQUAL(0, strncmp(buffer, "ab", sizeof(buffer)));
+}
+
+static void test_strncmp()
+{
+    TEST_ASSERT_EQUAL(0, strncmp("shell.elf", "shell.elf", 108));
+    TEST_ASSERT_EQUAL(0, strncmp("shell.elf", "shell.bin", 6));
+    TEST_ASSERT(strncmp("shell.elf", "shell.bin", 7) > 0);
+    TEST_ASSERT(strncmp("abc", "abd", 3) < 0);
+    TEST_ASSERT(strncmp("ab", "abc", 3) < 0);
+    TEST_ASSERT_EQUAL(0, strncmp("abc", "xyz", 0));
+}
+
+static void test_istrncmp()
+{
+    TEST_ASSERT_EQUAL(0, istrncmp("SHELL.ELF", "shell.elf", 108));
+    TEST_ASSERT_EQUAL(0, istrncmp("Data.Txt", "dATA.tXT", 108));
+    TEST_ASSERT(istrncmp("shell.elf", "shell.bin", 108) != 0);
+    TEST_ASSERT(istrncmp("shell", "shell.elf", 108) != 0);
+}
+
+int main()
+{
+    TEST_RUN(test_strlen);
+    TEST_RUN(test_strnlen);
+    TEST_RUN(test_strnlen_terminator);
+    TEST_RUN(test_digits);
+    TEST_RUN(test_strcpy);
+    TEST_RUN(test_strncpy_terminates);
+    TEST_RUN(test_strncmp);
+    TEST_RUN(test_istrncmp);
+    return test_finish("string");
+}
@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+"""Boot BimbleOS headless in QEMU, run the benchmarks from the shell and record the results.
+
+The shell is driven over COM1, which QEMU connects to our stdin and stdout. Boot time is
+measured on the host, from starting QEMU to the first shell prompt. bench.elf measures system
+call round trips, program launch latency, file read throughput and ping-pong yields inside
+the guest and prints them as "BENCH <name> <value>" lines, one per round. The per-command
+system call latencies of the "syscalls" built-in are recorded as well. A sparse image of
+--large-disk GiB is attached as the secondary master (drive 3) for the raw disk reads, by
+default past the 128 GiB that 28 bit LBA reaches.
+
+    bench.py run --output results.json          benchmark ./bin/os.bin
+    bench.py compare base.json head.json        compare two result files
+    bench.py commits BASE [HEAD]                build, benchmark and compare two commits
+
+Results of "commits" are cached by commit hash in ./bench-results.
+"""
+
+import argparse
+import datetime
+import json
+import os
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+PROMPT = b"\r\n>"
+BANNER = b"BimbleOS v1.0"
+RESULTS_DIR = "bench-results"
+BENCH_LINE = re.compile(r"^BENCH (\w+) (\d+)\s*$", re.MULTILINE)
+SYSCALL_LINE = re.compile(r"^\s*(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s*$", re.MULTILINE)
+
+
+class Console:
+    """The guest's COM1, collected by a reader thread so QEMU never blocks on its output."""
+
+    def __init__(self, qemu):
+        self.qemu = qemu
+        self.closed = False
+        self.output = bytearray()
+        self.position = 0
+        self.changed = threading.Condition()
+        threading.Thread(target=self._read, daemon=True).start()
+
+    def _read(self):
+        while True:
+            data = self.qemu.stdout.read1(4096)
+            with self.changed:
+                if not data:
+                    self.closed = True
+                    self.changed.notify_all()
+                    return
+                self.output.extend(data)
+                self.changed.notify_all()
+
+    def wait(self, pattern, timeout):
+        """Wait for 'pattern' after the last match, return the text before it or None."""
+        deadline = time.monotonic() + timeout
+        with self.changed:
+            while True:
+                index = self.output.find(pattern, self.position)
+                if index >= 0:
+                    text = bytes(self.output[self.position:index])
+                    self.position = index + len(pattern)
+                    return text.decode("ascii", errors="replace")
+                remaining = deadline - time.monotonic()
+                if self.closed or remaining <= 0:
+                    return None
+                self.changed.wait(remaining)
+
+    def expect(self, pattern, timeout):
+        text = self.wait(pattern, timeout)
+        if text is None:
+            tail = bytes(self.output[-400:]).decode("ascii", errors="replace")
+            sys.exit("Timed out waiting for %r, console ends with:\n%s" % (pattern, tail))
+        return text
+
+    def send(self, line):
+        self.qemu.stdin.write(line.encode("ascii") + b"\r")
+        self.qemu.stdin.flush()
+
+    def sync(self, timeout):
+        """Get a fresh shell prompt. Keys go to the foreground process, which is not the
+        shell until the programs it started have exited, so keep pressing enter."""
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            self.send("")
+            if self.wait(PROMPT, 1) is not None:
+                # Later presses may still be on their way
+                while self.wait(PROMPT, 0.2) is not None:
+                    pass
+                return
+        self.expect(PROMPT, 0)
+
+
+def add_sample(metrics, name, value):
+    metrics.setdefault(name, []).append(value)
+
+
+def run(image, qemu, timeout, memory, large_disk_gib):
+    command = [qemu, "-drive", "format=raw,file=%s" % image, "-m", str(memory),
+               "-display", "none", "-serial", "stdio", "-monitor", "none", "-smp", "1",
+               "-no-reboot"]
+    scratch = tempfile.mkdtemp(prefix="bimbleos-disk-")
+    if large_disk_gib:
+        large_disk = os.path.join(scratch, "large.img")
+        with open(large_disk, "wb") as disk:
+            disk.truncate(large_disk_gib << 30)
+        command += ["-drive", "format=raw,if=ide,index=2,file=%s" % large_disk]
+
+    samples = {}
+    start = time.monotonic()
+    process = subprocess.Popen(command, stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+    try:
+        console = Console(process)
+        console.expect(BANNER, timeout)
+        console.expect(b">", timeout)
+        add_sample(samples, "boot_to_shell_ms", round((time.monotonic() - start) * 1000))
+
+        # The shell prompts again right away, bench.elf runs next to it
+        console.send("bench.elf")
+        output = console.expect(b"BENCH done", timeout)
+        for name, value in BENCH_LINE.findall(output):
+            add_sample(samples, name, int(value))
+        console.sync(timeout)
+
+        console.send("syscalls")
+        output = console.expect(PROMPT, timeout)
+        for command_id, count, mean, p99 in SYSCALL_LINE.findall(output):
+            add_sample(samples, "syscall%s_mean_cycles" % command_id, int(mean))
+            add_sample(samples, "syscall%s_p99_cycles" % command_id, int(p99))
+    finally:
+        process.kill()
+        process.wait()
+        shutil.rmtree(scratch, ignore_errors=True)
+
+    metrics = {}
+    for name, values in samples.items():
+        metrics[name] = {"median": statistics.median(values), "min": min(values),
+                         "max": max(values), "samples": values}
+    return metrics
+
+
+def git(*args, cwd=None):
+    return subprocess.run(["git"] + list(args), cwd=cwd, capture_output=True, text=True,
+                          check=True).stdout.strip()
+
+
+def describe(cwd=None):
+    return {"commit": git("rev-parse", "HEAD", cwd=cwd),
+            "dirty": bool(git("status", "--porcelain", "--untracked-files=no", cwd=cwd)),
+            "subject": git("log", "-1", "--format=%s", cwd=cwd)}
+
+
+def save(path, source, metrics):
+    results = dict(source)
+    results["date"] = datetime.datetime.now().isoformat(timespec="seconds")
+    results["metrics"] = metrics
+    os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+    with open(path, "w") as out:
+        json.dump(results, out, indent=2, sort_keys=True)
+    return results
+
+
+def load(path):
+    with open(path) as source:
+        return json.load(source)
+
+
+def higher_is_better(name):
+    return name.endswith("_per_s")
+
+
+def compare(base, head, threshold):
+    """Print every metric both runs have, return the number of regressions."""
+    print("%-32s %14s %14s %9s" % ("Metric", base["commit"][:12], head["commit"][:12], "Change"))
+    regressions = 0
+    for name in sorted(set(base["metrics"]) & set(head["metrics"])):
+        before = base["metrics"][name]["median"]
+        after = head["metrics"][name]["median"]
+        change = (after - before) * 100.0 / before if before else 0.0
+        worse = -change if higher_is_better(name) else change
+        mark = ""
+        if worse > threshold:
+            mark = "  worse"
+            regressions += 1
+        elif worse < -threshold:
+            mark = "  better"
+        print("%-32s %14g %14g %+8.1f%%%s" % (name, before, after, change, mark))
+    return regressions
+
+
+def bench_commit(revision, args):
+    """Results of a commit, built and benchmarked in a temporary worktree unless cached."""
+    commit = git("rev-parse", revision)
+    path = os.path.join(RESULTS_DIR, commit + ".json")
+    if os.path.exists(path):
+        return load(path)
+
+    worktree = tempfile.mkdtemp(prefix="bimbleos-bench-")
+    try:
+        git("worktree", "add", "--detach", worktree, commit)
+        print("Building %s" % commit[:12], file=sys.stderr)
+        subprocess.run(["./build.sh"], cwd=worktree, check=True)
+        metrics = run(os.path.join(worktree, "bin", "os.bin"), args.qemu, args.timeout,
+                      args.memory, args.large_disk)
+        return save(path, describe(worktree), metrics)
+    finally:
+        git("worktree", "remove", "--force", worktree)
+        shutil.rmtree(worktree, ignore_errors=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--qemu", default="qemu-system-i386")
+    parser.add_argument("--timeout", type=float, default=120, help="seconds per step")
+    parser.add_argument("--memory", type=int, default=256, help="guest memory in MiB")
+    parser.add_argument("--large-disk", type=int, default=160,
+                        help="GiB of the sparse secondary disk, 0 for none")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="percent change reported as better or worse")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    run_parser = commands.add_parser("run", help="benchmark an image")
+    run_parser.add_argument("--image", default="bin/os.bin")
+    run_parser.add_argument("--output", required=True)
+
+    compare_parser = commands.add_parser("compare", help="compare two result files")
+    compare_parser.add_argument("base")
+    compare_parser.add_argument("head")
+
+    commits_parser = commands.add_parser("commits", help="benchmark and compare two commits")
+    commits_parser.add_argument("base")
+    commits_parser.add_argument("head", nargs="?", default="HEAD")
+
+    args = parser.parse_args()
+    if args.command == "run":
+        metrics = run(args.image, args.qemu, args.timeout, args.memory, args.large_disk)
+        save(args.output, describe(), metrics)
+        print("Results written to %s" % args.output)
+        return 0
+
+    if args.command == "compare":
+        base, head = load(args.base), load(args.head)
+    else:
+        base, head = bench_commit(args.base, args), bench_commit(args.head, args)
+    return 1 if compare(base, head, args.threshold) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Symbolize a BimbleOS profile captured from COM1.
+
+Run "profile start", the workload, then "profile dump" in the shell while QEMU writes the
+serial port to a file (-serial file:serial.log). This script reads the last profile in that
+capture and prints a flat profile. With --folded it also writes folded stacks for
+flamegraph.pl. The dump is a series of binary frames on the profile channel, see
+src/profiler/profiler.h.
+
+Kernel samples are symbolized against build/kernel.elf, which has the same layout as
+kernel.bin, user samples against the program ELF of their process. Kernel and programs are
+built without frame pointers, so a stack is the process, the privilege level and the
+sampled function.
+"""
+
+import argparse
+import bisect
+import collections
+import os
+import shutil
+import struct
+import subprocess
+import sys
+
+import serial_frames
+
+RECORD_BEGIN, RECORD_PROCESS, RECORD_SAMPLES, RECORD_END = range(4)
+RECORD = struct.Struct("<II")
+SAMPLE = struct.Struct("<IHH")
+IDLE_PID = 0xFFFF
+
+
+class SymbolTable:
+    def __init__(self, path, nm):
+        self.addresses = []
+        self.names = []
+        if not path or not os.path.exists(path):
+            return
+
+        output = subprocess.run([nm, "-n", "--defined-only", path], capture_output=True,
+                                text=True, check=True).stdout
+        for line in output.splitlines():
+            parts = line.split()
+            if len(parts) != 3 or parts[1] not in "tT":
+                continue
+            self.addresses.append(int(parts[0], 16))
+            self.names.append(parts[2])
+
+    def lookup(self, address):
+        index = bisect.bisect_right(self.addresses, address) - 1
+        if index < 0:
+            return "0x%08x" % address
+        return self.names[index]
+
+
+def find_nm():
+    for candidate in ("i686-elf-nm", "nm"):
+        if shutil.which(candidate):
+            return candidate
+    sys.exit("No nm found, pass --nm")
+
+
+def parse(frames):
+    """Return the process table and samples of the last complete profile."""
+    processes = {}
+    samples = []
+    inside = False
+    complete = None
+    for channel, payload in frames:
+        if channel != serial_frames.CHANNEL_PROFILE or len(payload) < RECORD.size:
+            continue
+
+        record, value = RECORD.unpack_from(payload)
+        data = payload[RECORD.size:]
+        if record == RECORD_BEGIN:
+            inside = True
+            processes, samples = {}, []
+        elif record == RECORD_END and inside:
+            inside = False
+            complete = (processes, samples)
+        elif inside and record == RECORD_PROCESS:
+            processes[value] = data.decode("ascii", errors="replace")
+        elif inside and record == RECORD_SAMPLES:
+            for eip, cs, pid in SAMPLE.iter_unpack(data):
+                samples.append((value, eip, cs, pid))
+
+    if complete is None:
+        sys.exit("No complete profile in the input")
+    return complete
+
+
+def find_program(programs, filename):
+    """Map 0:/blank.elf to src/programs/blank/bin/blank.elf."""
+    base = filename.split("/")[-1]
+    for directory in sorted(os.listdir(programs)):
+        path = os.path.join(programs, directory, "bin", base)
+        if os.path.exists(path):
+            return path
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", help="COM1 capture containing a profile dump")
+    parser.add_argument("--kernel", default="build/kernel.elf")
+    parser.add_argument("--programs", default="src/programs")
+    parser.add_argument("--folded", help="write folded stacks to this file")
+    parser.add_argument("--top", type=int, default=30, help="rows of the flat profile")
+    parser.add_argument("--nm", default=None)
+    args = parser.parse_args()
+
+    nm = args.nm or find_nm()
+    _, frames = serial_frames.read(args.log)
+    processes, samples = parse(frames)
+
+    kernel = SymbolTable(args.kernel, nm)
+    programs = {}
+    flat = collections.Counter()
+    folded = collections.Counter()
+    for cpu, eip, cs, pid in samples:
+        name = "idle" if pid == IDLE_PID else processes.get(pid, "pid%d" % pid).split("/")[-1]
+        if cs & 3 == 0:
+            function = kernel.lookup(eip)
+            flat[("[kernel]", function)] += 1
+            folded["%s;[kernel];%s" % (name, function)] += 1
+            continue
+
+        if pid not in programs:
+            path = find_program(args.programs, processes.get(pid, ""))
+            programs[pid] = SymbolTable(path, nm)
+        function = programs[pid].lookup(eip)
+        flat[(name, function)] += 1
+        folded["%s;%s" % (name, function)] += 1
+
+    total = len(samples)
+    print("%d samples on %d cpus" % (total, len({sample[0] for sample in samples})))
+    print("%8s %7s  %-16s %s" % ("Samples", "%", "Image", "Function"))
+    for (image, function), count in flat.most_common(args.top):
+        print("%8d %6.2f%%  %-16s %s" % (count, 100.0 * count / total, image, function))
+
+    if args.folded:
+        with open(args.folded, "w") as out:
+            for stack, count in sorted(folded.items()):
+                out.write("%s %d\n" % (stack, count))
+
+
+if __name__ == "__main__":
+    main()
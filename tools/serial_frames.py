@@ -0,0 +1,55 @@
+"""Split a BimbleOS COM1 capture into log text and binary frames.
+
+A frame is the magic "BOSF", uint16 channel, uint16 reserved, uint32 payload length, the
+payload and the Adler-32 of the payload, all little endian. See src/serial/serial.h.
+"""
+
+import struct
+import zlib
+
+MAGIC = b"BOSF"
+HEADER = struct.Struct("<4sHHI")
+CHECKSUM = struct.Struct("<I")
+
+CHANNEL_PROFILE = 1
+CHANNEL_TRACE = 2
+
+
+def split(data):
+    """Return (text, frames), frames is a list of (channel, payload) in capture order.
+
+    Bytes that look like a frame but fail the checksum stay in the text.
+    """
+    text = bytearray()
+    frames = []
+    pos = 0
+    while True:
+        start = data.find(MAGIC, pos)
+        if start < 0:
+            text += data[pos:]
+            break
+
+        text += data[pos:start]
+        end = start + HEADER.size
+        if end > len(data):
+            text += data[start:]
+            break
+
+        _, channel, _, length = HEADER.unpack_from(data, start)
+        payload = data[end:end + length]
+        if len(payload) == length and end + length + CHECKSUM.size <= len(data):
+            (checksum,) = CHECKSUM.unpack_from(data, end + length)
+            if zlib.adler32(payload) == checksum:
+                frames.append((channel, bytes(payload)))
+                pos = end + length + CHECKSUM.size
+                continue
+
+        text += data[start:start + 1]
+        pos = start + 1
+
+    return text.decode("ascii", errors="replace"), frames
+
+
+def read(path):
+    with open(path, "rb") as capture:
+        return split(capture.read())
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Turn a BimbleOS trace captured from COM1 into a Chrome trace-event JSON timeline.
+
+Run "trace start", the workload, then "trace dump" in the shell while QEMU writes the serial
+port to a file (-serial file:serial.log). Open the output in chrome://tracing or Perfetto.
+
+Each cpu gets a row showing the process it ran. Each process gets a row with its system
+calls. Disk requests get a row of their own. Page faults and kernel heap calls are instant
+events on the cpu that hit them. Event names and argument names come from the dump, see
+TRACE_EVENTS in src/trace/trace.h.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+import serial_frames
+
+RECORD_BEGIN, RECORD_EVENT, RECORD_PROCESS, RECORD_EVENTS, RECORD_END = range(5)
+RECORD = struct.Struct("<II")
+ENTRY = struct.Struct("<QHHIII")
+IDLE_PID = 0xFFFF
+
+# Chrome "processes" grouping the rows
+CPUS, PROCESSES, DISK = 1, 2, 3
+
+
+def parse(frames):
+    """Return cycles per millisecond, event descriptions, process names and entries of the
+    last complete trace, entries sorted by time."""
+    state = None
+    complete = None
+    for channel, payload in frames:
+        if channel != serial_frames.CHANNEL_TRACE or len(payload) < RECORD.size:
+            continue
+
+        record, value = RECORD.unpack_from(payload)
+        data = payload[RECORD.size:]
+        if record == RECORD_BEGIN:
+            state = {"tsc_per_ms": value, "events": {}, "processes": {}, "entries": []}
+        elif state is None:
+            continue
+        elif record == RECORD_EVENT:
+            fields = data.decode("ascii", errors="replace").split(" ")
+            state["events"][value] = (fields[0], [name for name in fields[1:] if name])
+        elif record == RECORD_PROCESS:
+            state["processes"][value] = data.decode("ascii", errors="replace").split("/")[-1]
+        elif record == RECORD_EVENTS:
+            state["entries"].extend(ENTRY.iter_unpack(data))
+        elif record == RECORD_END:
+            complete, state = state, None
+
+    if complete is None:
+        sys.exit("No complete trace in the input")
+    complete["entries"].sort(key=lambda entry: entry[0])
+    return complete
+
+
+def convert(trace):
+    tsc_per_ms = trace["tsc_per_ms"]
+    if not tsc_per_ms:
+        print("No TSC rate in the trace, assuming 1 GHz", file=sys.stderr)
+        tsc_per_ms = 1000000
+    entries = trace["entries"]
+    start = entries[0][0] if entries else 0
+
+    def timestamp(tsc):
+        return (tsc - start) * 1000.0 / tsc_per_ms
+
+    def process_name(pid):
+        if pid == IDLE_PID:
+            return "idle"
+        return trace["processes"].get(pid, "pid %d" % pid)
+
+    out = []
+    for row, name in ((CPUS, "CPUs"), (PROCESSES, "Processes"), (DISK, "Disk")):
+        out.append({"name": "process_name", "ph": "M", "pid": row, "args": {"name": name}})
+    for pid, name in trace["processes"].items():
+        out.append({"name": "thread_name", "ph": "M", "pid": PROCESSES, "tid": pid,
+                    "args": {"name": "%s (%d)" % (name, pid)}})
+
+    running = {}
+    for tsc, event, cpu, arg0, arg1, arg2 in entries:
+        name, arg_names = trace["events"].get(event, ("event%d" % event, []))
+        args = dict(zip(arg_names, ("0x%x" % arg for arg in (arg0, arg1, arg2))))
+        ts = timestamp(tsc)
+
+        if name == "task_switch":
+            # The previous span on this cpu ends where the next one begins
+            if cpu in running:
+                began, pid = running[cpu]
+                out.append({"name": process_name(pid), "ph": "X", "pid": CPUS, "tid": cpu,
+                            "ts": began, "dur": ts - began})
+            running[cpu] = (ts, arg0)
+        elif name == "syscall_enter":
+            out.append({"name": "syscall %d" % arg1, "ph": "B", "pid": PROCESSES, "tid": arg0,
+                        "ts": ts, "args": {"cpu": cpu}})
+        elif name == "syscall_exit":
+            out.append({"name": "syscall %d" % arg1, "ph": "E", "pid": PROCESSES, "tid": arg0,
+                        "ts": ts, "args": {"result": arg2}})
+        elif name == "disk_submit":
+            out.append({"name": "read", "ph": "B", "pid": DISK, "tid": 0, "ts": ts, "args": args})
+        elif name == "disk_complete":
+            out.append({"name": "read", "ph": "E", "pid": DISK, "tid": 0, "ts": ts, "args": args})
+        else:
+            out.append({"name": name, "ph": "i", "s": "t", "pid": CPUS, "tid": cpu, "ts": ts,
+                        "args": args})
+
+    end = timestamp(entries[-1][0]) if entries else 0
+    for cpu, (began, pid) in running.items():
+        out.append({"name": process_name(pid), "ph": "X", "pid": CPUS, "tid": cpu, "ts": began,
+                    "dur": end - began})
+
+    return {"traceEvents": out, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", help="COM1 capture containing a trace dump")
+    parser.add_argument("-o", "--output", default="trace.json")
+    args = parser.parse_args()
+
+    _, frames = serial_frames.read(args.log)
+    trace = parse(frames)
+    with open(args.output, "w") as out:
+        json.dump(convert(trace), out)
+    print("%d entries written to %s" % (len(trace["entries"]), args.output))
+
+
+if __name__ == "__main__":
+    main()